@@ -46,6 +46,7 @@ else()
 #  try_append_c_flag( "-fomit-frame-pointer" CMAKE_C_FLAGS )
   try_append_c_flag( "-pipe" CMAKE_C_FLAGS )
   try_append_c_flag( "-mpclmul" CMAKE_C_FLAGS )
+  try_append_c_flag( "-maes" CMAKE_C_FLAGS )
   try_append_c_flag( "-msse" CMAKE_C_FLAGS )
   try_append_c_flag( "-msse2" CMAKE_C_FLAGS )
   try_append_c_flag( "-mavx" CMAKE_C_FLAGS )
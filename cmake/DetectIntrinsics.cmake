@@ -35,6 +35,25 @@ if( AK_HAVE_BUILTIN_CLMULEPI64 )
     set( CMAKE_C_FLAGS "${CMAKE_C_FLAGS} -DAK_HAVE_BUILTIN_CLMULEPI64" )
 endif()
 
+# -------------------------------------------------------------------------------------------------- #
+# -------------------------------------------------------------------------------------------------- #
+check_c_source_compiles("
+  #include <wmmintrin.h>
+  int main( void ) {
+
+   __m128i a = _mm_setzero_si128(), b = _mm_set_epi64x( 1, 2 );
+   a = _mm_aesenc_si128( a, b );
+   a = _mm_aesenclast_si128( a, b );
+   a = _mm_aesdec_si128( a, _mm_aesimc_si128( b ));
+   a = _mm_aesdeclast_si128( a, b );
+
+  return 0;
+ }" AK_HAVE_BUILTIN_AESENC )
+
+if( AK_HAVE_BUILTIN_AESENC )
+    set( CMAKE_C_FLAGS "${CMAKE_C_FLAGS} -DAK_HAVE_BUILTIN_AESENC" )
+endif()
+
 # -------------------------------------------------------------------------------------------------- #
 # -------------------------------------------------------------------------------------------------- #
 check_c_source_compiles("
@@ -53,3 +72,36 @@ check_c_source_compiles("
 if( AK_HAVE_BUILTIN_MM256_SLL )
     set( CMAKE_C_FLAGS "${CMAKE_C_FLAGS} -DAK_HAVE_BUILTIN_MM256_SLL" )
 endif()
+
+# -------------------------------------------------------------------------------------------------- #
+# -------------------------------------------------------------------------------------------------- #
+check_c_source_compiles("
+  #include <emmintrin.h>
+  int main( void ) {
+
+   __m128i a = _mm_setzero_si128(), b = _mm_set_epi64x( 1, 2 );
+   a = _mm_xor_si128( a, _mm_loadu_si128( &b ));
+   _mm_storeu_si128( &b, a );
+
+  return 0;
+ }" AK_HAVE_BUILTIN_XOR_SI128 )
+
+if( AK_HAVE_BUILTIN_XOR_SI128 )
+    set( CMAKE_C_FLAGS "${CMAKE_C_FLAGS} -DAK_HAVE_BUILTIN_XOR_SI128" )
+endif()
+
+# -------------------------------------------------------------------------------------------------- #
+# -------------------------------------------------------------------------------------------------- #
+check_c_source_compiles("
+  int main( void ) {
+    #if defined( __x86_64__ ) || defined( __i386__ )
+      __builtin_cpu_init();
+      return __builtin_cpu_supports( \"sse2\" ) ? 0 : 1;
+    #else
+      #error Unsupported architecture
+    #endif
+  }" AK_HAVE_BUILTIN_CPU_SUPPORTS )
+
+if( AK_HAVE_BUILTIN_CPU_SUPPORTS )
+    set( CMAKE_C_FLAGS "${CMAKE_C_FLAGS} -DAK_HAVE_BUILTIN_CPU_SUPPORTS" )
+endif()
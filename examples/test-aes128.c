@@ -3,6 +3,7 @@
 /* ----------------------------------------------------------------------------------------------- */
 
 #include <stdio.h>
+#include <string.h>
 #include <libakrypt.h>
 
 int main()
@@ -85,5 +86,28 @@ int main()
     }
     printf("\n");
 
+    /* многоблочное зашифрование должно совпадать с поблочным */
+    ak_uint8 blocks[19 * 16], out_blocks[19 * 16];
+    for (int i = 0; i < 19; i++)
+    {
+        memcpy(blocks + 16 * i, for_enc, 16);
+    }
+    ak_bckey_encrypt_ecb(&key, blocks, out_blocks, sizeof(blocks));
+    for (int i = 0; i < 19; i++)
+    {
+        if (memcmp(out_blocks + 16 * i, for_dec, 16) != 0)
+        {
+            printf("Неверный результат зашифрования\n");
+            return -1;
+        }
+    }
+    ak_bckey_decrypt_ecb(&key, out_blocks, out_blocks, sizeof(blocks));
+    if ((memcmp(out_blocks, blocks, sizeof(blocks)) != 0) || (memcmp(out_dec, for_enc, 16) != 0))
+    {
+        printf("Неверный результат расшифрования\n");
+        return -1;
+    }
+    ak_bckey_destroy(&key);
+
     return 0;
 }
@@ -0,0 +1,158 @@
+/* ----------------------------------------------------------------------------------------------- */
+/* Тестовый пример, проверяющий совпадение результатов многопоточного и последовательного
+   расшифрования в режимах простой замены с зацеплением (cbc) и гаммирования
+   с обратной связью по шифртексту (cfb), а также результат многопоточного расшифрования
+   на тестовых примерах из ГОСТ Р 34.13-2015. Для ключей алгоритма AES многопоточные функции
+   должны выполнять последовательное расшифрование.
+
+   test-cbc-threads.c                                                                              */
+/* ----------------------------------------------------------------------------------------------- */
+
+ #include <stdio.h>
+ #include <stdlib.h>
+ #include <string.h>
+ #include <libakrypt.h>
+
+ static ak_uint8 key[32] = {
+     0xef, 0xcd, 0xab, 0x89, 0x67, 0x45, 0x23, 0x01, 0x10, 0x32, 0x54, 0x76, 0x98, 0xba, 0xdc, 0xfe,
+     0x77, 0x66, 0x55, 0x44, 0x33, 0x22, 0x11, 0x00, 0xff, 0xee, 0xdd, 0xcc, 0xbb, 0xaa, 0x99, 0x88 };
+
+ static ak_uint8 iv[48] = {
+     0x12, 0x34, 0x56, 0x78, 0x90, 0xab, 0xce, 0xf0, 0xa1, 0xb2, 0xc3, 0xd4, 0xe5, 0xf0, 0x01, 0x12,
+     0x23, 0x34, 0x45, 0x56, 0x67, 0x78, 0x89, 0x90, 0x12, 0x13, 0x14, 0x15, 0x16, 0x17, 0x18, 0x19,
+     0x09, 0x08, 0x07, 0x06, 0x05, 0x04, 0x03, 0x02, 0x01, 0x00, 0xf1, 0xe2, 0xd3, 0xc4, 0xb5, 0xa6 };
+
+/* синхропосылка, открытый текст и результаты режимов cbc и cfb
+                                                 из ГОСТ Р 34.13-2015, приложение А.1 */
+ static ak_uint8 gost_iv[32] = {
+     0x12, 0x01, 0xf0, 0xe5, 0xd4, 0xc3, 0xb2, 0xa1, 0xf0, 0xce, 0xab, 0x90, 0x78, 0x56, 0x34, 0x12,
+     0x19, 0x18, 0x17, 0x16, 0x15, 0x14, 0x13, 0x12, 0x90, 0x89, 0x78, 0x67, 0x56, 0x45, 0x34, 0x23 };
+
+ static ak_uint8 gost_in[64] = {
+     0x88, 0x99, 0xaa, 0xbb, 0xcc, 0xdd, 0xee, 0xff, 0x00, 0x77, 0x66, 0x55, 0x44, 0x33, 0x22, 0x11,
+     0x0a, 0xff, 0xee, 0xcc, 0xbb, 0xaa, 0x99, 0x88, 0x77, 0x66, 0x55, 0x44, 0x33, 0x22, 0x11, 0x00,
+     0x00, 0x0a, 0xff, 0xee, 0xcc, 0xbb, 0xaa, 0x99, 0x88, 0x77, 0x66, 0x55, 0x44, 0x33, 0x22, 0x11,
+     0x11, 0x00, 0x0a, 0xff, 0xee, 0xcc, 0xbb, 0xaa, 0x99, 0x88, 0x77, 0x66, 0x55, 0x44, 0x33, 0x22 };
+
+ static ak_uint8 gost_outcbc[64] = {
+     0x27, 0xcc, 0x7d, 0x6d, 0x3d, 0x2e, 0xe5, 0x90, 0x4d, 0xfa, 0x85, 0xa0, 0xd4, 0x72, 0x99, 0x68,
+     0xac, 0xa5, 0x5e, 0x8d, 0x44, 0x8e, 0x1e, 0xaf, 0xa6, 0xec, 0x78, 0xb4, 0x61, 0xe6, 0x26, 0x28,
+     0xd0, 0x90, 0x9d, 0xf4, 0xb0, 0xe8, 0x40, 0x56, 0xe8, 0x99, 0x19, 0xe9, 0xf1, 0xab, 0x7b, 0xfe,
+     0x70, 0x39, 0xb6, 0x60, 0x15, 0x9a, 0x2d, 0x1a, 0x63, 0x5c, 0x89, 0x5a, 0x06, 0x88, 0x76, 0x16 };
+
+ static ak_uint8 gost_outcfb[64] = {
+     0x95, 0xbd, 0x7a, 0x89, 0x5e, 0x79, 0x1f, 0xff, 0x24, 0x2b, 0x84, 0xb1, 0x59, 0x0a, 0x80, 0x81,
+     0xbf, 0x26, 0x93, 0x9d, 0x36, 0x21, 0xb5, 0x8f, 0xb4, 0xfa, 0x8c, 0x04, 0xa7, 0x47, 0x5b, 0xed,
+     0xb5, 0x38, 0xa2, 0x97, 0x4e, 0x26, 0x2d, 0x84, 0x38, 0x8d, 0xc6, 0x5c, 0xeb, 0xa8, 0xf2, 0x79,
+     0xd1, 0xf4, 0xfb, 0x44, 0xdd, 0xd9, 0x5b, 0xc7, 0xe6, 0x2d, 0x92, 0x4e, 0xcd, 0xbe, 0xfe, 0x4f };
+
+/* ----------------------------------------------------------------------------------------------- */
+ int test( ak_function_bckey_create *create, const char *name, ak_uint8 *in, ak_uint8 *enc,
+                                                     ak_uint8 *out1, ak_uint8 *out2, size_t size )
+{
+  struct bckey bkey;
+  int result = EXIT_FAILURE;
+  size_t z, len = 0;
+
+  create( &bkey );
+  for( z = 1; z <= 3; z++ ) {
+    /* ключ присваивается заново, чтобы не исчерпать его ресурс */
+     ak_bckey_set_key( &bkey, key, bkey.key.key_size );
+
+    /* режим простой замены с зацеплением: длина данных кратна длине блока */
+     len = size - size%bkey.bsize;
+     ak_bckey_encrypt_cbc( &bkey, in, enc, len, iv, z*bkey.bsize );
+     ak_bckey_decrypt_cbc( &bkey, enc, out1, len, iv, z*bkey.bsize );
+     ak_bckey_decrypt_cbc_threads( &bkey, enc, out2, len, iv, z*bkey.bsize, 3 );
+     printf(" %s cbc (iv: %u blocks): ", name, (unsigned int) z );
+     if(( memcmp( out1, in, len ) != 0 ) || ( memcmp( out2, in, len ) != 0 )) {
+       printf("Wrong\n"); goto labex;
+     }
+    /* расшифрование на месте */
+     memcpy( out2, enc, len );
+     ak_bckey_decrypt_cbc_threads( &bkey, out2, out2, len, iv, z*bkey.bsize, 4 );
+     if( memcmp( out2, in, len ) != 0 ) { printf("Wrong\n"); goto labex; }
+     printf("Ok\n");
+
+    /* режим гаммирования с обратной связью по шифртексту: данные содержат неполный блок */
+     ak_bckey_encrypt_cfb( &bkey, in, enc, size, iv, z*bkey.bsize );
+     ak_bckey_decrypt_cfb( &bkey, enc, out1, size, iv, z*bkey.bsize );
+     ak_bckey_decrypt_cfb_threads( &bkey, enc, out2, size, iv, z*bkey.bsize, 3 );
+     printf(" %s cfb (iv: %u blocks): ", name, (unsigned int) z );
+     if(( memcmp( out1, in, size ) != 0 ) || ( memcmp( out2, in, size ) != 0 )) {
+       printf("Wrong\n"); goto labex;
+     }
+     memcpy( out2, enc, size );
+     ak_bckey_decrypt_cfb_threads( &bkey, out2, out2, size, iv, z*bkey.bsize, 4 );
+     if( memcmp( out2, in, size ) != 0 ) { printf("Wrong\n"); goto labex; }
+     printf("Ok\n");
+  }
+
+  result = EXIT_SUCCESS;
+  labex: ak_bckey_destroy( &bkey );
+ return result;
+}
+
+/* ----------------------------------------------------------------------------------------------- */
+/* шифртекст из стандарта помещается в начало большого буффера, чтобы данные
+   действительно расшифровывались несколькими потоками */
+ int test_known_answer( ak_uint8 *enc, ak_uint8 *out, size_t size )
+{
+  struct bckey bkey;
+  int result = EXIT_FAILURE;
+
+  ak_libakrypt_set_openssl_compability( ak_false );
+  ak_bckey_create_kuznechik( &bkey );
+  ak_bckey_set_key( &bkey, key, sizeof( key ));
+
+  printf(" kuznechik cbc (known answer): ");
+  memcpy( enc, gost_outcbc, sizeof( gost_outcbc ));
+  if(( ak_bckey_decrypt_cbc_threads( &bkey, enc, out, size - size%bkey.bsize,
+                                     gost_iv, sizeof( gost_iv ), 4 ) != ak_error_ok ) ||
+     ( memcmp( out, gost_in, sizeof( gost_in )) != 0 )) { printf("Wrong\n"); goto labex; }
+  printf("Ok\n");
+
+  printf(" kuznechik cfb (known answer): ");
+  memcpy( enc, gost_outcfb, sizeof( gost_outcfb ));
+  if(( ak_bckey_decrypt_cfb_threads( &bkey, enc, out, size,
+                                     gost_iv, sizeof( gost_iv ), 4 ) != ak_error_ok ) ||
+     ( memcmp( out, gost_in, sizeof( gost_in )) != 0 )) { printf("Wrong\n"); goto labex; }
+  printf("Ok\n");
+
+  result = EXIT_SUCCESS;
+  labex: ak_bckey_destroy( &bkey );
+ return result;
+}
+
+/* ----------------------------------------------------------------------------------------------- */
+ int main( void )
+{
+  size_t i, size = 262144 + 13;
+  int oc, result = EXIT_SUCCESS;
+  ak_uint8 *in = malloc( size ), *enc = malloc( size ),
+           *out1 = malloc( size ), *out2 = malloc( size );
+
+  if(( in == NULL ) || ( enc == NULL ) || ( out1 == NULL ) || ( out2 == NULL ))
+    return EXIT_FAILURE;
+  for( i = 0; i < size; i++ ) in[i] = (ak_uint8)( i*17 + 3 );
+
+ /* инициализируем библиотеку */
+  if( !ak_libakrypt_create( ak_function_log_stderr )) return ak_libakrypt_destroy();
+
+  for( oc = 0; oc < 2; oc++ ) {
+     ak_libakrypt_set_openssl_compability( oc );
+     printf("openssl compability: %d\n", oc );
+     if( test( ak_bckey_create_kuznechik, "kuznechik",
+                                           in, enc, out1, out2, size ) != EXIT_SUCCESS )
+       result = EXIT_FAILURE;
+     if( test( ak_bckey_create_magma, "magma", in, enc, out1, out2, size ) != EXIT_SUCCESS )
+       result = EXIT_FAILURE;
+     if( test( ak_bckey_create_aes128, "aes128", in, enc, out1, out2, size ) != EXIT_SUCCESS )
+       result = EXIT_FAILURE;
+  }
+  if( test_known_answer( enc, out1, size ) != EXIT_SUCCESS ) result = EXIT_FAILURE;
+
+  free( in ); free( enc ); free( out1 ); free( out2 );
+  ak_libakrypt_destroy();
+ return result;
+}
@@ -0,0 +1,174 @@
+/* ----------------------------------------------------------------------------------------------- */
+/* Тестовый пример, проверяющий совпадение результатов многопоточного и последовательного
+   шифрования в режимах гаммирования и CTR-ACPKM, а также результат многопоточного шифрования
+   на тестовых примерах из ГОСТ Р 34.13-2015. Для ключей алгоритма AES многопоточные
+   функции должны выполнять последовательное шифрование.
+
+   test-ctr-threads.c                                                                              */
+/* ----------------------------------------------------------------------------------------------- */
+
+ #include <stdio.h>
+ #include <stdlib.h>
+ #include <string.h>
+ #include <libakrypt.h>
+
+ static ak_uint8 key[32] = {
+     0xef, 0xcd, 0xab, 0x89, 0x67, 0x45, 0x23, 0x01, 0x10, 0x32, 0x54, 0x76, 0x98, 0xba, 0xdc, 0xfe,
+     0x77, 0x66, 0x55, 0x44, 0x33, 0x22, 0x11, 0x00, 0xff, 0xee, 0xdd, 0xcc, 0xbb, 0xaa, 0x99, 0x88 };
+
+ static ak_uint8 iv[8] = { 0xf0, 0xce, 0xab, 0x90, 0x78, 0x56, 0x34, 0x12 };
+
+/* открытый текст и результат режима гаммирования из ГОСТ Р 34.13-2015, приложение А.1 */
+ static ak_uint8 kuznechik_in[64] = {
+     0x88, 0x99, 0xaa, 0xbb, 0xcc, 0xdd, 0xee, 0xff, 0x00, 0x77, 0x66, 0x55, 0x44, 0x33, 0x22, 0x11,
+     0x0a, 0xff, 0xee, 0xcc, 0xbb, 0xaa, 0x99, 0x88, 0x77, 0x66, 0x55, 0x44, 0x33, 0x22, 0x11, 0x00,
+     0x00, 0x0a, 0xff, 0xee, 0xcc, 0xbb, 0xaa, 0x99, 0x88, 0x77, 0x66, 0x55, 0x44, 0x33, 0x22, 0x11,
+     0x11, 0x00, 0x0a, 0xff, 0xee, 0xcc, 0xbb, 0xaa, 0x99, 0x88, 0x77, 0x66, 0x55, 0x44, 0x33, 0x22 };
+
+ static ak_uint8 kuznechik_out[64] = {
+     0xb8, 0xa1, 0xbd, 0x40, 0xa2, 0x5f, 0x7b, 0xd5, 0xdb, 0xd1, 0x0e, 0xc1, 0xbe, 0xd8, 0x95, 0xf1,
+     0xe4, 0xde, 0x45, 0x3c, 0xb3, 0xe4, 0x3c, 0xf3, 0x5d, 0x3e, 0xa1, 0xf6, 0x33, 0xe7, 0xee, 0x85,
+     0xa5, 0xa3, 0x64, 0x35, 0xf1, 0x77, 0xe8, 0xd5, 0xd3, 0x6e, 0x35, 0xe6, 0x8b, 0xe8, 0xea, 0xa5,
+     0x73, 0xba, 0xbd, 0x20, 0x58, 0xd1, 0xc6, 0xd1, 0xb6, 0xba, 0x0c, 0xf2, 0xb1, 0xfa, 0x91, 0xcb };
+
+/* ключ, синхропосылка, открытый текст и результат режима гаммирования
+                                                         из ГОСТ Р 34.13-2015, приложение А.2 */
+ static ak_uint8 magma_key[32] = {
+     0xff, 0xfe, 0xfd, 0xfc, 0xfb, 0xfa, 0xf9, 0xf8, 0xf7, 0xf6, 0xf5, 0xf4, 0xf3, 0xf2, 0xf1, 0xf0,
+     0x00, 0x11, 0x22, 0x33, 0x44, 0x55, 0x66, 0x77, 0x88, 0x99, 0xaa, 0xbb, 0xcc, 0xdd, 0xee, 0xff };
+
+ static ak_uint8 magma_iv[4] = { 0x78, 0x56, 0x34, 0x12 };
+
+ static ak_uint8 magma_in[32] = {
+     0x59, 0x0a, 0x13, 0x3c, 0x6b, 0xf0, 0xde, 0x92, 0x20, 0x9d, 0x18, 0xf8, 0x04, 0xc7, 0x54, 0xdb,
+     0x4c, 0x02, 0xa8, 0x67, 0x2e, 0xfb, 0x98, 0x4a, 0x41, 0x7e, 0xb5, 0x17, 0x9b, 0x40, 0x12, 0x89 };
+
+ static ak_uint8 magma_out[32] = {
+     0x3c, 0xb9, 0xb7, 0x97, 0x0c, 0x11, 0x98, 0x4e, 0x69, 0x5d, 0xe8, 0xd6, 0x93, 0x0d, 0x25, 0x3e,
+     0xef, 0xdb, 0xb2, 0x07, 0x88, 0x86, 0x6d, 0x13, 0x2d, 0xa1, 0x52, 0xab, 0x80, 0xb6, 0x8e, 0x56 };
+
+/* ----------------------------------------------------------------------------------------------- */
+ int test( ak_function_bckey_create *create, const char *name,
+                                       ak_uint8 *in, ak_uint8 *out1, ak_uint8 *out2, size_t size )
+{
+  struct bckey bkey;
+  int result = EXIT_FAILURE;
+  size_t half = 0, section = 0;
+
+  create( &bkey );
+  ak_bckey_set_key( &bkey, key, bkey.key.key_size );
+  half = bkey.bsize >> 1;
+  section = 64*bkey.bsize;
+
+ /* режим гаммирования: последовательное шифрование двумя фрагментами
+                                          и многопоточное шифрование теми же фрагментами */
+  ak_bckey_ctr( &bkey, in, out1, 20000*bkey.bsize, iv, half );
+  ak_bckey_ctr( &bkey, in +20000*bkey.bsize, out1 +20000*bkey.bsize,
+                                                             size -20000*bkey.bsize, NULL, 0 );
+  ak_bckey_ctr_threads( &bkey, in, out2, 20000*bkey.bsize, iv, half, 4 );
+  ak_bckey_ctr_threads( &bkey, in +20000*bkey.bsize, out2 +20000*bkey.bsize,
+                                                          size -20000*bkey.bsize, NULL, 0, 0 );
+  printf(" %s ctr:   ", name );
+  if( memcmp( out1, out2, size ) != 0 ) { printf("Wrong\n"); goto labex; }
+  printf("Ok\n");
+
+ /* режим CTR-ACPKM */
+  if( bkey.key.oid == NULL ) { /* режим определен только для алгоритмов ГОСТ Р 34.12-2015 */
+    result = EXIT_SUCCESS;
+    goto labex;
+  }
+  ak_bckey_ctr_acpkm( &bkey, in, out1, size, section, iv, half );
+  ak_bckey_ctr_acpkm_threads( &bkey, in, out2, size, section, iv, half, 3 );
+  printf(" %s acpkm: ", name );
+  if( memcmp( out1, out2, size ) != 0 ) { printf("Wrong\n"); goto labex; }
+  printf("Ok\n");
+
+  result = EXIT_SUCCESS;
+  labex: ak_bckey_destroy( &bkey );
+ return result;
+}
+
+/* ----------------------------------------------------------------------------------------------- */
+/* ключ, созданный при другом значении опции openssl_compability, не может быть скопирован,
+   поэтому многопоточная функция должна выполнять последовательное шифрование */
+ int test_option_changed( ak_uint8 *in, ak_uint8 *out1, ak_uint8 *out2, size_t size )
+{
+  struct bckey bkey;
+  int result = EXIT_FAILURE;
+
+  ak_libakrypt_set_openssl_compability( ak_true );
+  ak_bckey_create_magma( &bkey );
+  ak_bckey_set_key( &bkey, key, sizeof( key ));
+  ak_libakrypt_set_openssl_compability( ak_false );
+
+  printf(" magma ctr (changed option): ");
+  if(( ak_bckey_ctr( &bkey, in, out1, size, iv, 4 ) != ak_error_ok ) ||
+     ( ak_bckey_ctr_threads( &bkey, in, out2, size, iv, 4, 4 ) != ak_error_ok ) ||
+     ( memcmp( out1, out2, size ) != 0 )) { printf("Wrong\n"); goto labex; }
+  printf("Ok\n");
+
+  result = EXIT_SUCCESS;
+  labex: ak_bckey_destroy( &bkey );
+ return result;
+}
+
+/* ----------------------------------------------------------------------------------------------- */
+/* тестовый пример из стандарта помещается в начало большого буффера, чтобы данные
+   действительно обрабатывались несколькими потоками */
+ int test_known_answer( ak_function_bckey_create *create, const char *name,
+                 ak_uint8 *skey, ak_uint8 *siv, ak_uint8 *sin, ak_uint8 *sout, size_t ssize,
+                                                ak_uint8 *in, ak_uint8 *out, size_t size )
+{
+  struct bckey bkey;
+  int result = EXIT_FAILURE;
+
+  ak_libakrypt_set_openssl_compability( ak_false );
+  create( &bkey );
+  ak_bckey_set_key( &bkey, skey, 32 );
+  memcpy( in, sin, ssize );
+
+  printf(" %s ctr (known answer): ", name );
+  if(( ak_bckey_ctr_threads( &bkey, in, out, size, siv, bkey.bsize >> 1, 4 ) != ak_error_ok ) ||
+     ( memcmp( out, sout, ssize ) != 0 )) { printf("Wrong\n"); goto labex; }
+  printf("Ok\n");
+
+  result = EXIT_SUCCESS;
+  labex: ak_bckey_destroy( &bkey );
+ return result;
+}
+
+/* ----------------------------------------------------------------------------------------------- */
+ int main( void )
+{
+  size_t i, size = 1048576 + 13;
+  int oc, result = EXIT_SUCCESS;
+  ak_uint8 *in = malloc( size ), *out1 = malloc( size ), *out2 = malloc( size );
+
+  if(( in == NULL ) || ( out1 == NULL ) || ( out2 == NULL )) return EXIT_FAILURE;
+  for( i = 0; i < size; i++ ) in[i] = (ak_uint8)( i*13 + 7 );
+
+ /* инициализируем библиотеку */
+  if( !ak_libakrypt_create( ak_function_log_stderr )) return ak_libakrypt_destroy();
+
+  for( oc = 0; oc < 2; oc++ ) {
+     ak_libakrypt_set_openssl_compability( oc );
+     printf("openssl compability: %d\n", oc );
+     if( test( ak_bckey_create_kuznechik, "kuznechik", in, out1, out2, size ) != EXIT_SUCCESS )
+       result = EXIT_FAILURE;
+     if( test( ak_bckey_create_magma, "magma", in, out1, out2, size ) != EXIT_SUCCESS )
+       result = EXIT_FAILURE;
+     if( test( ak_bckey_create_aes128, "aes128", in, out1, out2, size ) != EXIT_SUCCESS )
+       result = EXIT_FAILURE;
+  }
+  if( test_option_changed( in, out1, out2, size ) != EXIT_SUCCESS ) result = EXIT_FAILURE;
+  if( test_known_answer( ak_bckey_create_kuznechik, "kuznechik", key, iv, kuznechik_in,
+                     kuznechik_out, sizeof( kuznechik_in ), in, out1, size ) != EXIT_SUCCESS )
+    result = EXIT_FAILURE;
+  if( test_known_answer( ak_bckey_create_magma, "magma", magma_key, magma_iv, magma_in,
+                             magma_out, sizeof( magma_in ), in, out1, size ) != EXIT_SUCCESS )
+    result = EXIT_FAILURE;
+
+  free( in ); free( out1 ); free( out2 );
+  ak_libakrypt_destroy();
+ return result;
+}
@@ -0,0 +1,253 @@
+/* ----------------------------------------------------------------------------------------------- */
+/* Тестовый пример, проверяющий совпадение результатов обработки данных в режиме MGM
+   последовательными фрагментами, пакетами независимых сообщений и за один вызов функций
+   ak_bckey_encrypt_mgm() и ak_bckey_decrypt_mgm(), а также результаты обработки фрагментами
+   и пакетами на контрольном примере из рекомендаций по стандартизации Р 1323565.1.026-2019.
+
+   test-mgm02.c                                                                                    */
+/* ----------------------------------------------------------------------------------------------- */
+
+ #include <stdio.h>
+ #include <stdlib.h>
+ #include <string.h>
+ #include <libakrypt.h>
+
+ static ak_uint8 key[32] = {
+     0xef, 0xcd, 0xab, 0x89, 0x67, 0x45, 0x23, 0x01, 0x10, 0x32, 0x54, 0x76, 0x98, 0xba, 0xdc, 0xfe,
+     0x77, 0x66, 0x55, 0x44, 0x33, 0x22, 0x11, 0x00, 0xff, 0xee, 0xdd, 0xcc, 0xbb, 0xaa, 0x99, 0x88 };
+
+ static ak_uint8 iv[20] = {
+     0x88, 0x99, 0xaa, 0xbb, 0xcc, 0xdd, 0xee, 0xff, 0x00, 0x77, 0x66, 0x55, 0x44, 0x33, 0x22, 0x11,
+     0x12, 0x34, 0x56, 0x78 };
+
+/* ассоциированные данные, открытый текст, синхропосылка и имитовставка контрольного примера
+   для алгоритма Кузнечик (значения записаны в little endian, как в примере test-mgm01.c) */
+ static ak_uint8 associated[41] = {
+     0x01, 0x01, 0x01, 0x01, 0x01, 0x01, 0x01, 0x01, 0x02, 0x02, 0x02, 0x02, 0x02, 0x02, 0x02, 0x02,
+     0x03, 0x03, 0x03, 0x03, 0x03, 0x03, 0x03, 0x03, 0x04, 0x04, 0x04, 0x04, 0x04, 0x04, 0x04, 0x04,
+     0x05, 0x05, 0x05, 0x05, 0x05, 0x05, 0x05, 0x05, 0xea };
+
+ static ak_uint8 plain[67] = {
+     0x88, 0x99, 0xaa, 0xbb, 0xcc, 0xdd, 0xee, 0xff, 0x00, 0x77, 0x66, 0x55, 0x44, 0x33, 0x22, 0x11,
+     0x0a, 0xff, 0xee, 0xcc, 0xbb, 0xaa, 0x99, 0x88, 0x77, 0x66, 0x55, 0x44, 0x33, 0x22, 0x11, 0x00,
+     0x00, 0x0a, 0xff, 0xee, 0xcc, 0xbb, 0xaa, 0x99, 0x88, 0x77, 0x66, 0x55, 0x44, 0x33, 0x22, 0x11,
+     0x11, 0x00, 0x0a, 0xff, 0xee, 0xcc, 0xbb, 0xaa, 0x99, 0x88, 0x77, 0x66, 0x55, 0x44, 0x33, 0x22,
+     0xcc, 0xbb, 0xaa };
+
+ static ak_uint8 icode_one[16] = {
+     0x4c, 0xdb, 0xfc, 0x29, 0x0e, 0xbb, 0xe8, 0x46, 0x5c, 0x4f, 0xc3, 0x40, 0x6f, 0x65, 0x5d, 0xcf };
+
+/* ----------------------------------------------------------------------------------------------- */
+ int test( ak_function_bckey_create *create, ak_uint8 *adata, size_t asize,
+                                   ak_uint8 *in, ak_uint8 *out1, ak_uint8 *out2, size_t size )
+{
+  struct mgm mgm;
+  struct bckey bkey;
+  size_t i, chunk;
+  int result = EXIT_FAILURE;
+  ak_uint8 icode1[16], icode2[16];
+
+  create( &bkey );
+  ak_bckey_set_key( &bkey, key, sizeof( key ));
+  chunk = 256*bkey.bsize;
+
+ /* зашифрование за один вызов */
+  ak_bckey_encrypt_mgm( &bkey, &bkey, adata, asize, in, out1, size,
+                                                         iv, bkey.bsize, icode1, bkey.bsize );
+ /* зашифрование фрагментами; контекст используется дважды */
+  for( i = 0; i < 2; i++ ) {
+     size_t j;
+     memset( out2, 0, size ); memset( icode2, 0, sizeof( icode2 ));
+     ak_mgm_clean( &mgm, &bkey, &bkey, iv, bkey.bsize );
+     ak_mgm_adata_update( &mgm, adata, 2*bkey.bsize );
+     ak_mgm_adata_update( &mgm, adata +2*bkey.bsize, asize -2*bkey.bsize );
+     for( j = 0; j < size; j += chunk )
+        ak_mgm_encrypt_update( &mgm, in +j, out2 +j, ak_min( chunk, size -j ));
+     ak_mgm_finalize( &mgm, icode2, bkey.bsize );
+  }
+  printf(" %s encrypt: ", bkey.key.oid->name[0] );
+  if(( memcmp( out1, out2, size ) != 0 ) || ( memcmp( icode1, icode2, bkey.bsize ) != 0 )) {
+    printf("Wrong\n"); goto labex;
+  }
+  printf("Ok\n");
+
+ /* расшифрование фрагментами на месте */
+  ak_mgm_clean( &mgm, &bkey, &bkey, iv, bkey.bsize );
+  ak_mgm_adata_update( &mgm, adata, asize );
+  for( i = 0; i < size; i += chunk )
+     ak_mgm_decrypt_update( &mgm, out2 +i, out2 +i, ak_min( chunk, size -i ));
+  ak_mgm_finalize( &mgm, icode2, bkey.bsize );
+  printf(" %s decrypt: ", bkey.key.oid->name[0] );
+  if(( memcmp( in, out2, size ) != 0 ) || ( memcmp( icode1, icode2, bkey.bsize ) != 0 )) {
+    printf("Wrong\n"); goto labex;
+  }
+  printf("Ok\n");
+
+ /* после завершения обработка данных без повторной инициализации невозможна */
+  if( ak_mgm_encrypt_update( &mgm, in, out2, chunk ) == ak_error_ok ) goto labex;
+
+  result = EXIT_SUCCESS;
+  labex: ak_bckey_destroy( &bkey );
+ return result;
+}
+
+/* ----------------------------------------------------------------------------------------------- */
+ int test_known_answer( void )
+{
+  struct mgm mgm;
+  struct bckey bkey;
+  int result = EXIT_FAILURE;
+  ak_uint8 out[67], icode[16];
+
+  ak_libakrypt_set_openssl_compability( ak_false ); /* пример расчитан для несовместимого режима */
+  ak_bckey_create_kuznechik( &bkey );
+  ak_bckey_set_key( &bkey, key, sizeof( key ));
+
+ /* зашифрование фрагментами: ассоциированные данные 16+25 октетов, открытый текст 32+35 */
+  ak_mgm_clean( &mgm, &bkey, &bkey, iv, 16 );
+  ak_mgm_adata_update( &mgm, associated, 16 );
+  ak_mgm_adata_update( &mgm, associated +16, sizeof( associated ) -16 );
+  ak_mgm_encrypt_update( &mgm, plain, out, 32 );
+  ak_mgm_encrypt_update( &mgm, plain +32, out +32, sizeof( plain ) -32 );
+  ak_mgm_finalize( &mgm, icode, sizeof( icode ));
+  printf(" kuznechik encrypt (known answer): ");
+  if( memcmp( icode, icode_one, sizeof( icode )) != 0 ) { printf("Wrong\n"); goto labex; }
+  printf("Ok\n");
+
+ /* расшифрование фрагментами на месте */
+  ak_mgm_clean( &mgm, &bkey, &bkey, iv, 16 );
+  ak_mgm_adata_update( &mgm, associated, sizeof( associated ));
+  ak_mgm_decrypt_update( &mgm, out, out, 48 );
+  ak_mgm_decrypt_update( &mgm, out +48, out +48, sizeof( plain ) -48 );
+  ak_mgm_finalize( &mgm, icode, sizeof( icode ));
+  printf(" kuznechik decrypt (known answer): ");
+  if(( memcmp( out, plain, sizeof( plain )) != 0 ) ||
+     ( memcmp( icode, icode_one, sizeof( icode )) != 0 )) { printf("Wrong\n"); goto labex; }
+  printf("Ok\n");
+
+  result = EXIT_SUCCESS;
+  labex: ak_bckey_destroy( &bkey );
+ return result;
+}
+
+/* ----------------------------------------------------------------------------------------------- */
+ #define messages_count (11)
+
+ int test_many( ak_function_bckey_create *create, ak_uint8 *adata,
+                                                 ak_uint8 *in, ak_uint8 *out1, ak_uint8 *out2 )
+{
+  struct bckey bkey;
+  size_t i, offset = 0;
+  int result = EXIT_FAILURE;
+  struct aead_message msg[messages_count];
+  ak_uint8 icode1[messages_count][16], icode2[messages_count][16];
+
+  create( &bkey );
+  ak_bckey_set_key( &bkey, key, sizeof( key ));
+
+ /* зашифрование каждого сообщения отдельно и всех сообщений одним пакетом */
+  for( i = 0; i < messages_count; i++ ) {
+     msg[i].iv = iv +i%4; msg[i].iv_size = bkey.bsize;
+     msg[i].adata = adata +i; msg[i].adata_size = 6*i;
+     msg[i].in = in +offset; msg[i].out = out2 +offset; msg[i].size = 1000*i + 3;
+     msg[i].icode = icode2[i]; msg[i].icode_size = bkey.bsize;
+     ak_bckey_encrypt_mgm( &bkey, &bkey, msg[i].adata, msg[i].adata_size, msg[i].in,
+                   out1 +offset, msg[i].size, msg[i].iv, bkey.bsize, icode1[i], bkey.bsize );
+     offset += msg[i].size;
+  }
+  ak_bckey_encrypt_mgm_many( &bkey, &bkey, msg, messages_count );
+  printf(" %s encrypt many: ", bkey.key.oid->name[0] );
+  for( i = 0; i < messages_count; i++ ) {
+     if(( msg[i].status != ak_error_ok ) ||
+        ( memcmp( icode1[i], icode2[i], bkey.bsize ) != 0 )) { printf("Wrong\n"); goto labex; }
+  }
+  if( memcmp( out1, out2, offset ) != 0 ) { printf("Wrong\n"); goto labex; }
+  printf("Ok\n");
+
+ /* расшифрование на месте; имитовставка одного из сообщений искажена */
+  for( i = 0; i < messages_count; i++ ) msg[i].in = msg[i].out;
+  icode2[3][0] ^= 0x01;
+  ak_aead_many( ak_bckey_decrypt_mgm, &bkey, &bkey, msg, messages_count );
+  printf(" %s decrypt many: ", bkey.key.oid->name[0] );
+  for( i = 0; i < messages_count; i++ ) {
+     if(( msg[i].status == ak_error_ok ) != ( i != 3 )) { printf("Wrong\n"); goto labex; }
+  }
+  if( memcmp( in, out2, offset ) != 0 ) { printf("Wrong\n"); goto labex; }
+ /* пакетная обработка реализована только для режима mgm */
+  if( ak_aead_many( ak_bckey_decrypt_xtsmac, &bkey, &bkey, msg, messages_count )
+                                       != ak_error_undefined_function ) { printf("Wrong\n"); goto labex; }
+  printf("Ok\n");
+
+  result = EXIT_SUCCESS;
+  labex: ak_bckey_destroy( &bkey );
+ return result;
+}
+
+/* ----------------------------------------------------------------------------------------------- */
+/* контрольный пример помещается в середину пакета из трех сообщений */
+ int test_many_known_answer( ak_uint8 *in )
+{
+  size_t i;
+  struct bckey bkey;
+  int result = EXIT_FAILURE;
+  struct aead_message msg[3];
+  ak_uint8 out[3][67], icode[3][16];
+
+  ak_libakrypt_set_openssl_compability( ak_false );
+  ak_bckey_create_kuznechik( &bkey );
+  ak_bckey_set_key( &bkey, key, sizeof( key ));
+
+  for( i = 0; i < 3; i++ ) {
+     msg[i].iv = iv; msg[i].iv_size = 16;
+     msg[i].adata = associated; msg[i].adata_size = sizeof( associated );
+     msg[i].in = in +i; msg[i].out = out[i]; msg[i].size = sizeof( plain );
+     msg[i].icode = icode[i]; msg[i].icode_size = 16;
+  }
+  msg[1].in = plain;
+  ak_bckey_encrypt_mgm_many( &bkey, &bkey, msg, 3 );
+  printf(" kuznechik encrypt many (known answer): ");
+  if(( msg[1].status != ak_error_ok ) ||
+     ( memcmp( icode[1], icode_one, sizeof( icode_one )) != 0 )) { printf("Wrong\n"); goto labex; }
+  printf("Ok\n");
+
+  for( i = 0; i < 3; i++ ) msg[i].in = msg[i].out;
+  ak_aead_many( ak_bckey_decrypt_mgm, &bkey, &bkey, msg, 3 );
+  printf(" kuznechik decrypt many (known answer): ");
+  if(( msg[1].status != ak_error_ok ) ||
+     ( memcmp( out[1], plain, sizeof( plain )) != 0 )) { printf("Wrong\n"); goto labex; }
+  printf("Ok\n");
+
+  result = EXIT_SUCCESS;
+  labex: ak_bckey_destroy( &bkey );
+ return result;
+}
+
+/* ----------------------------------------------------------------------------------------------- */
+ int main( void )
+{
+  size_t i, size = 65536 + 13, asize = 77;
+  int result = EXIT_SUCCESS;
+  ak_uint8 adata[77], *in = malloc( size ), *out1 = malloc( size ), *out2 = malloc( size );
+
+  if(( in == NULL ) || ( out1 == NULL ) || ( out2 == NULL )) return EXIT_FAILURE;
+  for( i = 0; i < size; i++ ) in[i] = (ak_uint8)( i*13 + 7 );
+  for( i = 0; i < asize; i++ ) adata[i] = (ak_uint8)( i*5 + 3 );
+
+ /* инициализируем библиотеку */
+  if( !ak_libakrypt_create( ak_function_log_stderr )) return ak_libakrypt_destroy();
+
+  if( test( ak_bckey_create_kuznechik, adata, asize, in, out1, out2, size ) != EXIT_SUCCESS )
+    result = EXIT_FAILURE;
+  if( test( ak_bckey_create_magma, adata, asize, in, out1, out2, size ) != EXIT_SUCCESS )
+    result = EXIT_FAILURE;
+  if( test_known_answer() != EXIT_SUCCESS ) result = EXIT_FAILURE;
+  if( test_many( ak_bckey_create_kuznechik, adata, in, out1, out2 ) != EXIT_SUCCESS )
+    result = EXIT_FAILURE;
+  if( test_many( ak_bckey_create_magma, adata, in, out1, out2 ) != EXIT_SUCCESS )
+    result = EXIT_FAILURE;
+  if( test_many_known_answer( in ) != EXIT_SUCCESS ) result = EXIT_FAILURE;
+
+  free( in ); free( out1 ); free( out2 );
+  ak_libakrypt_destroy();
+ return result;
+}
@@ -0,0 +1,151 @@
+/* ----------------------------------------------------------------------------------------------- */
+/* Тестовый пример, проверяющий совпадение хеш-кодов, вычисленных функцией ak_hash_ptr_many()
+   для массива независимых сообщений, и хеш-кодов, вычисленных функцией ak_hash_ptr()
+   для каждого сообщения отдельно, а также хеширование фрагментами произвольной длины,
+   расположенными по невыровненным адресам. Функция ak_hash_ptr_many() также проверяется
+   на контрольных примерах из ГОСТ Р 34.11-2012.
+
+   test-streebog01.c                                                                               */
+/* ----------------------------------------------------------------------------------------------- */
+
+ #include <stdio.h>
+ #include <stdlib.h>
+ #include <string.h>
+ #include <libakrypt.h>
+
+ #define messages_count (200)
+
+/* контрольные примеры 1 и 2 из ГОСТ Р 34.11-2012, приложение А */
+ static ak_uint8 m1[63] = {
+     0x30, 0x31, 0x32, 0x33, 0x34, 0x35, 0x36, 0x37, 0x38, 0x39, 0x30, 0x31, 0x32, 0x33, 0x34, 0x35,
+     0x36, 0x37, 0x38, 0x39, 0x30, 0x31, 0x32, 0x33, 0x34, 0x35, 0x36, 0x37, 0x38, 0x39, 0x30, 0x31,
+     0x32, 0x33, 0x34, 0x35, 0x36, 0x37, 0x38, 0x39, 0x30, 0x31, 0x32, 0x33, 0x34, 0x35, 0x36, 0x37,
+     0x38, 0x39, 0x30, 0x31, 0x32, 0x33, 0x34, 0x35, 0x36, 0x37, 0x38, 0x39, 0x30, 0x31, 0x32 };
+
+ static ak_uint8 m2[72] = {
+     0xd1, 0xe5, 0x20, 0xe2, 0xe5, 0xf2, 0xf0, 0xe8, 0x2c, 0x20, 0xd1, 0xf2, 0xf0, 0xe8, 0xe1, 0xee,
+     0xe6, 0xe8, 0x20, 0xe2, 0xed, 0xf3, 0xf6, 0xe8, 0x2c, 0x20, 0xe2, 0xe5, 0xfe, 0xf2, 0xfa, 0x20,
+     0xf1, 0x20, 0xec, 0xee, 0xf0, 0xff, 0x20, 0xf1, 0xf2, 0xf0, 0xe5, 0xeb, 0xe0, 0xec, 0xe8, 0x20,
+     0xed, 0xe0, 0x20, 0xf5, 0xf0, 0xe0, 0xe1, 0xf0, 0xfb, 0xff, 0x20, 0xef, 0xeb, 0xfa, 0xea, 0xfb,
+     0x20, 0xc8, 0xe3, 0xee, 0xf0, 0xe5, 0xe2, 0xfb };
+
+ static ak_uint8 streebog256_m1[32] = {
+     0x9d, 0x15, 0x1e, 0xef, 0xd8, 0x59, 0x0b, 0x89, 0xda, 0xa6, 0xba, 0x6c, 0xb7, 0x4a, 0xf9, 0x27,
+     0x5d, 0xd0, 0x51, 0x02, 0x6b, 0xb1, 0x49, 0xa4, 0x52, 0xfd, 0x84, 0xe5, 0xe5, 0x7b, 0x55, 0x00 };
+
+ static ak_uint8 streebog256_m2[32] = {
+     0x9d, 0xd2, 0xfe, 0x4e, 0x90, 0x40, 0x9e, 0x5d, 0xa8, 0x7f, 0x53, 0x97, 0x6d, 0x74, 0x05, 0xb0,
+     0xc0, 0xca, 0xc6, 0x28, 0xfc, 0x66, 0x9a, 0x74, 0x1d, 0x50, 0x06, 0x3c, 0x55, 0x7e, 0x8f, 0x50 };
+
+ static ak_uint8 streebog512_m1[64] = {
+     0x1b, 0x54, 0xd0, 0x1a, 0x4a, 0xf5, 0xb9, 0xd5, 0xcc, 0x3d, 0x86, 0xd6, 0x8d, 0x28, 0x54, 0x62,
+     0xb1, 0x9a, 0xbc, 0x24, 0x75, 0x22, 0x2f, 0x35, 0xc0, 0x85, 0x12, 0x2b, 0xe4, 0xba, 0x1f, 0xfa,
+     0x00, 0xad, 0x30, 0xf8, 0x76, 0x7b, 0x3a, 0x82, 0x38, 0x4c, 0x65, 0x74, 0xf0, 0x24, 0xc3, 0x11,
+     0xe2, 0xa4, 0x81, 0x33, 0x2b, 0x08, 0xef, 0x7f, 0x41, 0x79, 0x78, 0x91, 0xc1, 0x64, 0x6f, 0x48 };
+
+ static ak_uint8 streebog512_m2[64] = {
+     0x1e, 0x88, 0xe6, 0x22, 0x26, 0xbf, 0xca, 0x6f, 0x99, 0x94, 0xf1, 0xf2, 0xd5, 0x15, 0x69, 0xe0,
+     0xda, 0xf8, 0x47, 0x5a, 0x3b, 0x0f, 0xe6, 0x1a, 0x53, 0x00, 0xee, 0xe4, 0x6d, 0x96, 0x13, 0x76,
+     0x03, 0x5f, 0xe8, 0x35, 0x49, 0xad, 0xa2, 0xb8, 0x62, 0x0f, 0xcd, 0x7c, 0x49, 0x6c, 0xe5, 0xb3,
+     0x3f, 0x0c, 0xb9, 0xdd, 0xdc, 0x2b, 0x64, 0x60, 0x14, 0x3b, 0x03, 0xda, 0xba, 0xc9, 0xfb, 0x28 };
+
+/* ----------------------------------------------------------------------------------------------- */
+ int test( int ( *create )( ak_hash ), ak_uint8 *data )
+{
+  size_t i;
+  struct hash ctx;
+  int result = EXIT_FAILURE;
+  ak_pointer in[messages_count], out[messages_count];
+  size_t size[messages_count];
+  ak_uint8 codes[messages_count][64], code[64];
+
+  create( &ctx );
+  for( i = 0; i < messages_count; i++ ) {
+     in[i] = data +i; size[i] = i; out[i] = codes[i];
+  }
+  in[0] = NULL; /* пустое сообщение может не иметь данных */
+  if( ak_hash_ptr_many( &ctx, in, size, out, 64, messages_count ) != ak_error_ok ) goto labex;
+
+  printf(" %s many: ", ctx.oid->name[0] );
+  for( i = 0; i < messages_count; i++ ) {
+     ak_hash_ptr( &ctx, data +i, size[i], code, sizeof( code ));
+     if( memcmp( code, codes[i], ak_hash_get_tag_size( &ctx )) != 0 ) {
+       printf("Wrong (message length: %u)\n", (unsigned int) i ); goto labex;
+     }
+  }
+ /* отсутствие области памяти для хеш-кода должно приводить к ошибке */
+  out[1] = NULL;
+  if( ak_hash_ptr_many( &ctx, in, size, out, 64, messages_count ) != ak_error_null_pointer ) {
+    printf("Wrong (null pointer to hash code)\n"); goto labex;
+  }
+  printf("Ok\n");
+
+ /* хеширование фрагментами длины 1, 2, ..., начиная с невыровненного адреса */
+  printf(" %s update: ", ctx.oid->name[0] );
+  ak_hash_ptr( &ctx, data +1, 2*messages_count -1, codes[0], sizeof( codes[0] ));
+  ak_hash_clean( &ctx );
+  for( i = 1; i < 2*messages_count; i += size[0] ) {
+     size[0] = ak_min( i%19 +1, 2*messages_count - i );
+     ak_hash_update( &ctx, data +i, size[0] );
+  }
+  ak_hash_finalize( &ctx, NULL, 0, code, sizeof( code ));
+  if( memcmp( code, codes[0], ak_hash_get_tag_size( &ctx )) != 0 ) {
+    printf("Wrong\n"); goto labex;
+  }
+  printf("Ok\n");
+
+  result = EXIT_SUCCESS;
+  labex: ak_hash_destroy( &ctx );
+ return result;
+}
+
+/* ----------------------------------------------------------------------------------------------- */
+ int test_known_answer( int ( *create )( ak_hash ), ak_uint8 *r1, ak_uint8 *r2 )
+{
+  size_t i;
+  struct hash ctx;
+  int result = EXIT_FAILURE;
+  ak_pointer in[4] = { m1, m2, m2, m1 }, out[4];
+  size_t size[4] = { sizeof( m1 ), sizeof( m2 ), sizeof( m2 ), sizeof( m1 ) };
+  ak_uint8 codes[4][64];
+
+  create( &ctx );
+  for( i = 0; i < 4; i++ ) out[i] = codes[i];
+  printf(" %s many (known answer): ", ctx.oid->name[0] );
+  if( ak_hash_ptr_many( &ctx, in, size, out, 64, 4 ) != ak_error_ok ) {
+    printf("Wrong\n"); goto labex;
+  }
+  for( i = 0; i < 4; i++ )
+     if( memcmp( codes[i], size[i] == sizeof( m1 ) ? r1 : r2,
+                                               ak_hash_get_tag_size( &ctx )) != 0 ) {
+       printf("Wrong\n"); goto labex;
+     }
+  printf("Ok\n");
+
+  result = EXIT_SUCCESS;
+  labex: ak_hash_destroy( &ctx );
+ return result;
+}
+
+/* ----------------------------------------------------------------------------------------------- */
+ int main( void )
+{
+  size_t i;
+  int result = EXIT_SUCCESS;
+  ak_uint8 data[2*messages_count];
+
+  for( i = 0; i < sizeof( data ); i++ ) data[i] = (ak_uint8)( i*13 + 7 );
+
+ /* инициализируем библиотеку */
+  if( !ak_libakrypt_create( ak_function_log_stderr )) return ak_libakrypt_destroy();
+
+  if( test( ak_hash_create_streebog256, data ) != EXIT_SUCCESS ) result = EXIT_FAILURE;
+  if( test( ak_hash_create_streebog512, data ) != EXIT_SUCCESS ) result = EXIT_FAILURE;
+  if( test_known_answer( ak_hash_create_streebog256,
+                      streebog256_m1, streebog256_m2 ) != EXIT_SUCCESS ) result = EXIT_FAILURE;
+  if( test_known_answer( ak_hash_create_streebog512,
+                      streebog512_m1, streebog512_m2 ) != EXIT_SUCCESS ) result = EXIT_FAILURE;
+
+  ak_libakrypt_destroy();
+ return result;
+}
@@ -0,0 +1,176 @@
+/* ----------------------------------------------------------------------------------------------- */
+/* Тестовый пример, проверяющий древовидный режим хеширования Стрибог: совпадение результатов
+   многопоточного вычисления, последовательного вычисления фрагментами произвольной длины,
+   хеширования файла и значения, вычисленного непосредственно по описанию формата, а также
+   фиксированное значение хеш-кода для сообщения из контрольного примера ГОСТ Р 34.11-2012.
+
+   test-streebog02.c                                                                               */
+/* ----------------------------------------------------------------------------------------------- */
+
+ #include <stdio.h>
+ #include <stdlib.h>
+ #include <string.h>
+ #include <libakrypt.h>
+
+ #define leaf_size   ( ak_streebog_tree_leaf_size )
+
+/* контрольный пример 1 из ГОСТ Р 34.11-2012, приложение А, и его хеш-код Стрибог256 */
+ static ak_uint8 m1[63] = {
+     0x30, 0x31, 0x32, 0x33, 0x34, 0x35, 0x36, 0x37, 0x38, 0x39, 0x30, 0x31, 0x32, 0x33, 0x34, 0x35,
+     0x36, 0x37, 0x38, 0x39, 0x30, 0x31, 0x32, 0x33, 0x34, 0x35, 0x36, 0x37, 0x38, 0x39, 0x30, 0x31,
+     0x32, 0x33, 0x34, 0x35, 0x36, 0x37, 0x38, 0x39, 0x30, 0x31, 0x32, 0x33, 0x34, 0x35, 0x36, 0x37,
+     0x38, 0x39, 0x30, 0x31, 0x32, 0x33, 0x34, 0x35, 0x36, 0x37, 0x38, 0x39, 0x30, 0x31, 0x32 };
+
+ static ak_uint8 streebog256_m1[32] = {
+     0x9d, 0x15, 0x1e, 0xef, 0xd8, 0x59, 0x0b, 0x89, 0xda, 0xa6, 0xba, 0x6c, 0xb7, 0x4a, 0xf9, 0x27,
+     0x5d, 0xd0, 0x51, 0x02, 0x6b, 0xb1, 0x49, 0xa4, 0x52, 0xfd, 0x84, 0xe5, 0xe5, 0x7b, 0x55, 0x00 };
+
+/* древовидные хеш-коды сообщения m1 (один лист), вычисленные функцией reference() */
+ static ak_uint8 tree256_m1[32] = {
+     0x7b, 0xee, 0x24, 0xfe, 0x0c, 0x57, 0x17, 0x83, 0xac, 0xe5, 0x0c, 0xbd, 0xfa, 0x50, 0x87, 0xdc,
+     0x1e, 0xbc, 0xc5, 0xee, 0xbe, 0x95, 0x13, 0xc5, 0xf8, 0x7b, 0x7e, 0xf2, 0x5f, 0x52, 0xc3, 0x16 };
+
+ static ak_uint8 tree512_m1[64] = {
+     0x32, 0x1a, 0x61, 0x0e, 0x00, 0xab, 0xf4, 0xd1, 0xc7, 0xc3, 0x37, 0xc8, 0x55, 0x64, 0x59, 0x97,
+     0xd9, 0x9c, 0xea, 0x8b, 0x80, 0x27, 0x00, 0x93, 0x35, 0x7d, 0xdf, 0x39, 0xe2, 0x4c, 0x92, 0x1f,
+     0x76, 0x9d, 0xde, 0xab, 0xe4, 0xa8, 0x4d, 0x2b, 0x0a, 0xa6, 0xfd, 0xa1, 0xf1, 0x69, 0xad, 0x3d,
+     0xab, 0x98, 0xff, 0xc4, 0x2f, 0xa5, 0x4f, 0x49, 0x72, 0x38, 0xb1, 0xda, 0x21, 0x5a, 0xf9, 0x8e };
+
+/* ----------------------------------------------------------------------------------------------- */
+/* вычисление хеш-кода по описанию формата с помощью функции Стрибог */
+ void reference( int ( *create )( ak_hash ), ak_uint8 *data, size_t size, ak_uint8 *out )
+{
+  struct hash ctx;
+  size_t i, len, hsize, count = ( size + leaf_size -1 )/leaf_size;
+  ak_uint8 *leaf = malloc( leaf_size +1 ), *root = NULL;
+
+  if( count == 0 ) count = 1;
+  create( &ctx );
+  hsize = ak_hash_get_tag_size( &ctx );
+  root = malloc( count*hsize +9 );
+  for( i = 0; i < count; i++ ) {
+     len = ak_min( leaf_size, size - i*leaf_size );
+     memcpy( leaf, data +i*leaf_size, len );
+     leaf[len] = 0x00;
+     ak_hash_ptr( &ctx, leaf, len +1, root +i*hsize, hsize );
+  }
+  for( i = 0; i < 8; i++ ) root[count*hsize +i] = ( ak_uint8 )(( ak_uint64 )size >> ( 8*i ));
+  root[count*hsize +8] = 0x01;
+  ak_hash_ptr( &ctx, root, count*hsize +9, out, hsize );
+
+  free( leaf ); free( root );
+  ak_hash_destroy( &ctx );
+}
+
+/* ----------------------------------------------------------------------------------------------- */
+ int test( int ( *create )( ak_hash ), int ( *create_tree )( ak_hash ),
+                                                                    ak_uint8 *data, size_t size )
+{
+  size_t i, len;
+  struct hash ctx;
+  FILE *fp = NULL;
+  int result = EXIT_FAILURE;
+  ak_uint8 ref[64], code[64];
+
+  reference( create, data, size, ref );
+  create_tree( &ctx );
+  printf(" %s (%8u octets) ", ctx.oid->name[0], (unsigned int) size );
+
+ /* многопоточное вычисление */
+  ctx.data.tctx->threads = 4;
+  ak_hash_ptr( &ctx, data, size, code, sizeof( code ));
+  if( memcmp( code, ref, ak_hash_get_tag_size( &ctx )) != 0 ) {
+    printf("threads: Wrong\n"); goto labex;
+  }
+
+ /* последовательное вычисление фрагментами различной длины */
+  ctx.data.tctx->threads = 1;
+  ak_hash_clean( &ctx );
+  for( i = 0; i < size; i += len ) {
+     len = ak_min( 65536 + i%1000, size - i );
+     ak_hash_update( &ctx, data +i, len );
+  }
+  ak_hash_finalize( &ctx, NULL, 0, code, sizeof( code ));
+  if( memcmp( code, ref, ak_hash_get_tag_size( &ctx )) != 0 ) {
+    printf("update: Wrong\n"); goto labex;
+  }
+
+ /* хеширование файла */
+  ctx.data.tctx->threads = 3;
+  if(( fp = fopen( "test-streebog02.dat", "wb" )) == NULL ) goto labex;
+  fwrite( data, 1, size, fp );
+  fclose( fp );
+  ak_hash_file( &ctx, "test-streebog02.dat", code, sizeof( code ));
+  remove( "test-streebog02.dat" );
+  if( memcmp( code, ref, ak_hash_get_tag_size( &ctx )) != 0 ) {
+    printf("file: Wrong\n"); goto labex;
+  }
+  printf("Ok\n");
+
+  result = EXIT_SUCCESS;
+  labex: ak_hash_destroy( &ctx );
+ return result;
+}
+
+/* ----------------------------------------------------------------------------------------------- */
+ int test_known_answer( void )
+{
+  struct hash ctx;
+  int result = EXIT_FAILURE;
+  ak_uint8 code[64];
+
+  printf(" streebog tree (known answer) ");
+ /* функция Стрибог, на которой основана функция reference(), дает значение из стандарта */
+  ak_hash_create_streebog256( &ctx );
+  ak_hash_ptr( &ctx, m1, sizeof( m1 ), code, sizeof( code ));
+  ak_hash_destroy( &ctx );
+  if( memcmp( code, streebog256_m1, sizeof( streebog256_m1 )) != 0 ) {
+    printf("streebog256: Wrong\n"); return result;
+  }
+  reference( ak_hash_create_streebog256, m1, sizeof( m1 ), code );
+  if( memcmp( code, tree256_m1, sizeof( tree256_m1 )) != 0 ) {
+    printf("reference: Wrong\n"); return result;
+  }
+  ak_hash_create_streebog256_tree( &ctx );
+  ak_hash_ptr( &ctx, m1, sizeof( m1 ), code, sizeof( code ));
+  ak_hash_destroy( &ctx );
+  if( memcmp( code, tree256_m1, sizeof( tree256_m1 )) != 0 ) {
+    printf("tree256: Wrong\n"); return result;
+  }
+  ak_hash_create_streebog512_tree( &ctx );
+  ak_hash_ptr( &ctx, m1, sizeof( m1 ), code, sizeof( code ));
+  ak_hash_destroy( &ctx );
+  if( memcmp( code, tree512_m1, sizeof( tree512_m1 )) != 0 ) {
+    printf("tree512: Wrong\n"); return result;
+  }
+  printf("Ok\n");
+ return EXIT_SUCCESS;
+}
+
+/* ----------------------------------------------------------------------------------------------- */
+ int main( void )
+{
+  size_t i, j, size = 5*leaf_size + 77;
+  int result = EXIT_SUCCESS;
+  size_t sizes[5] = { 0, 100, leaf_size, 3*leaf_size, 5*leaf_size + 77 };
+  ak_uint8 *data = malloc( size );
+
+  if( data == NULL ) return EXIT_FAILURE;
+  for( i = 0; i < size; i++ ) data[i] = (ak_uint8)( i*17 + ( i >> 11 ));
+
+ /* инициализируем библиотеку */
+  if( !ak_libakrypt_create( ak_function_log_stderr )) return ak_libakrypt_destroy();
+
+  for( j = 0; j < 5; j++ ) {
+     if( test( ak_hash_create_streebog256, ak_hash_create_streebog256_tree,
+                                       data, sizes[j] ) != EXIT_SUCCESS ) result = EXIT_FAILURE;
+     if( test( ak_hash_create_streebog512, ak_hash_create_streebog512_tree,
+                                       data, sizes[j] ) != EXIT_SUCCESS ) result = EXIT_FAILURE;
+  }
+
+  if( test_known_answer() != EXIT_SUCCESS ) result = EXIT_FAILURE;
+
+  free( data );
+  ak_libakrypt_destroy();
+ return result;
+}
@@ -0,0 +1,123 @@
+/* ----------------------------------------------------------------------------------------------- */
+/* Тестовый пример, проверяющий совпадение результатов шифрования последовательности секторов
+   в режиме xts с результатами покомпонентного шифрования каждого сектора, а также
+   результат шифрования на тестовом примере из IEEE 1619-2007 (вектор 2, алгоритм AES-128).
+
+   test-xts-sectors.c                                                                              */
+/* ----------------------------------------------------------------------------------------------- */
+
+ #include <stdio.h>
+ #include <stdlib.h>
+ #include <string.h>
+ #include <libakrypt.h>
+
+ static ak_uint8 key[64] = {
+     0xef, 0xcd, 0xab, 0x89, 0x67, 0x45, 0x23, 0x01, 0x10, 0x32, 0x54, 0x76, 0x98, 0xba, 0xdc, 0xfe,
+     0x77, 0x66, 0x55, 0x44, 0x33, 0x22, 0x11, 0x00, 0xff, 0xee, 0xdd, 0xcc, 0xbb, 0xaa, 0x99, 0x88,
+     0x01, 0x23, 0x45, 0x67, 0x89, 0xab, 0xcd, 0xef, 0xfe, 0xdc, 0xba, 0x98, 0x76, 0x54, 0x32, 0x10,
+     0x88, 0x99, 0xaa, 0xbb, 0xcc, 0xdd, 0xee, 0xff, 0x00, 0x11, 0x22, 0x33, 0x44, 0x55, 0x66, 0x77 };
+
+/* результат зашифрования 32-х октетов 0x44 на ключах 0x11..11 и 0x22..22
+                                           для сектора с номером 0x3333333333, IEEE 1619-2007 */
+ static ak_uint8 ieee_out[32] = {
+     0xc4, 0x54, 0x18, 0x5e, 0x6a, 0x16, 0x93, 0x6e, 0x39, 0x33, 0x40, 0x38, 0xac, 0xef, 0x83, 0x8b,
+     0xfb, 0x18, 0x6f, 0xff, 0x74, 0x80, 0xad, 0xc4, 0x28, 0x93, 0x82, 0xec, 0xd6, 0xd3, 0x94, 0xf0 };
+
+/* ----------------------------------------------------------------------------------------------- */
+ int test( const char *name, ak_function_bckey_create *create, size_t keysize, ak_uint8 *in,
+                   ak_uint8 *out1, ak_uint8 *out2, size_t size, size_t sector_size, size_t threads )
+{
+  struct bckey ekey, akey;
+  int result = EXIT_FAILURE;
+  ak_uint64 sector = 0xfffffffffffffff0LL; /* проверяем переход через ноль */
+  size_t i, j;
+  ak_uint8 iv[16];
+
+  create( &ekey ); create( &akey );
+  ak_bckey_set_key( &ekey, key, keysize );
+  ak_bckey_set_key( &akey, key + keysize, keysize );
+
+ /* зашифровываем каждый сектор отдельно */
+  for( i = 0; i < size/sector_size; i++ ) {
+     memset( iv, 0, sizeof( iv ));
+     for( j = 0; j < 8; j++ ) iv[j] = ( ak_uint8 )(( sector + i ) >> ( 8*j ));
+     ak_bckey_encrypt_xts( &ekey, &akey, in + i*sector_size, out1 + i*sector_size,
+                                                                 sector_size, iv, sizeof( iv ));
+  }
+  printf(" %s (sector: %u bytes, threads: %u): ", name,
+                                               (unsigned int) sector_size, (unsigned int) threads );
+ /* зашифровываем все секторы за один вызов */
+  ak_bckey_encrypt_xts_sectors( &ekey, &akey, in, out2, size, sector, sector_size, threads );
+  if( memcmp( out1, out2, size ) != 0 ) { printf("Wrong encryption\n"); goto labex; }
+
+ /* расшифровываем на месте */
+  ak_bckey_decrypt_xts_sectors( &ekey, &akey, out2, out2, size, sector, sector_size, threads );
+  if( memcmp( in, out2, size ) != 0 ) { printf("Wrong decryption\n"); goto labex; }
+  printf("Ok\n");
+
+  result = EXIT_SUCCESS;
+  labex:
+   ak_bckey_destroy( &ekey );
+   ak_bckey_destroy( &akey );
+ return result;
+}
+
+/* ----------------------------------------------------------------------------------------------- */
+/* тестовый пример помещается в первый сектор последовательности,
+                                          обрабатываемой несколькими потоками */
+ int test_known_answer( ak_uint8 *in, ak_uint8 *out, size_t size )
+{
+  struct bckey ekey, akey;
+  int result = EXIT_FAILURE;
+  ak_uint8 k1[16], k2[16];
+
+  memset( k1, 0x11, sizeof( k1 ));
+  memset( k2, 0x22, sizeof( k2 ));
+  memset( in, 0x44, 32 );
+  ak_bckey_create_aes128( &ekey ); ak_bckey_create_aes128( &akey );
+  ak_bckey_set_key( &ekey, k1, sizeof( k1 ));
+  ak_bckey_set_key( &akey, k2, sizeof( k2 ));
+
+  printf(" aes128 (known answer): ");
+  if(( ak_bckey_encrypt_xts_sectors( &ekey, &akey, in, out, size,
+                                           0x3333333333LL, 32, 4 ) != ak_error_ok ) ||
+     ( memcmp( out, ieee_out, sizeof( ieee_out )) != 0 )) { printf("Wrong\n"); goto labex; }
+  printf("Ok\n");
+
+  result = EXIT_SUCCESS;
+  labex:
+   ak_bckey_destroy( &ekey );
+   ak_bckey_destroy( &akey );
+ return result;
+}
+
+/* ----------------------------------------------------------------------------------------------- */
+ int main( void )
+{
+  size_t i, size = 262144;
+  int result = EXIT_SUCCESS;
+  ak_uint8 *in = malloc( size ), *out1 = malloc( size ), *out2 = malloc( size );
+
+  if(( in == NULL ) || ( out1 == NULL ) || ( out2 == NULL )) return EXIT_FAILURE;
+  for( i = 0; i < size; i++ ) in[i] = (ak_uint8)( i*11 + 5 );
+
+ /* инициализируем библиотеку */
+  if( !ak_libakrypt_create( ak_function_log_stderr )) return ak_libakrypt_destroy();
+
+  for( i = 1; i < 5; i += 3 ) {
+     if( test( "kuznechik", ak_bckey_create_kuznechik, 32,
+                                            in, out1, out2, size, 4096, i ) != EXIT_SUCCESS )
+       result = EXIT_FAILURE;
+     if( test( "magma", ak_bckey_create_magma, 32,
+                                             in, out1, out2, size, 512, i ) != EXIT_SUCCESS )
+       result = EXIT_FAILURE;
+     if( test( "aes128", ak_bckey_create_aes128, 16,
+                                            in, out1, out2, size, 4096, i ) != EXIT_SUCCESS )
+       result = EXIT_FAILURE;
+  }
+  if( test_known_answer( in, out1, size ) != EXIT_SUCCESS ) result = EXIT_FAILURE;
+
+  free( in ); free( out1 ); free( out2 );
+  ak_libakrypt_destroy();
+ return result;
+}
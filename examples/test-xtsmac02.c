@@ -0,0 +1,169 @@
+/* ----------------------------------------------------------------------------------------------- */
+/* Тестовый пример, проверяющий совпадение результатов обработки данных в режиме xtsmac
+   последовательными фрагментами и за один вызов функций ak_bckey_encrypt_xtsmac() и
+   ak_bckey_decrypt_xtsmac(), а также результат обработки фрагментами на данных примера
+   test-xtsmac01.c.
+
+   test-xtsmac02.c                                                                                 */
+/* ----------------------------------------------------------------------------------------------- */
+
+ #include <stdio.h>
+ #include <stdlib.h>
+ #include <string.h>
+ #include <libakrypt.h>
+
+ static ak_uint8 key[32] = {
+     0xef, 0xcd, 0xab, 0x89, 0x67, 0x45, 0x23, 0x01, 0x10, 0x32, 0x54, 0x76, 0x98, 0xba, 0xdc, 0xfe,
+     0x77, 0x66, 0x55, 0x44, 0x33, 0x22, 0x11, 0x00, 0xff, 0xee, 0xdd, 0xcc, 0xbb, 0xaa, 0x99, 0x88 };
+
+ static ak_uint8 key2[32] = {
+     0x01, 0x23, 0x45, 0x67, 0x89, 0xab, 0xcd, 0xef, 0xfe, 0xdc, 0xba, 0x98, 0x76, 0x54, 0x32, 0x10,
+     0x00, 0x11, 0x22, 0x33, 0x44, 0x55, 0x66, 0x77, 0x88, 0x99, 0xaa, 0xbb, 0xcc, 0xdd, 0xee, 0xff };
+
+ static ak_uint8 iv[16] = {
+     0x88, 0x99, 0xaa, 0xbb, 0xcc, 0xdd, 0xee, 0xff, 0x00, 0x77, 0x66, 0x55, 0x44, 0x33, 0x22, 0x11 };
+
+/* ассоциированные данные и открытый текст примера test-xtsmac01.c */
+ static ak_uint8 associated[41] = {
+     0x01, 0x01, 0x01, 0x01, 0x01, 0x01, 0x01, 0x01, 0x02, 0x02, 0x02, 0x02, 0x02, 0x02, 0x02, 0x02,
+     0x03, 0x03, 0x03, 0x03, 0x03, 0x03, 0x03, 0x03, 0x04, 0x04, 0x04, 0x04, 0x04, 0x04, 0x04, 0x04,
+     0x05, 0x05, 0x05, 0x05, 0x05, 0x05, 0x05, 0x05, 0xea };
+
+ static ak_uint8 plain[67] = {
+     0x88, 0x99, 0xaa, 0xbb, 0xcc, 0xdd, 0xee, 0xff, 0x00, 0x77, 0x66, 0x55, 0x44, 0x33, 0x22, 0x11,
+     0x0a, 0xff, 0xee, 0xcc, 0xbb, 0xaa, 0x99, 0x88, 0x77, 0x66, 0x55, 0x44, 0x33, 0x22, 0x11, 0x00,
+     0x00, 0x0a, 0xff, 0xee, 0xcc, 0xbb, 0xaa, 0x99, 0x88, 0x77, 0x66, 0x55, 0x44, 0x33, 0x22, 0x11,
+     0x11, 0x00, 0x0a, 0xff, 0xee, 0xcc, 0xbb, 0xaa, 0x99, 0x88, 0x77, 0x66, 0x55, 0x44, 0x33, 0x22,
+     0xcc, 0xbb, 0xaa };
+
+/* шифртекст и имитовставка, вырабатываемые функцией ak_bckey_encrypt_xtsmac() на ключе key
+   (для шифрования и имитозащиты) и синхропосылке iv; значения получены до введения функций
+   обработки фрагментами */
+ static ak_uint8 known_out[67] = {
+     0x41, 0xa5, 0x12, 0xb6, 0x0f, 0xa9, 0x82, 0x75, 0x59, 0x72, 0x8c, 0x07, 0xb2, 0xb7, 0x08, 0x74,
+     0x6c, 0x5a, 0x77, 0x44, 0x1c, 0x79, 0xac, 0x0e, 0xe9, 0x67, 0xa3, 0x6d, 0x37, 0x6f, 0xa7, 0x8f,
+     0x2a, 0xed, 0x4f, 0x76, 0x68, 0xec, 0xbe, 0xa2, 0xf2, 0xbe, 0xfc, 0x8c, 0xcb, 0xa1, 0x6b, 0xc8,
+     0x0b, 0x8b, 0x62, 0xda, 0xce, 0x1d, 0xac, 0xbd, 0xdb, 0xd4, 0xf6, 0xc6, 0x35, 0xe8, 0xc8, 0x29,
+     0xe8, 0x94, 0x5a };
+
+ static ak_uint8 known_icode[16] = {
+     0xd0, 0x87, 0x37, 0xd3, 0x5c, 0x69, 0x85, 0x60, 0x67, 0xa1, 0xc1, 0x3a, 0xcf, 0xc6, 0x19, 0xc4 };
+
+/* ----------------------------------------------------------------------------------------------- */
+ int test( ak_function_bckey_create *create, ak_uint8 *adata, size_t asize,
+                                   ak_uint8 *in, ak_uint8 *out1, ak_uint8 *out2, size_t size )
+{
+  struct xtsmac xmac;
+  struct bckey ekey, akey;
+  size_t i, chunk = 4096;
+  int result = EXIT_FAILURE;
+  ak_uint8 icode1[16], icode2[16];
+
+  create( &ekey ); create( &akey );
+  ak_bckey_set_key( &ekey, key, sizeof( key ));
+  ak_bckey_set_key( &akey, key2, sizeof( key2 ));
+
+ /* зашифрование за один вызов */
+  ak_bckey_encrypt_xtsmac( &ekey, &akey, adata, asize, in, out1, size,
+                                                           iv, sizeof( iv ), icode1, sizeof( icode1 ));
+ /* зашифрование фрагментами; последний фрагмент содержит неполный блок */
+  memset( out2, 0, size ); memset( icode2, 0, sizeof( icode2 ));
+  ak_xtsmac_clean( &xmac, &ekey, &akey, iv, sizeof( iv ));
+  ak_xtsmac_adata_update( &xmac, adata, 32 );
+  ak_xtsmac_adata_update( &xmac, adata +32, asize -32 );
+  for( i = 0; size -i >= chunk +16; i += chunk )
+     ak_xtsmac_encrypt_update( &xmac, in +i, out2 +i, chunk );
+  ak_xtsmac_encrypt_update( &xmac, in +i, out2 +i, size -i );
+  ak_xtsmac_finalize( &xmac, icode2, sizeof( icode2 ));
+
+  printf(" %s encrypt: ", ekey.key.oid->name[0] );
+  if(( memcmp( out1, out2, size ) != 0 ) || ( memcmp( icode1, icode2, sizeof( icode1 )) != 0 )) {
+    printf("Wrong\n"); goto labex;
+  }
+  printf("Ok\n");
+
+ /* расшифрование фрагментами на месте */
+  ak_xtsmac_clean( &xmac, &ekey, &akey, iv, sizeof( iv ));
+  ak_xtsmac_adata_update( &xmac, adata, asize );
+  for( i = 0; size -i >= chunk +16; i += chunk )
+     ak_xtsmac_decrypt_update( &xmac, out2 +i, out2 +i, chunk );
+  ak_xtsmac_decrypt_update( &xmac, out2 +i, out2 +i, size -i );
+  ak_xtsmac_finalize( &xmac, icode2, sizeof( icode2 ));
+
+  printf(" %s decrypt: ", ekey.key.oid->name[0] );
+  if(( memcmp( in, out2, size ) != 0 ) || ( memcmp( icode1, icode2, sizeof( icode1 )) != 0 )) {
+    printf("Wrong\n"); goto labex;
+  }
+  printf("Ok\n");
+
+ /* после завершения обработка данных без повторной инициализации невозможна */
+  if( ak_xtsmac_encrypt_update( &xmac, in, out2, chunk ) == ak_error_ok ) goto labex;
+
+  result = EXIT_SUCCESS;
+  labex: ak_bckey_destroy( &ekey ); ak_bckey_destroy( &akey );
+ return result;
+}
+
+/* ----------------------------------------------------------------------------------------------- */
+ int test_known_answer( void )
+{
+  struct xtsmac xmac;
+  struct bckey bkey;
+  int result = EXIT_FAILURE;
+  ak_uint8 out[67], icode[16];
+
+  ak_bckey_create_kuznechik( &bkey );
+  ak_bckey_set_key( &bkey, key, sizeof( key ));
+
+ /* зашифрование фрагментами: ассоциированные данные 32+9 октетов, открытый текст 32+35 */
+  ak_xtsmac_clean( &xmac, &bkey, &bkey, iv, sizeof( iv ));
+  ak_xtsmac_adata_update( &xmac, associated, 32 );
+  ak_xtsmac_adata_update( &xmac, associated +32, sizeof( associated ) -32 );
+  ak_xtsmac_encrypt_update( &xmac, plain, out, 32 );
+  ak_xtsmac_encrypt_update( &xmac, plain +32, out +32, sizeof( plain ) -32 );
+  ak_xtsmac_finalize( &xmac, icode, sizeof( icode ));
+  printf(" kuznechik encrypt (known answer): ");
+  if(( memcmp( out, known_out, sizeof( known_out )) != 0 ) ||
+     ( memcmp( icode, known_icode, sizeof( icode )) != 0 )) { printf("Wrong\n"); goto labex; }
+  printf("Ok\n");
+
+ /* расшифрование фрагментами на месте */
+  ak_xtsmac_clean( &xmac, &bkey, &bkey, iv, sizeof( iv ));
+  ak_xtsmac_adata_update( &xmac, associated, sizeof( associated ));
+  ak_xtsmac_decrypt_update( &xmac, out, out, 32 );
+  ak_xtsmac_decrypt_update( &xmac, out +32, out +32, sizeof( plain ) -32 );
+  ak_xtsmac_finalize( &xmac, icode, sizeof( icode ));
+  printf(" kuznechik decrypt (known answer): ");
+  if(( memcmp( out, plain, sizeof( plain )) != 0 ) ||
+     ( memcmp( icode, known_icode, sizeof( icode )) != 0 )) { printf("Wrong\n"); goto labex; }
+  printf("Ok\n");
+
+  result = EXIT_SUCCESS;
+  labex: ak_bckey_destroy( &bkey );
+ return result;
+}
+
+/* ----------------------------------------------------------------------------------------------- */
+ int main( void )
+{
+  size_t i, size = 65536 + 13, asize = 77;
+  int result = EXIT_SUCCESS;
+  ak_uint8 adata[77], *in = malloc( size ), *out1 = malloc( size ), *out2 = malloc( size );
+
+  if(( in == NULL ) || ( out1 == NULL ) || ( out2 == NULL )) return EXIT_FAILURE;
+  for( i = 0; i < size; i++ ) in[i] = (ak_uint8)( i*13 + 7 );
+  for( i = 0; i < asize; i++ ) adata[i] = (ak_uint8)( i*5 + 3 );
+
+ /* инициализируем библиотеку */
+  if( !ak_libakrypt_create( ak_function_log_stderr )) return ak_libakrypt_destroy();
+
+  if( test( ak_bckey_create_kuznechik, adata, asize, in, out1, out2, size ) != EXIT_SUCCESS )
+    result = EXIT_FAILURE;
+  if( test( ak_bckey_create_magma, adata, asize, in, out1, out2, size ) != EXIT_SUCCESS )
+    result = EXIT_FAILURE;
+  if( test_known_answer() != EXIT_SUCCESS ) result = EXIT_FAILURE;
+
+  free( in ); free( out1 ); free( out2 );
+  ak_libakrypt_destroy();
+ return result;
+}
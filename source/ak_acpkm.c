@@ -4,6 +4,11 @@
 /*                                                                                                 */
 /*  Файл ak_acpkm.h                                                                                */
 /*  - содержит реализацию криптографических алгоритмов семейства ACPKM из Р 1323565.1.017—2018     */
+/* ----------------------------------------------------------------------------------------------- */
+#ifdef AK_HAVE_PTHREAD_H
+ #include <pthread.h>
+#endif
+
 /* ----------------------------------------------------------------------------------------------- */
  #include <libakrypt-internal.h>
 
@@ -46,16 +51,15 @@
          bkey->encrypt( &bkey->key, acpkm +8, new_key +8 );
          bkey->encrypt( &bkey->key, acpkm +16, new_key +16 );
          bkey->encrypt( &bkey->key, acpkm +24, new_key +24 );
-         counter = ak_libakrypt_get_option_by_name( "acpkm_section_magma_block_count" );
          break;
       case 16: /* шифр с длиной блока 128 бит */
          bkey->encrypt( &bkey->key, acpkm, new_key );
          bkey->encrypt( &bkey->key, acpkm +16, new_key +16 );
-         counter = ak_libakrypt_get_option_by_name( "acpkm_section_kuznechik_block_count" );
          break;
       default: return ak_error_message( ak_error_wrong_block_cipher,
                                            __func__ , "incorrect block size of block cipher key" );
    }
+  counter = bkey->key.options.acpkm_section_block_count;
 
  /* присваиваем ключу значение */
   if(( error = ak_bckey_set_key( bkey, new_key, bkey->key.key_size )) != ak_error_ok )
@@ -70,91 +74,92 @@
 
 /* ----------------------------------------------------------------------------------------------- */
 #ifdef AK_LITTLE_ENDIAN
-  #define acpkm_block64 {\
-              nkey.encrypt( &nkey.key, ctr, yaout );\
-              ctr[0] += 1;\
-              ((ak_uint64 *) outptr)[0] = yaout[0] ^ ((ak_uint64 *) inptr)[0];\
-              outptr++; inptr++;\
-           }
-
-  #define acpkm_block128 {\
-              nkey.encrypt( &nkey.key, ctr, yaout );\
-              if(( ctr[0] += 1 ) == 0 ) ctr[1]++;\
-              ((ak_uint64 *) outptr)[0] = yaout[0] ^ ((ak_uint64 *) inptr)[0];\
-              ((ak_uint64 *) outptr)[1] = yaout[1] ^ ((ak_uint64 *) inptr)[1];\
-              outptr += 2; inptr += 2;\
-           }
-
+  #define acpkm_increment64( ctr ) { ctr[0] += 1; }
+  #define acpkm_increment128( ctr ) { if(( ctr[0] += 1 ) == 0 ) ctr[1]++; }
 #else
-  #define acpkm_block64 {\
-              nkey.encrypt( &nkey.key, ctr, yaout );\
-              ctr[0] = bswap_64( ctr[0] ); ctr[0] += 1; ctr[0] = bswap_64( ctr[0] );\
-              ((ak_uint64 *) outptr)[0] = yaout[0] ^ ((ak_uint64 *) inptr)[0];\
-              outptr++; inptr++;\
-           }
-
-  #define acpkm_block128 {\
-              nkey.encrypt( &nkey.key, ctr, yaout );\
-              ctr[0] = bswap_64( ctr[0] ); ctr[0] += 1; ctr[0] = bswap_64( ctr[0] );\
-              if( ctr[0] == 0 ) { \
-                ctr[1] = bswap_64( ctr[0] ); ctr[1] += 1; ctr[1] = bswap_64( ctr[0] );\
-              }\
-              ((ak_uint64 *) outptr)[0] = yaout[0] ^ ((ak_uint64 *) inptr)[0];\
-              ((ak_uint64 *) outptr)[1] = yaout[1] ^ ((ak_uint64 *) inptr)[1];\
-              outptr += 2; inptr += 2;\
+  #define acpkm_increment64( ctr ) { ctr[0] = bswap_64( bswap_64( ctr[0] ) + 1 ); }
+  #define acpkm_increment128( ctr ) {\
+              ctr[0] = bswap_64( bswap_64( ctr[0] ) + 1 );\
+              if( ctr[0] == 0 ) ctr[1] = bswap_64( bswap_64( ctr[1] ) + 1 );\
            }
 #endif
 
 /* ----------------------------------------------------------------------------------------------- */
-/*! В режиме `ACPKM` для шифрования используется операция гаммирования - операция сложения
-    открытого (зашифровываемого) текста с гаммой, вырабатываемой шифром, по модулю два.
-    Поэтому, для зашифрования и расшифрования информациии используется одна и та же функция.
-
-    В процессе шифрования исходные данные разбиваются на секции фиксированной длины, после чего
-    каждая секция шифруется на своем ключе. Длина секции является параметром алгоритма и
-    не должна превосходить величины, определяемой одной из следующих технических характеристик
-    (опций)
-
-     - `ackpm_section_magma_block_count`,
-     - `ackpm_section_kuznechik_block_count`.
-
-    Значение синхропосылки `iv` копируется во временную область памяти и, в ходе выполнения
-    функции, не изменяется. Повторный вызов функции ak_bckey_ctr_acpkm() с нулевым
-    указатетем на синхропосылу, как в случае функции ak_bckey_ctr(), не допускается.
+/*! \brief Функция гаммирования заданного количества блоков на ключе текущей секции.
+    \details Значения счетчика формируются группами по \ref ak_bckey_batch_blocks блоков
+    и зашифровываются за один вызов многоблочной функции; после выполнения функции
+    значение счетчика `ctr` увеличивается на количество обработанных блоков.
+
+    @param nkey Контекст ключа текущей секции.
+    @param ctr Текущее значение счетчика.
+    @param inptr Указатель на входные данные.
+    @param outptr Указатель на выходные данные.
+    @param blocks Количество обрабатываемых блоков.                                                */
+/* ----------------------------------------------------------------------------------------------- */
+ static void ak_bckey_ctr_acpkm_blocks( ak_bckey nkey, ak_uint64 *ctr,
+                                           ak_uint64 *inptr, ak_uint64 *outptr, ssize_t blocks )
+{
+  ssize_t j, n;
+  ak_uint64 counter[2*ak_bckey_batch_blocks], gamma[2*ak_bckey_batch_blocks];
+
+  while( blocks > 0 ) {
+    n = ak_min( blocks, ak_bckey_batch_blocks );
+    if( nkey->bsize == 8 ) {
+      for( j = 0; j < n; j++ ) { counter[j] = ctr[0]; acpkm_increment64( ctr ); }
+    } else {
+      for( j = 0; j < n; j++ ) {
+         counter[2*j] = ctr[0]; counter[2*j+1] = ctr[1]; acpkm_increment128( ctr );
+      }
+    }
+    ak_bckey_encrypt_blocks( nkey, counter, gamma, (size_t) n );
+    ak_bckey_xor_gamma( outptr, inptr, gamma, (size_t) n*nkey->bsize );
+    inptr += n*(ssize_t)( nkey->bsize >> 3 ); outptr += n*(ssize_t)( nkey->bsize >> 3 );
+    blocks -= n;
+  }
+}
 
-    @param bkey Контекст ключа алгоритма блочного шифрования,
-    используемый для шифрования и порождения цепочки производных ключей.
-    @param in Указатель на область памяти, где хранятся входные
-    (зашифровываемые/расшифровываемые) данные
-    @param out Указатель на область памяти, куда помещаются выходные
-    (расшифровываемые/зашифровываемые) данные; этот указатель может совпадать с in
-    @param size Размер зашировываемых данных (в байтах). Длина зашифровываемых данных может
-    принимать любое значение, не превосходящее \f$ 2^{\frac{8n}{2}-1}\f$, где \f$ n \f$
-    длина блока алгоритма шифрования (8 или 16 байт).
+/* ----------------------------------------------------------------------------------------------- */
+/*! \brief Функция увеличивает значение счетчика на заданное количество блоков. */
+/* ----------------------------------------------------------------------------------------------- */
+ static void ak_bckey_ctr_acpkm_shift( ak_uint64 *ctr, size_t bsize, ak_uint64 offset )
+{
+ #ifdef AK_LITTLE_ENDIAN
+  ak_uint64 x = ctr[0];
+  ctr[0] += offset;
+  if(( bsize == 16 ) && ( ctr[0] < x )) ctr[1]++;
+ #else
+  ak_uint64 x = bswap_64( ctr[0] );
+  ctr[0] = bswap_64( x + offset );
+  if(( bsize == 16 ) && ( x + offset < x )) ctr[1] = bswap_64( bswap_64( ctr[1] ) + 1 );
+ #endif
+}
 
-    @param section_size Размер одной секции в байтах. Данная величина должна быть кратна длине блока
-    используемого алгоритма шифрования.
+/* ----------------------------------------------------------------------------------------------- */
+/*! \brief Функция выполняет проверки параметров режима `CTR-ACPKM`, уменьшает ресурс ключа
+    на одно сообщение и формирует начальное значение счетчика.
 
-    @param iv имитовставка
-    @param iv_size длина имитовставки (в байтах)
+    @param bkey Контекст исходного ключа алгоритма блочного шифрования.
+    @param section_size Размер одной секции в байтах.
+    @param iv Синхропосылка.
+    @param iv_size Длина синхропосылки (в байтах).
+    @param seclen Указатель, по которому помещается длина секции в блоках.
+    @param maxseclen Указатель, по которому помещается максимально допустимая длина секции.
+    @param ctr Массив, в который помещается начальное значение счетчика.
 
     @return В случае возникновения ошибки функция возвращает ее код, в противном случае
     возвращается \ref ak_error_ok (ноль)                                                           */
 /* ----------------------------------------------------------------------------------------------- */
- int ak_bckey_ctr_acpkm( ak_bckey bkey, ak_pointer in, ak_pointer out, size_t size,
-                                                 size_t section_size, ak_pointer iv, size_t iv_size)
+ static int ak_bckey_ctr_acpkm_prepare( ak_bckey bkey, size_t section_size, ak_pointer iv,
+                           size_t iv_size, ssize_t *seclen, ssize_t *maxseclen, ak_uint64 *ctr )
 {
-  struct bckey nkey;
-  int error = ak_error_ok;
-  ssize_t j = 0, sections = 0, tail = 0, seclen = 0, maxseclen = 0, mcount = 0;
-  ak_uint64 yaout[2], *inptr = (ak_uint64 *)in, *outptr = (ak_uint64 *)out, ctr[2] = { 0, 0 };
+  ssize_t mcount = 0;
 
  /* выполняем проверку размера входных данных */
   if( section_size%bkey->bsize != 0 )
     return ak_error_message( ak_error_wrong_block_cipher_length,
                                __func__ , "the length of section is not divided by block length" );
  /* проверяем целостность ключа */
-  if( bkey->key.check_icode( &bkey->key ) != ak_true )
+  if( ak_skey_verify_icode( &bkey->key, section_size/bkey->bsize ) != ak_true )
     return ak_error_message( ak_error_wrong_key_icode, __func__,
                                                   "incorrect integrity code of secret key value" );
  /* проверяем размер синхропосылки */
@@ -166,28 +171,27 @@
 
  /* получаем максимально возможную длину секции, количество сообщений на одном ключе,
                                                              а также устанавливаем синхропосылку */
+  ctr[0] = ctr[1] = 0;
   switch( bkey->bsize ) {
     case 8:
-       maxseclen = ak_libakrypt_get_option_by_name( "acpkm_section_magma_block_count" );
-       mcount = ak_libakrypt_get_option_by_name( "magma_cipher_resource" )/maxseclen;
        #ifdef AK_LITTLE_ENDIAN
-         ctr[0] = ((ak_uint64 *)iv)[0] << 32;
+         ctr[0] = ((ak_uint64)((ak_uint32 *)iv)[0] ) << 32;
        #else
          ctr[0] = ((ak_uint32 *)iv)[0];
        #endif
       break;
 
     case 16:
-       maxseclen = ak_libakrypt_get_option_by_name( "acpkm_section_kuznechik_block_count" );
-       mcount = ak_libakrypt_get_option_by_name( "kuznechik_cipher_resource" )/maxseclen;
        ctr[1] = ((ak_uint64 *) iv)[0];
       break;
     default: return ak_error_message( ak_error_wrong_block_cipher,
                                            __func__ , "incorrect block size of block cipher key" );
   }
+  *maxseclen = bkey->key.options.acpkm_section_block_count;
+  mcount = bkey->key.options.cipher_resource/ *maxseclen;
  /* проверяем, что пользователь определил длину секции не очень большим значением */
-  seclen = ( ssize_t )( section_size/bkey->bsize );
-  if( seclen > maxseclen ) return ak_error_message( ak_error_wrong_length, __func__,
+  *seclen = ( ssize_t )( section_size/bkey->bsize );
+  if( *seclen > *maxseclen ) return ak_error_message( ak_error_wrong_length, __func__,
                                                                  "section has very large length" );
  /* проверяем ресурс ключа перед использованием */
   if( bkey->key.resource.value.type != key_using_resource ) { /* мы пришли сюда в первый раз */
@@ -201,54 +205,284 @@
        else bkey->key.resource.value.counter--;
      }
 
- /* теперь размножаем исходный ключ */
-  if(( error = ak_bckey_create_and_set_bckey( &nkey, bkey )) != ak_error_ok )
-    return ak_error_message( error, __func__, "incorrect key duplication" );
- /* и меняем ресурс для производного ключа */
-  nkey.key.resource.value.counter = maxseclen;
+ return ak_error_ok;
+}
+
+/* ----------------------------------------------------------------------------------------------- */
+/*! \brief Функция гаммирует последовательность секций, начиная с секции, ключ которой
+    содержится в `nkey`, после чего обрабатывает фрагмент данных длины `tail`,
+    не кратный длине секции.
+
+    @param nkey Контекст ключа первой обрабатываемой секции; изменяется в ходе работы функции.
+    @param ctr Значение счетчика для первого блока первой секции.
+    @param inptr Указатель на входные данные.
+    @param outptr Указатель на выходные данные.
+    @param sections Количество полных секций.
+    @param seclen Длина секции (в блоках).
+    @param tail Длина фрагмента (в байтах), следующего за полными секциями.
+
+    @return В случае возникновения ошибки функция возвращает ее код, в противном случае
+    возвращается \ref ak_error_ok (ноль)                                                           */
+/* ----------------------------------------------------------------------------------------------- */
+ static int ak_bckey_ctr_acpkm_sections( ak_bckey nkey, ak_uint64 *ctr, ak_uint64 *inptr,
+                             ak_uint64 *outptr, ssize_t sections, ssize_t seclen, ssize_t tail )
+{
+  ssize_t j = 0;
+  ak_uint64 yaout[2];
+  int error = ak_error_ok;
 
- /* дальнейшие криптографические действия применяются к новому экземпляру ключа */
-  sections = ( ssize_t )( size/section_size );
-  tail = ( ssize_t )( size - ( size_t )( sections*seclen )*nkey.bsize );
   if( sections > 0 ) {
     do{
-       switch( nkey.bsize ) { /* обрабатываем одну секцию */
-         case 8: for( j = 0; j < seclen; j++ ) acpkm_block64; break;
-         case 16: for( j = 0; j < seclen; j++ ) acpkm_block128; break;
-         default: ak_error_message( ak_error_wrong_block_cipher,
-                                           __func__ , "incorrect block size of block cipher key" );
-       }
+      /* обрабатываем одну секцию */
+       ak_bckey_ctr_acpkm_blocks( nkey, ctr, inptr, outptr, seclen );
+       inptr += seclen*(ssize_t)( nkey->bsize >> 3 ); outptr += seclen*(ssize_t)( nkey->bsize >> 3 );
       /* вычисляем следующий ключ */
-       if(( error = ak_bckey_next_acpkm_key( &nkey )) != ak_error_ok ) {
-         ak_error_message_fmt( error, __func__, "incorrect key generation after %u sections",
+       if(( error = ak_bckey_next_acpkm_key( nkey )) != ak_error_ok )
+         return ak_error_message_fmt( error, __func__, "incorrect key generation after %u sections",
                                                                          (unsigned int) sections );
-         goto labex;
-       }
     } while( --sections > 0 );
   } /* конец обработки случая, когда sections > 0 */
 
   if( tail ) { /* теперь обрабатываем фрагмент данных, не кратный длине секции */
-    if(( seclen = tail/(ssize_t)( nkey.bsize )) > 0 ) {
-       switch( nkey.bsize ) { /* обрабатываем данные, кратные длине блока */
-         case 8: for( j = 0; j < seclen; j++ ) acpkm_block64; break;
-         case 16: for( j = 0; j < seclen; j++ ) acpkm_block128; break;
-         default: ak_error_message( ak_error_wrong_block_cipher,
-                                            __func__ , "incorrect block size of block cipher key" );
-       }
+    if(( seclen = tail/(ssize_t)( nkey->bsize )) > 0 ) {
+      /* обрабатываем данные, кратные длине блока */
+       ak_bckey_ctr_acpkm_blocks( nkey, ctr, inptr, outptr, seclen );
+       inptr += seclen*(ssize_t)( nkey->bsize >> 3 ); outptr += seclen*(ssize_t)( nkey->bsize >> 3 );
     }
   /* остался последний фрагмент, длина которого меньше длины блока
                       в качестве гаммы мы используем старшие байты */
-    if(( tail -= seclen*(ssize_t)( nkey.bsize )) > 0 ) {
-      nkey.encrypt( &nkey.key, ctr, yaout );
+    if(( tail -= seclen*(ssize_t)( nkey->bsize )) > 0 ) {
+      nkey->encrypt( &nkey->key, ctr, yaout );
       for( j = 0; j < tail; j++ ) ((ak_uint8 *) outptr)[j] =
-                         ((ak_uint8 *)yaout)[(ssize_t)nkey.bsize-tail+j] ^ ((ak_uint8 *) inptr)[j];
+                        ((ak_uint8 *)yaout)[(ssize_t)nkey->bsize-tail+j] ^ ((ak_uint8 *) inptr)[j];
     }
   }
 
-  labex: ak_bckey_destroy( &nkey );
  return error;
 }
 
+/* ----------------------------------------------------------------------------------------------- */
+/*! В режиме `ACPKM` для шифрования используется операция гаммирования - операция сложения
+    открытого (зашифровываемого) текста с гаммой, вырабатываемой шифром, по модулю два.
+    Поэтому, для зашифрования и расшифрования информациии используется одна и та же функция.
+
+    В процессе шифрования исходные данные разбиваются на секции фиксированной длины, после чего
+    каждая секция шифруется на своем ключе. Длина секции является параметром алгоритма и
+    не должна превосходить величины, определяемой одной из следующих технических характеристик
+    (опций)
+
+     - `ackpm_section_magma_block_count`,
+     - `ackpm_section_kuznechik_block_count`.
+
+    Значение синхропосылки `iv` копируется во временную область памяти и, в ходе выполнения
+    функции, не изменяется. Повторный вызов функции ak_bckey_ctr_acpkm() с нулевым
+    указатетем на синхропосылу, как в случае функции ak_bckey_ctr(), не допускается.
+
+    @param bkey Контекст ключа алгоритма блочного шифрования,
+    используемый для шифрования и порождения цепочки производных ключей.
+    @param in Указатель на область памяти, где хранятся входные
+    (зашифровываемые/расшифровываемые) данные
+    @param out Указатель на область памяти, куда помещаются выходные
+    (расшифровываемые/зашифровываемые) данные; этот указатель может совпадать с in
+    @param size Размер зашировываемых данных (в байтах). Длина зашифровываемых данных может
+    принимать любое значение, не превосходящее \f$ 2^{\frac{8n}{2}-1}\f$, где \f$ n \f$
+    длина блока алгоритма шифрования (8 или 16 байт).
+
+    @param section_size Размер одной секции в байтах. Данная величина должна быть кратна длине блока
+    используемого алгоритма шифрования.
+
+    @param iv имитовставка
+    @param iv_size длина имитовставки (в байтах)
+
+    @return В случае возникновения ошибки функция возвращает ее код, в противном случае
+    возвращается \ref ak_error_ok (ноль)                                                           */
+/* ----------------------------------------------------------------------------------------------- */
+ int ak_bckey_ctr_acpkm( ak_bckey bkey, ak_pointer in, ak_pointer out, size_t size,
+                                                 size_t section_size, ak_pointer iv, size_t iv_size)
+{
+  struct bckey nkey;
+  int error = ak_error_ok;
+  ssize_t sections = 0, tail = 0, seclen = 0, maxseclen = 0;
+  ak_uint64 ctr[2] = { 0, 0 };
+
+  if(( error = ak_bckey_ctr_acpkm_prepare( bkey, section_size,
+                                      iv, iv_size, &seclen, &maxseclen, ctr )) != ak_error_ok )
+    return error;
+
+ /* теперь размножаем исходный ключ */
+  if(( error = ak_bckey_create_and_set_bckey( &nkey, bkey )) != ak_error_ok )
+    return ak_error_message( error, __func__, "incorrect key duplication" );
+ /* и меняем ресурс для производного ключа */
+  nkey.key.resource.value.counter = maxseclen;
+
+ /* дальнейшие криптографические действия применяются к новому экземпляру ключа */
+  sections = ( ssize_t )( size/section_size );
+  tail = ( ssize_t )( size - ( size_t )( sections*seclen )*nkey.bsize );
+  error = ak_bckey_ctr_acpkm_sections( &nkey, ctr, in, out, sections, seclen, tail );
+
+  ak_bckey_destroy( &nkey );
+ return error;
+}
+
+#ifdef AK_HAVE_PTHREAD_H
+/* ----------------------------------------------------------------------------------------------- */
+/*! \brief Последовательность секций, обрабатываемая одним потоком в режиме `CTR-ACPKM`. */
+ typedef struct bckey_acpkm_piece {
+  /*! \brief Ключ первой секции, обрабатываемой потоком. */
+   struct bckey key;
+  /*! \brief Значение счетчика для первого блока первой секции. */
+   ak_uint64 ctr[2];
+  /*! \brief Указатель на входные данные. */
+   ak_uint64 *in;
+  /*! \brief Указатель на выходные данные. */
+   ak_uint64 *out;
+  /*! \brief Количество полных секций. */
+   ssize_t sections;
+  /*! \brief Длина секции (в блоках). */
+   ssize_t seclen;
+  /*! \brief Длина фрагмента, не кратного длине секции (только для последнего потока). */
+   ssize_t tail;
+  /*! \brief Код ошибки, возвращенный при обработке секций. */
+   int error;
+  /*! \brief Дескриптор потока. */
+   pthread_t thread;
+  /*! \brief Флаг того, что поток был успешно создан. */
+   bool_t started;
+ } *ak_bckey_acpkm_piece;
+
+/* ----------------------------------------------------------------------------------------------- */
+/*! \brief Функция потока, гаммирующая последовательность секций. */
+ static void *ak_bckey_ctr_acpkm_thread( void *ptr )
+{
+  ak_bckey_acpkm_piece piece = ( ak_bckey_acpkm_piece ) ptr;
+  piece->error = ak_bckey_ctr_acpkm_sections( &piece->key, piece->ctr, piece->in, piece->out,
+                                                   piece->sections, piece->seclen, piece->tail );
+ return NULL;
+}
+#endif
+
+/* ----------------------------------------------------------------------------------------------- */
+/*! Функция вырабатывает тот же результат, что и функция ak_bckey_ctr_acpkm(), распределяя
+    секции между несколькими потоками. Поскольку ключ каждой секции вычисляется из ключа
+    предыдущей, цепочка ключей вычисляется последовательно (это требует одного зашифрования
+    на секцию), после чего каждый поток получает копию ключа своей первой секции и
+    соответствующее ей значение счетчика. Ресурс ключа `bkey` уменьшается один раз, как при
+    обработке одного сообщения.
+
+    Потоки и копии ключей создаются при каждом вызове функции (пул потоков не используется);
+    создание копии требует не более одной развертки ключа на поток, что сопоставимо со
+    стоимостью выработки ключа очередной секции, поэтому функция предназначена для обработки
+    больших объемов данных. Если библиотека собрана без поддержки потоков или объем данных
+    мал, то функция вызывает ak_bckey_ctr_acpkm().
+
+    @param bkey Контекст ключа алгоритма блочного шифрования,
+    используемый для шифрования и порождения цепочки производных ключей.
+    @param in Указатель на область памяти, где хранятся входные данные.
+    @param out Указатель на область памяти, куда помещаются выходные данные;
+    этот указатель может совпадать с in.
+    @param size Размер зашировываемых данных (в байтах).
+    @param section_size Размер одной секции в байтах.
+    @param iv Синхропосылка.
+    @param iv_size Длина синхропосылки (в байтах).
+    @param threads Количество используемых потоков; нулевое значение означает, что
+    количество потоков совпадает с количеством доступных процессорных ядер.
+
+    @return В случае возникновения ошибки функция возвращает ее код, в противном случае
+    возвращается \ref ak_error_ok (ноль)                                                           */
+/* ----------------------------------------------------------------------------------------------- */
+ int ak_bckey_ctr_acpkm_threads( ak_bckey bkey, ak_pointer in, ak_pointer out, size_t size,
+                             size_t section_size, ak_pointer iv, size_t iv_size, size_t threads )
+{
+#ifdef AK_HAVE_PTHREAD_H
+  struct bckey nkey;
+  size_t i, count = 0;
+  ak_bckey_acpkm_piece pieces = NULL;
+  int error = ak_error_ok;
+  ssize_t sections = 0, seclen = 0, maxseclen = 0, first = 0, len = 0;
+  ak_uint64 ctr[2] = { 0, 0 };
+
+  if( bkey == NULL ) return ak_error_message( ak_error_null_pointer, __func__,
+                                                        "using null pointer to block cipher key" );
+  if(( section_size == 0 ) || ( bkey->bsize == 0 ))
+    return ak_bckey_ctr_acpkm( bkey, in, out, size, section_size, iv, iv_size );
+  sections = ( ssize_t )( size/section_size );
+  threads = ak_min( ak_bckey_get_threads_count( threads ),
+                                       size/( bkey->bsize*ak_bckey_thread_blocks ));
+  threads = ak_min( threads, ( size_t ) sections );
+  if(( threads < 2 ) || !ak_bckey_is_duplicable( bkey ))
+    return ak_bckey_ctr_acpkm( bkey, in, out, size, section_size, iv, iv_size );
+
+  if(( error = ak_bckey_ctr_acpkm_prepare( bkey, section_size,
+                                      iv, iv_size, &seclen, &maxseclen, ctr )) != ak_error_ok )
+    return error;
+  if(( error = ak_bckey_create_and_set_bckey( &nkey, bkey )) != ak_error_ok )
+    return ak_error_message( error, __func__, "incorrect key duplication" );
+  nkey.key.resource.value.counter = maxseclen;
+
+  if(( pieces = calloc( threads, sizeof( struct bckey_acpkm_piece ))) == NULL ) {
+    ak_error_message( error = ak_error_out_of_memory, __func__,
+                                                         "incorrect memory allocation for threads" );
+    goto labex;
+  }
+
+ /* вычисляем цепочку ключей и формируем для каждого потока
+                                     копию ключа его первой секции и значение счетчика */
+  for( count = 0; count < threads; count++ ) {
+     ak_bckey_acpkm_piece piece = pieces + count;
+     len = sections/( ssize_t )threads + (( ssize_t )count < sections%( ssize_t )threads );
+
+     if(( error = ak_bckey_create_and_set_bckey( &piece->key, &nkey )) != ak_error_ok ) {
+       ak_error_message( error, __func__, "incorrect key duplication" );
+       goto labex;
+     }
+     piece->key.key.resource.value.counter = maxseclen;
+     piece->ctr[0] = ctr[0]; piece->ctr[1] = ctr[1];
+     ak_bckey_ctr_acpkm_shift( piece->ctr, bkey->bsize, ( ak_uint64 )( first*seclen ));
+     piece->in = ( ak_uint64 *)(( ak_uint8 *)in + ( size_t ) first*section_size );
+     piece->out = ( ak_uint64 *)(( ak_uint8 *)out + ( size_t ) first*section_size );
+     piece->sections = len;
+     piece->seclen = seclen;
+     first += len;
+
+     if( count + 1 < threads ) { /* переходим к ключу первой секции следующего потока */
+       for( i = 0; i < ( size_t ) len; i++ )
+          if(( error = ak_bckey_next_acpkm_key( &nkey )) != ak_error_ok ) {
+            ak_error_message( error, __func__, "incorrect key generation" );
+            count++;
+            goto labex;
+          }
+     } else piece->tail = ( ssize_t )( size - ( size_t ) sections*section_size );
+  }
+
+ /* запускаем потоки; первая последовательность секций, а также последовательности,
+                                для которых не удалось создать поток, обрабатываются здесь */
+  for( i = 1; i < count; i++ )
+     pieces[i].started = ( pthread_create( &pieces[i].thread, NULL,
+                                             ak_bckey_ctr_acpkm_thread, pieces + i ) == 0 );
+  ak_bckey_ctr_acpkm_thread( pieces );
+  for( i = 1; i < count; i++ ) {
+     if( pieces[i].started ) pthread_join( pieces[i].thread, NULL );
+       else ak_bckey_ctr_acpkm_thread( pieces + i );
+  }
+  for( i = 0; i < count; i++ )
+     if( pieces[i].error != ak_error_ok ) {
+       ak_error_message( error = pieces[i].error, __func__, "incorrect encryption in thread" );
+       break;
+     }
+
+  labex:
+   if( pieces != NULL ) {
+     for( i = 0; i < count; i++ ) ak_bckey_destroy( &pieces[i].key );
+     free( pieces );
+   }
+   ak_bckey_destroy( &nkey );
+ return error;
+#else
+  (void) threads;
+ return ak_bckey_ctr_acpkm( bkey, in, out, size, section_size, iv, iv_size );
+#endif
+}
+
 /* ----------------------------------------------------------------------------------------------- */
  bool_t ak_libakrypt_test_acpkm( void )
 {
@@ -6,6 +6,10 @@
 #include <libakrypt-internal.h>
 #include <libakrypt.h>
 
+#ifdef AK_HAVE_BUILTIN_AESENC
+ #include <wmmintrin.h>
+#endif
+
 
 /* ----------------------------------------------------------------------------------------------- */
 /*! \brief Таблица нелинейной замены, использующейся для зашифрования и алгоритма развертки ключа
@@ -64,9 +68,15 @@ static const ak_uint8 RCON[4][10] = {{0x01, 0x02, 0x04, 0x08, 0x10, 0x20, 0x40,
 /* ---------------------------------------------------------------------------------------------- */
 /*! \brief Развернутые раундовые ключи алгоритма AES-128
     \details Массив содержит записанные последовательно ключи - входной ключ и 10 раундовых ключей.
-    Каждый ключ содержит 16 слов (распроложенные последовательно элементы матрицы 4х4). */
+    Каждый ключ содержит 16 слов (распроложенные последовательно элементы матрицы 4х4).
+    Вслед за ключами зашифрования, начиная со смещения \ref ak_aes128_inv_keys_offset, записаны
+    ключи эквивалентного обратного преобразования (FIPS 197, раздел 5.3.5): ключи расшифрования
+    следуют в обратном порядке, а к ключам раундов с 1 по 9 применено преобразование InvMixColumns. */
 /* ---------------------------------------------------------------------------------------------- */
-typedef ak_uint8 ak_aes128_expanded_keys[176];
+typedef ak_uint8 ak_aes128_expanded_keys[352];
+
+/*! \brief Смещение ключей расшифрования в массиве развернутых ключей. */
+#define ak_aes128_inv_keys_offset (176)
 
 
 /* ----------------------------------------------------------------------------------------------- */
@@ -140,168 +150,92 @@ static ak_uint8 mul_by_0e(ak_uint8 num)
 
 
 /* ----------------------------------------------------------------------------------------------- */
-/*! \brief Функция, осуществляющая операцию наложения раундового ключа
-    по модулю два (AddRoundKey) алгоритма AES-128.                                                 */
-/* ----------------------------------------------------------------------------------------------- */
-static void ak_aes128_add_round_key(ak_uint8 * state, ak_uint8 * key_schedule, int round)
+/*! \brief Функция, осуществляющая операцию "смешивания" столбцов матрицы сообщения (InvMixColumns)
+    (путем домножения на фиксированный многочлен) для алгоритма расшифрования AES-128.
+    Для преобразований используются вспомогательные функции, упрощающие умножение в конечном поле. */
+static void ak_aes128_inv_mix_columns(ak_uint8 * state)
 {
-    int col;
-    for (col = 0; col < 4; col++)
+    int i;
+    ak_uint8 s0, s1, s2, s3;
+    for (i = 0; i < 4; i++)
     {
-        state[0 + col * 4] = state[0 + col * 4] ^ key_schedule[0 + (4 * round + col) * 4];
-        state[1 + col * 4] = state[1 + col * 4] ^ key_schedule[1 + (4 * round + col) * 4];
-        state[2 + col * 4] = state[2 + col * 4] ^ key_schedule[2 + (4 * round + col) * 4];
-        state[3 + col * 4] = state[3 + col * 4] ^ key_schedule[3 + (4 * round + col) * 4];
+        s0 = mul_by_0e(state[0 + i * 4]) ^ mul_by_0b(state[1 + i * 4]) ^ mul_by_0d(state[2 + i * 4]) ^ mul_by_09(state[3 + i * 4]);
+        s1 = mul_by_09(state[0 + i * 4]) ^ mul_by_0e(state[1 + i * 4]) ^ mul_by_0b(state[2 + i * 4]) ^ mul_by_0d(state[3 + i * 4]);
+        s2 = mul_by_0d(state[0 + i * 4]) ^ mul_by_09(state[1 + i * 4]) ^ mul_by_0e(state[2 + i * 4]) ^ mul_by_0b(state[3 + i * 4]);
+        s3 = mul_by_0b(state[0 + i * 4]) ^ mul_by_0d(state[1 + i * 4]) ^ mul_by_09(state[2 + i * 4]) ^ mul_by_0e(state[3 + i * 4]);
+
+        state[0 + i * 4] = s0;
+        state[1 + i * 4] = s1;
+        state[2 + i * 4] = s2;
+        state[3 + i * 4] = s3;
     }
 }
 
 
 /* ----------------------------------------------------------------------------------------------- */
-/*! \brief Функция, осуществляющая параллельное применение нелинейной перестановки
-    для алгоритма зашифрования (SubBytes) AES-128.                                                 */
+/*! \brief Развернутые таблицы (T-таблицы) алгоритма AES-128.
+    \details Элемент таблицы с индексом `r` содержит столбец матрицы MixColumns, умноженный
+    на результат нелинейной замены байта, стоящего в `r`-й строке. Таблицы позволяют реализовать
+    преобразования SubBytes, ShiftRows и MixColumns одного раунда с помощью 16 обращений к памяти. */
 /* ----------------------------------------------------------------------------------------------- */
-static void ak_aes128_sub_bytes(ak_uint8 * state)
-{
-    int i, j;
-    for (i = 0; i < 4; i++)
-    {
-        for (j = 0; j < 4; j ++)
-        {
-            state[i * 4 + j] = SBOX[16 * (state[i * 4 + j] / 0x10) + state[i * 4 + j] % 0x10];
-        }
-    }
-}
-
+static ak_uint32 aes128_tboxes[4][256];
 
 /* ----------------------------------------------------------------------------------------------- */
-/*! \brief Функция, осуществляющая параллельное применение нелинейной перестановки
-    для алгоритма расшифрования (InvSubBytes) AES-128.                                             */
+/*! \brief Развернутые таблицы эквивалентного обратного преобразования алгоритма AES-128.
+    \details Элемент таблицы с индексом `r` содержит столбец матрицы InvMixColumns, умноженный
+    на результат обратной нелинейной замены байта, стоящего в `r`-й строке.                         */
 /* ----------------------------------------------------------------------------------------------- */
-static void ak_aes128_inv_sub_bytes(ak_uint8 * state)
-{
-    int i, j;
-    for (i = 0; i < 4; i++)
-    {
-        for (j = 0; j < 4; j ++)
-        {
-            state[i * 4 + j] = INV_SBOX[16 * (state[i * 4 + j] / 0x10) + state[i * 4 + j] % 0x10];
-        }
-    }
-}
+static ak_uint32 aes128_inv_tboxes[4][256];
 
 
 /* ----------------------------------------------------------------------------------------------- */
-/*! \brief Функция, осуществляющая перестановку байт сообщения (ShiftRows)
-    для алгоритма зашифрования AES-128.                                                            */
+/*! \brief Чтение 32-х битного слова (столбца матрицы состояния) из последовательности байт.       */
 /* ----------------------------------------------------------------------------------------------- */
-static void ak_aes128_shift_rows(ak_uint8 * state)
-{
-    ak_uint8 tmp_arr[4];
-    int i, c, count;
+#define ak_aes128_load_word(p) ((ak_uint32)(p)[0] ^ ((ak_uint32)(p)[1] << 8) ^ \
+                                      ((ak_uint32)(p)[2] << 16) ^ ((ak_uint32)(p)[3] << 24))
 
-    for (count = 1; count < 4; count++)
-    {
-        for (c = 1; c <= count; c++)
-        {
-            for (i = 0; i < 4; i++)
-            {
-                if (i - 1 >= 0)
-                {
-                    tmp_arr[i - 1] = state[i * 4 + count];
-                }
-                else
-                {
-                    tmp_arr[3] = state[i * 4 + count];
-                }
-            }
-
-            for (i = 0; i < 4; i++)
-            {
-                 state[i * 4 + count] = tmp_arr[i];
-            }
-        }
-    }
-}
+/* ----------------------------------------------------------------------------------------------- */
+/*! \brief Запись 32-х битного слова (столбца матрицы состояния) в последовательность байт.        */
+/* ----------------------------------------------------------------------------------------------- */
+#define ak_aes128_store_word(p, w) \
+    do { (p)[0] = (ak_uint8)(w); (p)[1] = (ak_uint8)((w) >> 8); \
+         (p)[2] = (ak_uint8)((w) >> 16); (p)[3] = (ak_uint8)((w) >> 24); } while(0)
 
 
 /* ----------------------------------------------------------------------------------------------- */
-/*! \brief Функция, осуществляющая перестановку байт сообщения (InvShiftRows)
-    для алгоритма расшифрования AES-128.                                                           */
+/*! Функция вычисляет развернутые таблицы, используемые при зашифровании и расшифровании блоков
+    в случае, когда процессор не поддерживает набор команд AES-NI.
+
+    @return Функция возвращает \ref ak_error_ok.                                                   */
 /* ----------------------------------------------------------------------------------------------- */
-static void ak_aes128_inv_shift_rows(ak_uint8 * state)
+int ak_bckey_aes128_init_tables(void)
 {
-    ak_uint8 tmp_arr[4];
-    int i, c, count;
+    int i, r;
+    ak_uint32 word;
 
-    for (count = 1; count < 4; count++)
+    for (i = 0; i < 256; i++)
     {
-        for (c = 1; c <= count; c++)
+        word = (ak_uint32) mul_by_02(SBOX[i]) ^ ((ak_uint32) SBOX[i] << 8) ^
+                             ((ak_uint32) SBOX[i] << 16) ^ ((ak_uint32) mul_by_03(SBOX[i]) << 24);
+        for (r = 0; r < 4; r++)
         {
-            for (i = 0; i < 4; i++)
-            {
-                if (i + 1 < 4)
-                {
-                    tmp_arr[i + 1] = state[i * 4 + count];
-                }
-                else
-                {
-                    tmp_arr[0] = state[i * 4 + count];
-                }
-            }
-
-            for (i = 0; i < 4; i++)
-            {
-                state[i * 4 + count] = tmp_arr[i];
-            }
+            aes128_tboxes[r][i] = word;
+            word = (word << 8) ^ (word >> 24);
         }
     }
-}
-
 
-/* ----------------------------------------------------------------------------------------------- */
-/*! \brief Функция, осуществляющая операцию "смешивания" столбцов матрицы сообщения (MixColumns)
-    (путем домножения на фиксированный многочлен) для алгоритма зашифрования AES-128.
-    Для преобразований используются вспомогательные функции, упрощающие умножение в конечном поле. */
-/* ----------------------------------------------------------------------------------------------- */
-static void ak_aes128_mix_columns(ak_uint8 * state)
-{
-    int i;
-    ak_uint8 s0, s1, s2, s3;
-    for (i = 0; i < 4; i++)
+    for (i = 0; i < 256; i++)
     {
-        s0 = mul_by_02(state[0 + i * 4]) ^ mul_by_03(state[1 + i * 4]) ^ state[2 + i * 4] ^ state[3 + i * 4];
-        s1 = state[0 + i * 4] ^ mul_by_02(state[1 + i * 4]) ^ mul_by_03(state[2 + i * 4]) ^ state[3 + i * 4];
-        s2 = state[0 + i * 4] ^ state[1 + i * 4] ^ mul_by_02(state[2 + i * 4]) ^ mul_by_03(state[3 + i * 4]);
-        s3 = mul_by_03(state[0 + i * 4]) ^ state[1 + i * 4] ^ state[2 + i * 4] ^ mul_by_02(state[3 + i * 4]);
-
-        state[0 + i * 4] = s0;
-        state[1 + i * 4] = s1;
-        state[2 + i * 4] = s2;
-        state[3 + i * 4] = s3;
+        word = (ak_uint32) mul_by_0e(INV_SBOX[i]) ^ ((ak_uint32) mul_by_09(INV_SBOX[i]) << 8) ^
+              ((ak_uint32) mul_by_0d(INV_SBOX[i]) << 16) ^ ((ak_uint32) mul_by_0b(INV_SBOX[i]) << 24);
+        for (r = 0; r < 4; r++)
+        {
+            aes128_inv_tboxes[r][i] = word;
+            word = (word << 8) ^ (word >> 24);
+        }
     }
-}
-
-
-/* ----------------------------------------------------------------------------------------------- */
-/*! \brief Функция, осуществляющая операцию "смешивания" столбцов матрицы сообщения (InvMixColumns)
-    (путем домножения на фиксированный многочлен) для алгоритма расшифрования AES-128.
-    Для преобразований используются вспомогательные функции, упрощающие умножение в конечном поле. */
-static void ak_aes128_inv_mix_columns(ak_uint8 * state)
-{
-    int i;
-    ak_uint8 s0, s1, s2, s3;
-    for (i = 0; i < 4; i++)
-    {
-        s0 = mul_by_0e(state[0 + i * 4]) ^ mul_by_0b(state[1 + i * 4]) ^ mul_by_0d(state[2 + i * 4]) ^ mul_by_09(state[3 + i * 4]);
-        s1 = mul_by_09(state[0 + i * 4]) ^ mul_by_0e(state[1 + i * 4]) ^ mul_by_0b(state[2 + i * 4]) ^ mul_by_0d(state[3 + i * 4]);
-        s2 = mul_by_0d(state[0 + i * 4]) ^ mul_by_09(state[1 + i * 4]) ^ mul_by_0e(state[2 + i * 4]) ^ mul_by_0b(state[3 + i * 4]);
-        s3 = mul_by_0b(state[0 + i * 4]) ^ mul_by_0d(state[1 + i * 4]) ^ mul_by_09(state[2 + i * 4]) ^ mul_by_0e(state[3 + i * 4]);
 
-        state[0 + i * 4] = s0;
-        state[1 + i * 4] = s1;
-        state[2 + i * 4] = s2;
-        state[3 + i * 4] = s3;
-    }
+    return ak_error_ok;
 }
 
 
@@ -399,92 +333,359 @@ static int ak_aes128_schedule_keys(ak_skey skey)
         }
     }
 
+    /* вычисляем ключи эквивалентного обратного преобразования */
+    ak_uint8 * inv_key_schedule = key_schedule + ak_aes128_inv_keys_offset;
+    for (i = 0; i < 11; i++)
+    {
+        memcpy(inv_key_schedule + 16 * i, key_schedule + 16 * (10 - i), 16);
+        if ((i > 0) && (i < 10))
+        {
+            ak_aes128_inv_mix_columns(inv_key_schedule + 16 * i);
+        }
+    }
+
     return ak_error_ok;
 }
 
 
 /* ----------------------------------------------------------------------------------------------- */
 /*! \brief Функция релизует алгоритм зашифрования одного блока информации
-   шифром AES-128 (FIPS 197).                                                                      */
+   шифром AES-128 (FIPS 197).
+   \details Раундовые преобразования реализуются с помощью развернутых таблиц \ref aes128_tboxes,
+   последний раунд, не содержащий преобразования MixColumns, использует таблицу замен.           */
 /* ----------------------------------------------------------------------------------------------- */
 static void ak_aes128_encrypt(ak_skey skey, ak_pointer in, ak_pointer out)
 {
     ak_uint8 * input = (ak_uint8 *) in;
     ak_uint8 * output = (ak_uint8 *) out;
-
     ak_uint8 * key_schedule = (ak_uint8 * ) skey->data;
-    ak_uint8 state[4][4];
 
-    int i, j, round = 0;
-    for (i = 0; i < 4; i++)
+    int round;
+    ak_uint32 s0, s1, s2, s3, t0, t1, t2, t3;
+
+    s0 = ak_aes128_load_word(input) ^ ak_aes128_load_word(key_schedule);
+    s1 = ak_aes128_load_word(input + 4) ^ ak_aes128_load_word(key_schedule + 4);
+    s2 = ak_aes128_load_word(input + 8) ^ ak_aes128_load_word(key_schedule + 8);
+    s3 = ak_aes128_load_word(input + 12) ^ ak_aes128_load_word(key_schedule + 12);
+
+    for (round = 1; round < 10; round++)
     {
-        for (j = 0; j < 4; j++)
-        {
-            state[i][j] = input[j + 4 * i];
-        }
+        key_schedule += 16;
+        t0 = aes128_tboxes[0][s0 & 0xff] ^ aes128_tboxes[1][(s1 >> 8) & 0xff] ^
+             aes128_tboxes[2][(s2 >> 16) & 0xff] ^ aes128_tboxes[3][s3 >> 24] ^
+             ak_aes128_load_word(key_schedule);
+        t1 = aes128_tboxes[0][s1 & 0xff] ^ aes128_tboxes[1][(s2 >> 8) & 0xff] ^
+             aes128_tboxes[2][(s3 >> 16) & 0xff] ^ aes128_tboxes[3][s0 >> 24] ^
+             ak_aes128_load_word(key_schedule + 4);
+        t2 = aes128_tboxes[0][s2 & 0xff] ^ aes128_tboxes[1][(s3 >> 8) & 0xff] ^
+             aes128_tboxes[2][(s0 >> 16) & 0xff] ^ aes128_tboxes[3][s1 >> 24] ^
+             ak_aes128_load_word(key_schedule + 8);
+        t3 = aes128_tboxes[0][s3 & 0xff] ^ aes128_tboxes[1][(s0 >> 8) & 0xff] ^
+             aes128_tboxes[2][(s1 >> 16) & 0xff] ^ aes128_tboxes[3][s2 >> 24] ^
+             ak_aes128_load_word(key_schedule + 12);
+        s0 = t0; s1 = t1; s2 = t2; s3 = t3;
     }
 
-    ak_aes128_add_round_key(*state, key_schedule, round);
+    key_schedule += 16;
+    t0 = (ak_uint32) SBOX[s0 & 0xff] ^ ((ak_uint32) SBOX[(s1 >> 8) & 0xff] << 8) ^
+         ((ak_uint32) SBOX[(s2 >> 16) & 0xff] << 16) ^ ((ak_uint32) SBOX[s3 >> 24] << 24) ^
+         ak_aes128_load_word(key_schedule);
+    t1 = (ak_uint32) SBOX[s1 & 0xff] ^ ((ak_uint32) SBOX[(s2 >> 8) & 0xff] << 8) ^
+         ((ak_uint32) SBOX[(s3 >> 16) & 0xff] << 16) ^ ((ak_uint32) SBOX[s0 >> 24] << 24) ^
+         ak_aes128_load_word(key_schedule + 4);
+    t2 = (ak_uint32) SBOX[s2 & 0xff] ^ ((ak_uint32) SBOX[(s3 >> 8) & 0xff] << 8) ^
+         ((ak_uint32) SBOX[(s0 >> 16) & 0xff] << 16) ^ ((ak_uint32) SBOX[s1 >> 24] << 24) ^
+         ak_aes128_load_word(key_schedule + 8);
+    t3 = (ak_uint32) SBOX[s3 & 0xff] ^ ((ak_uint32) SBOX[(s0 >> 8) & 0xff] << 8) ^
+         ((ak_uint32) SBOX[(s1 >> 16) & 0xff] << 16) ^ ((ak_uint32) SBOX[s2 >> 24] << 24) ^
+         ak_aes128_load_word(key_schedule + 12);
+
+    ak_aes128_store_word(output, t0);
+    ak_aes128_store_word(output + 4, t1);
+    ak_aes128_store_word(output + 8, t2);
+    ak_aes128_store_word(output + 12, t3);
+}
+
+
+/* ----------------------------------------------------------------------------------------------- */
+/*! \brief Функция релизует алгоритм расшифрования одного блока информации
+   шифром AES-128 (FIPS 197).
+   \details Используется эквивалентное обратное преобразование, в котором раундовые
+   преобразования реализуются с помощью развернутых таблиц \ref aes128_inv_tboxes
+   и заранее вычисленных ключей расшифрования.                                                     */
+/* ----------------------------------------------------------------------------------------------- */
+static void ak_aes128_decrypt(ak_skey skey, ak_pointer in, ak_pointer out)
+{
+    ak_uint8 * input = (ak_uint8 *) in;
+    ak_uint8 * output = (ak_uint8 *) out;
+    ak_uint8 * key_schedule = (ak_uint8 * ) skey->data + ak_aes128_inv_keys_offset;
+
+    int round;
+    ak_uint32 s0, s1, s2, s3, t0, t1, t2, t3;
+
+    s0 = ak_aes128_load_word(input) ^ ak_aes128_load_word(key_schedule);
+    s1 = ak_aes128_load_word(input + 4) ^ ak_aes128_load_word(key_schedule + 4);
+    s2 = ak_aes128_load_word(input + 8) ^ ak_aes128_load_word(key_schedule + 8);
+    s3 = ak_aes128_load_word(input + 12) ^ ak_aes128_load_word(key_schedule + 12);
 
     for (round = 1; round < 10; round++)
     {
-        ak_aes128_sub_bytes(*state);
-        ak_aes128_shift_rows(*state);
-        ak_aes128_mix_columns(*state);
-        ak_aes128_add_round_key(*state, key_schedule, round);
+        key_schedule += 16;
+        t0 = aes128_inv_tboxes[0][s0 & 0xff] ^ aes128_inv_tboxes[1][(s3 >> 8) & 0xff] ^
+             aes128_inv_tboxes[2][(s2 >> 16) & 0xff] ^ aes128_inv_tboxes[3][s1 >> 24] ^
+             ak_aes128_load_word(key_schedule);
+        t1 = aes128_inv_tboxes[0][s1 & 0xff] ^ aes128_inv_tboxes[1][(s0 >> 8) & 0xff] ^
+             aes128_inv_tboxes[2][(s3 >> 16) & 0xff] ^ aes128_inv_tboxes[3][s2 >> 24] ^
+             ak_aes128_load_word(key_schedule + 4);
+        t2 = aes128_inv_tboxes[0][s2 & 0xff] ^ aes128_inv_tboxes[1][(s1 >> 8) & 0xff] ^
+             aes128_inv_tboxes[2][(s0 >> 16) & 0xff] ^ aes128_inv_tboxes[3][s3 >> 24] ^
+             ak_aes128_load_word(key_schedule + 8);
+        t3 = aes128_inv_tboxes[0][s3 & 0xff] ^ aes128_inv_tboxes[1][(s2 >> 8) & 0xff] ^
+             aes128_inv_tboxes[2][(s1 >> 16) & 0xff] ^ aes128_inv_tboxes[3][s0 >> 24] ^
+             ak_aes128_load_word(key_schedule + 12);
+        s0 = t0; s1 = t1; s2 = t2; s3 = t3;
     }
 
-    ak_aes128_sub_bytes(*state);
-    ak_aes128_shift_rows(*state);
-    ak_aes128_add_round_key(*state, key_schedule, round);
+    key_schedule += 16;
+    t0 = (ak_uint32) INV_SBOX[s0 & 0xff] ^ ((ak_uint32) INV_SBOX[(s3 >> 8) & 0xff] << 8) ^
+         ((ak_uint32) INV_SBOX[(s2 >> 16) & 0xff] << 16) ^ ((ak_uint32) INV_SBOX[s1 >> 24] << 24) ^
+         ak_aes128_load_word(key_schedule);
+    t1 = (ak_uint32) INV_SBOX[s1 & 0xff] ^ ((ak_uint32) INV_SBOX[(s0 >> 8) & 0xff] << 8) ^
+         ((ak_uint32) INV_SBOX[(s3 >> 16) & 0xff] << 16) ^ ((ak_uint32) INV_SBOX[s2 >> 24] << 24) ^
+         ak_aes128_load_word(key_schedule + 4);
+    t2 = (ak_uint32) INV_SBOX[s2 & 0xff] ^ ((ak_uint32) INV_SBOX[(s1 >> 8) & 0xff] << 8) ^
+         ((ak_uint32) INV_SBOX[(s0 >> 16) & 0xff] << 16) ^ ((ak_uint32) INV_SBOX[s3 >> 24] << 24) ^
+         ak_aes128_load_word(key_schedule + 8);
+    t3 = (ak_uint32) INV_SBOX[s3 & 0xff] ^ ((ak_uint32) INV_SBOX[(s2 >> 8) & 0xff] << 8) ^
+         ((ak_uint32) INV_SBOX[(s1 >> 16) & 0xff] << 16) ^ ((ak_uint32) INV_SBOX[s0 >> 24] << 24) ^
+         ak_aes128_load_word(key_schedule + 12);
+
+    ak_aes128_store_word(output, t0);
+    ak_aes128_store_word(output + 4, t1);
+    ak_aes128_store_word(output + 8, t2);
+    ak_aes128_store_word(output + 12, t3);
+}
+
 
-    for (i = 0; i < 16; i++)
+/* ----------------------------------------------------------------------------------------------- */
+/*! \brief Функция релизует алгоритм зашифрования последовательности блоков информации
+   шифром AES-128 (FIPS 197).                                                                      */
+/* ----------------------------------------------------------------------------------------------- */
+static void ak_aes128_encrypt_blocks(ak_skey skey, ak_pointer in, ak_pointer out, size_t blocks)
+{
+    ak_uint8 * input = (ak_uint8 *) in;
+    ak_uint8 * output = (ak_uint8 *) out;
+
+    while (blocks-- > 0)
     {
-        output[i] = state[i / 4][i % 4];
+        ak_aes128_encrypt(skey, input, output);
+        input += 16;
+        output += 16;
     }
 }
 
 
 /* ----------------------------------------------------------------------------------------------- */
-/*! \brief Функция релизует алгоритм расшифрования одного блока информации
+/*! \brief Функция релизует алгоритм расшифрования последовательности блоков информации
    шифром AES-128 (FIPS 197).                                                                      */
 /* ----------------------------------------------------------------------------------------------- */
-static void ak_aes128_decrypt(ak_skey skey, ak_pointer in, ak_pointer out)
+static void ak_aes128_decrypt_blocks(ak_skey skey, ak_pointer in, ak_pointer out, size_t blocks)
 {
     ak_uint8 * input = (ak_uint8 *) in;
     ak_uint8 * output = (ak_uint8 *) out;
 
-    ak_uint8 * key_schedule = (ak_uint8 * ) skey->data;
-    ak_uint8 state[4][4];
+    while (blocks-- > 0)
+    {
+        ak_aes128_decrypt(skey, input, output);
+        input += 16;
+        output += 16;
+    }
+}
 
-    int i, j, round = 10;
-    for (i = 0; i < 4; i++)
+
+#ifdef AK_HAVE_BUILTIN_AESENC
+/* ----------------------------------------------------------------------------------------------- */
+/*! \brief Количество блоков, одновременно обрабатываемых командами AES-NI.
+    \details Команды aesenc/aesdec имеют задержку в несколько тактов, поэтому независимые блоки
+    обрабатываются одновременно, что позволяет загрузить конвейер процессора.                      */
+/* ----------------------------------------------------------------------------------------------- */
+#define ak_aes128_aesni_blocks (8)
+
+
+/* ----------------------------------------------------------------------------------------------- */
+/*! \brief Функция проверяет, поддерживает ли процессор набор команд AES-NI.                       */
+/* ----------------------------------------------------------------------------------------------- */
+static bool_t ak_aes128_cpu_supports_aesni(void)
+{
+#ifdef AK_HAVE_BUILTIN_CPU_SUPPORTS
+    __builtin_cpu_init();
+    return __builtin_cpu_supports("aes") ? ak_true : ak_false;
+#else
+    return ak_true; /* команды доступны на этапе компиляции */
+#endif
+}
+
+
+/* ----------------------------------------------------------------------------------------------- */
+/*! \brief Функция загружает раундовые ключи зашифрования в регистры.                              */
+/* ----------------------------------------------------------------------------------------------- */
+static inline void ak_aes128_load_keys_aesni(ak_skey skey, __m128i * keys)
+{
+    int round;
+    const __m128i * key_schedule = (const __m128i *) skey->data;
+
+    for (round = 0; round < 11; round++)
     {
-        for (j = 0; j < 4; j++)
+        keys[round] = _mm_loadu_si128(key_schedule + round);
+    }
+}
+
+
+/* ----------------------------------------------------------------------------------------------- */
+/*! \brief Функция загружает в регистры раундовые ключи эквивалентного обратного преобразования,
+    используемые командами aesdec.                                                                 */
+/* ----------------------------------------------------------------------------------------------- */
+static inline void ak_aes128_load_inv_keys_aesni(ak_skey skey, __m128i * keys)
+{
+    int round;
+    const __m128i * key_schedule =
+                      (const __m128i *)((ak_uint8 *) skey->data + ak_aes128_inv_keys_offset);
+
+    for (round = 0; round < 11; round++)
+    {
+        keys[round] = _mm_loadu_si128(key_schedule + round);
+    }
+}
+
+
+/* ----------------------------------------------------------------------------------------------- */
+/*! \brief Функция зашифрования одного блока с использованием команд AES-NI.                      */
+/* ----------------------------------------------------------------------------------------------- */
+static void ak_aes128_encrypt_aesni(ak_skey skey, ak_pointer in, ak_pointer out)
+{
+    int round;
+    const __m128i * key_schedule = (const __m128i *) skey->data;
+    __m128i x = _mm_xor_si128(_mm_loadu_si128((const __m128i *) in),
+                                                                  _mm_loadu_si128(key_schedule));
+
+    for (round = 1; round < 10; round++)
+    {
+        x = _mm_aesenc_si128(x, _mm_loadu_si128(key_schedule + round));
+    }
+    _mm_storeu_si128((__m128i *) out, _mm_aesenclast_si128(x, _mm_loadu_si128(key_schedule + 10)));
+}
+
+
+/* ----------------------------------------------------------------------------------------------- */
+/*! \brief Функция расшифрования одного блока с использованием команд AES-NI.                     */
+/* ----------------------------------------------------------------------------------------------- */
+static void ak_aes128_decrypt_aesni(ak_skey skey, ak_pointer in, ak_pointer out)
+{
+    int round;
+    const __m128i * key_schedule =
+                      (const __m128i *)((ak_uint8 *) skey->data + ak_aes128_inv_keys_offset);
+    __m128i x = _mm_xor_si128(_mm_loadu_si128((const __m128i *) in),
+                                                                  _mm_loadu_si128(key_schedule));
+
+    for (round = 1; round < 10; round++)
+    {
+        x = _mm_aesdec_si128(x, _mm_loadu_si128(key_schedule + round));
+    }
+    _mm_storeu_si128((__m128i *) out, _mm_aesdeclast_si128(x, _mm_loadu_si128(key_schedule + 10)));
+}
+
+
+/* ----------------------------------------------------------------------------------------------- */
+/*! \brief Функция зашифрования последовательности блоков с использованием команд AES-NI.
+    \details Блоки обрабатываются группами по \ref ak_aes128_aesni_blocks штук, оставшиеся
+    блоки зашифровываются по одному.                                                               */
+/* ----------------------------------------------------------------------------------------------- */
+static void ak_aes128_encrypt_blocks_aesni(ak_skey skey, ak_pointer in, ak_pointer out, size_t blocks)
+{
+    int i, round;
+    __m128i keys[11], x[ak_aes128_aesni_blocks];
+    const __m128i * input = (const __m128i *) in;
+    __m128i * output = (__m128i *) out;
+
+    ak_aes128_load_keys_aesni(skey, keys);
+    while (blocks >= ak_aes128_aesni_blocks)
+    {
+        for (i = 0; i < ak_aes128_aesni_blocks; i++)
+        {
+            x[i] = _mm_xor_si128(_mm_loadu_si128(input + i), keys[0]);
+        }
+        for (round = 1; round < 10; round++)
+        {
+            for (i = 0; i < ak_aes128_aesni_blocks; i++)
+            {
+                x[i] = _mm_aesenc_si128(x[i], keys[round]);
+            }
+        }
+        for (i = 0; i < ak_aes128_aesni_blocks; i++)
         {
-            state[i][j] = input[j + 4 * i];
+            _mm_storeu_si128(output + i, _mm_aesenclast_si128(x[i], keys[10]));
         }
+        input += ak_aes128_aesni_blocks;
+        output += ak_aes128_aesni_blocks;
+        blocks -= ak_aes128_aesni_blocks;
     }
 
-    ak_aes128_add_round_key(*state, key_schedule, 10);
-
-    for (round = 9; round > 0; round--)
+    while (blocks-- > 0)
     {
-        ak_aes128_inv_shift_rows(*state);
-        ak_aes128_inv_sub_bytes(*state);
-        ak_aes128_add_round_key(*state, key_schedule, round);
-        ak_aes128_inv_mix_columns(*state);
+        x[0] = _mm_xor_si128(_mm_loadu_si128(input++), keys[0]);
+        for (round = 1; round < 10; round++)
+        {
+            x[0] = _mm_aesenc_si128(x[0], keys[round]);
+        }
+        _mm_storeu_si128(output++, _mm_aesenclast_si128(x[0], keys[10]));
     }
+}
 
-    ak_aes128_inv_shift_rows(*state);
-    ak_aes128_inv_sub_bytes(*state);
-    ak_aes128_add_round_key(*state, key_schedule, round);
 
-    for (i = 0; i < 16; i++)
+/* ----------------------------------------------------------------------------------------------- */
+/*! \brief Функция расшифрования последовательности блоков с использованием команд AES-NI.        */
+/* ----------------------------------------------------------------------------------------------- */
+static void ak_aes128_decrypt_blocks_aesni(ak_skey skey, ak_pointer in, ak_pointer out, size_t blocks)
+{
+    int i, round;
+    __m128i keys[11], x[ak_aes128_aesni_blocks];
+    const __m128i * input = (const __m128i *) in;
+    __m128i * output = (__m128i *) out;
+
+    ak_aes128_load_inv_keys_aesni(skey, keys);
+    while (blocks >= ak_aes128_aesni_blocks)
     {
-        output[i] = state[i / 4][i % 4];
+        for (i = 0; i < ak_aes128_aesni_blocks; i++)
+        {
+            x[i] = _mm_xor_si128(_mm_loadu_si128(input + i), keys[0]);
+        }
+        for (round = 1; round < 10; round++)
+        {
+            for (i = 0; i < ak_aes128_aesni_blocks; i++)
+            {
+                x[i] = _mm_aesdec_si128(x[i], keys[round]);
+            }
+        }
+        for (i = 0; i < ak_aes128_aesni_blocks; i++)
+        {
+            _mm_storeu_si128(output + i, _mm_aesdeclast_si128(x[i], keys[10]));
+        }
+        input += ak_aes128_aesni_blocks;
+        output += ak_aes128_aesni_blocks;
+        blocks -= ak_aes128_aesni_blocks;
+    }
+
+    while (blocks-- > 0)
+    {
+        x[0] = _mm_xor_si128(_mm_loadu_si128(input++), keys[0]);
+        for (round = 1; round < 10; round++)
+        {
+            x[0] = _mm_aesdec_si128(x[0], keys[round]);
+        }
+        _mm_storeu_si128(output++, _mm_aesdeclast_si128(x[0], keys[10]));
     }
 }
+#endif
 
 
 /* ----------------------------------------------------------------------------------------------- */
@@ -521,7 +722,7 @@ static int ak_skey_set_special_aes128_unmask(ak_skey skey)
 /* ----------------------------------------------------------------------------------------------- */
 int ak_bckey_create_aes128(ak_bckey bkey)
 {
-    int error = ak_error_ok, oc = (int) ak_libakrypt_get_option_by_name( "openssl_compability");
+    int error = ak_error_ok;
 
     if(bkey == NULL ) return ak_error_message(ak_error_null_pointer, __func__,
                                                "using null pointer to block cipher key context");
@@ -533,6 +734,18 @@ int ak_bckey_create_aes128(ak_bckey bkey)
     bkey->delete_keys = ak_aes128_delete_keys;
     bkey->encrypt = ak_aes128_encrypt;
     bkey->decrypt = ak_aes128_decrypt;
+    bkey->encrypt_blocks = ak_aes128_encrypt_blocks;
+    bkey->decrypt_blocks = ak_aes128_decrypt_blocks;
+#ifdef AK_HAVE_BUILTIN_AESENC
+    /* при наличии команд AES-NI используем их вместо развернутых таблиц */
+    if (ak_aes128_cpu_supports_aesni())
+    {
+        bkey->encrypt = ak_aes128_encrypt_aesni;
+        bkey->decrypt = ak_aes128_decrypt_aesni;
+        bkey->encrypt_blocks = ak_aes128_encrypt_blocks_aesni;
+        bkey->decrypt_blocks = ak_aes128_decrypt_blocks_aesni;
+    }
+#endif
 
     // установим свои специальные функции маскирования и демаскирования
     bkey->key.set_mask = ak_skey_set_special_aes128_mask;
@@ -624,6 +837,49 @@ bool_t ak_libakrypt_test_aes128(void)
     }
     printf("\n");
 
+    if ((memcmp(out_enc, for_dec, 16) != 0) || (memcmp(out_dec, for_enc, 16) != 0))
+    {
+        printf("Неверный результат зашифрования/расшифрования\n");
+        ak_bckey_destroy(&key);
+        return ak_false;
+    }
+
+    /* сравниваем многоблочные преобразования с преобразованием одного блока с помощью таблиц */
+    ak_uint8 blocks[19 * 16], out_blocks[19 * 16];
+    for (int i = 0; i < (int) sizeof(blocks); i++)
+    {
+        blocks[i] = (ak_uint8)(13 * i + 7);
+    }
+    ak_bckey_encrypt_blocks(&key, blocks, out_blocks, 19);
+    for (int i = 0; i < 19; i++)
+    {
+        ak_aes128_encrypt(&key.key, blocks + 16 * i, out_enc);
+        if (memcmp(out_enc, out_blocks + 16 * i, 16) != 0)
+        {
+            printf("Неверный результат многоблочного зашифрования\n");
+            ak_bckey_destroy(&key);
+            return ak_false;
+        }
+    }
+    for (int i = 0; i < 19; i++)
+    {
+        ak_aes128_decrypt(&key.key, out_blocks + 16 * i, out_enc);
+        if (memcmp(out_enc, blocks + 16 * i, 16) != 0)
+        {
+            printf("Неверный результат расшифрования с помощью таблиц\n");
+            ak_bckey_destroy(&key);
+            return ak_false;
+        }
+    }
+    ak_bckey_decrypt_blocks(&key, out_blocks, out_blocks, 19);
+    if (memcmp(blocks, out_blocks, sizeof(blocks)) != 0)
+    {
+        printf("Неверный результат многоблочного расшифрования\n");
+        ak_bckey_destroy(&key);
+        return ak_false;
+    }
+
+    ak_bckey_destroy(&key);
     return ak_true;
 }
 
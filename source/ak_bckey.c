@@ -4,7 +4,46 @@
 /*  Файл ak_bckey.c                                                                                */
 /*  - содержит реализацию общих функций для алгоритмов блочного шифрования.                        */
 /* ----------------------------------------------------------------------------------------------- */
- #include <libakrypt.h>
+#ifdef AK_HAVE_BUILTIN_XOR_SI128
+ #include <emmintrin.h>
+#endif
+#ifdef AK_HAVE_PTHREAD_H
+ #include <pthread.h>
+#endif
+#ifdef AK_HAVE_UNISTD_H
+ #include <unistd.h>
+#endif
+
+/* ----------------------------------------------------------------------------------------------- */
+ #include <libakrypt-internal.h>
+
+/* ----------------------------------------------------------------------------------------------- */
+/*! \brief Количество блоков (с учетом неполного последнего блока), занимаемых данными длины size. */
+ #define ak_bckey_size_in_blocks( bkey, size ) ((( size ) + ( bkey )->bsize - 1 )/( bkey )->bsize )
+
+/* ----------------------------------------------------------------------------------------------- */
+/*! Функция копирует в контекст ключа значения опций библиотеки, зависящие от длины блока
+    алгоритма шифрования.
+
+    @param bkey контекст ключа алгоритма блочного шифрованния                                      */
+/* ----------------------------------------------------------------------------------------------- */
+ static void ak_bckey_load_options( ak_bckey bkey )
+{
+  ak_skey_load_options( &bkey->key );
+  switch( bkey->bsize ) {
+    case  8: bkey->key.options.acpkm_section_block_count =
+                    ak_libakrypt_get_option_by_index( ak_option_acpkm_section_magma_block_count );
+             bkey->key.options.cipher_resource =
+                              ak_libakrypt_get_option_by_index( ak_option_magma_cipher_resource );
+             break;
+    case 16: bkey->key.options.acpkm_section_block_count =
+                ak_libakrypt_get_option_by_index( ak_option_acpkm_section_kuznechik_block_count );
+             bkey->key.options.cipher_resource =
+                          ak_libakrypt_get_option_by_index( ak_option_kuznechik_cipher_resource );
+             break;
+    default: break;
+  }
+}
 
 /* ----------------------------------------------------------------------------------------------- */
 /*! Функция устанавливает параметры алгоритма блочного шифрования, передаваемые в качестве
@@ -52,9 +91,40 @@
   bkey->ivector_size =  0;
   bkey->encrypt =       NULL;
   bkey->decrypt =       NULL;
+  bkey->encrypt_blocks = NULL;
+  bkey->decrypt_blocks = NULL;
+  bkey->mgm_blocks =    NULL;
   bkey->schedule_keys = NULL;
   bkey->delete_keys =   NULL;
 
+ /* значения опций, зависящие от длины блока */
+  ak_bckey_load_options( bkey );
+
+ return ak_error_ok;
+}
+
+/* ----------------------------------------------------------------------------------------------- */
+/*! Функция повторно считывает значения опций библиотеки, сохраненные в контексте ключа
+    при его создании, например, после изменения опций функцией ak_libakrypt_set_option().
+
+    \note Режим совместимости с библиотекой openssl определяет формат хранения ключа
+    и используемые функции зашифрования, поэтому не может быть изменен для созданного ключа.
+    Если текущее значение опции `openssl_compability` отличается от значения, сохраненного
+    в контексте, то функция возвращает ошибку и не изменяет контекст.
+
+    @param bkey контекст ключа алгоритма блочного шифрованния
+    @return В случае успеха функция возввращает \ref ak_error_ok (ноль).
+    В противном случае, возвращается код ошибки.                                                   */
+/* ----------------------------------------------------------------------------------------------- */
+ int ak_bckey_refresh_options( ak_bckey bkey )
+{
+  if( bkey == NULL ) return ak_error_message( ak_error_null_pointer, __func__,
+                                                  "using a null pointer to block cipher context" );
+  if( bkey->key.options.openssl_compability != ak_libakrypt_get_openssl_compability( ))
+    return ak_error_message( ak_error_wrong_option, __func__,
+                                "openssl compability can't be changed for existing cipher key" );
+  ak_bckey_load_options( bkey );
+
  return ak_error_ok;
 }
 
@@ -86,6 +156,9 @@
   bkey->bsize =            0;
   bkey->encrypt =       NULL;
   bkey->decrypt =       NULL;
+  bkey->encrypt_blocks = NULL;
+  bkey->decrypt_blocks = NULL;
+  bkey->mgm_blocks =    NULL;
   bkey->schedule_keys = NULL;
   bkey->delete_keys =   NULL;
 
@@ -154,7 +227,7 @@
                                        "using a constant value for secret key with wrong length" );
 
  /* дополнительный переворот ключа для алгоритма Магма (в режиме совместимости с openssl) */
-  if(( ak_libakrypt_get_option_by_name( "openssl_compability" ) == 1 ) &&
+  if( bkey->key.options.openssl_compability && ( bkey->key.oid != NULL ) &&
                                          ( strncmp( bkey->key.oid->name[0], "magma", 5 ) == 0 )) {
     int i = 0;
     ak_uint8 revkey[32];
@@ -321,18 +394,37 @@
   if( oid->func.first.create == NULL )
     return ak_error_message( ak_error_undefined_function, __func__,
                           "using null pointer to create function in right block cipher context" );
+ /* копия создается с текущим значением опции openssl_compability; поскольку таблицы
+    и способ хранения ключа зависят от этой опции, ее значение должно совпадать
+    со значением, сохраненным в контексте исходного ключа */
+  if( rkey->key.options.openssl_compability != ak_libakrypt_get_openssl_compability( ))
+    return ak_error_message( ak_error_wrong_option, __func__,
+                                  "openssl compability can't be changed for existing cipher key" );
  /* создаем объект */
   if(( error = ((ak_function_bckey_create *)oid->func.first.create)( bkey )) != ak_error_ok )
     return ak_error_message( error, __func__, "incorrect creation of left block cipher context" );
+ /* производный ключ использует те же значения опций, что и исходный */
+  bkey->key.options.acpkm_section_block_count = rkey->key.options.acpkm_section_block_count;
+  bkey->key.options.cipher_resource = rkey->key.options.cipher_resource;
 
  /* присваиваем ключ */
   if(( error = rkey->key.unmask( &rkey->key )) != ak_error_ok ) {
     ak_error_message( error, __func__, "incorrect unmasking block cipher context" );
     goto  labex;
   }
-  if(( error = ak_bckey_set_key( bkey, rkey->key.key, rkey->key.key_size )) != ak_error_ok ) {
-    ak_error_message( error, __func__, "incorrect assigning a new key value" );
+  if( rkey->key.options.openssl_compability &&
+                                         ( strncmp( rkey->key.oid->name[0], "magma", 5 ) == 0 )) {
+   /* ключ алгоритма Магма в режиме совместимости с openssl хранится в перевернутом виде,
+      поэтому перед присвоением возвращаем его к исходному значению */
+    size_t i = 0;
+    ak_uint8 revkey[32];
+
+    for( i = 0; i < 32; i++ ) revkey[i] = rkey->key.key[31-i];
+    error = ak_bckey_set_key( bkey, revkey, sizeof( revkey ));
+    ak_ptr_wipe( revkey, sizeof( revkey ), &rkey->key.generator );
   }
+   else error = ak_bckey_set_key( bkey, rkey->key.key, rkey->key.key_size );
+  if( error != ak_error_ok ) ak_error_message( error, __func__, "incorrect assigning a new key value" );
   rkey->key.set_mask( &rkey->key );
 
  return error;
@@ -342,6 +434,78 @@
  return error;
 }
 
+/* ----------------------------------------------------------------------------------------------- */
+/*! Функция зашифровывает последовательность блоков, используя многоблочную функцию
+    алгоритма блочного шифрования; если такая функция не определена, то блоки зашифровываются
+    последовательно функцией `bkey->encrypt`. Проверка целостности и ресурса ключа
+    функцией не выполняется.
+
+    @param bkey Контекст ключа алгоритма блочного шифрования.
+    @param in Указатель на область памяти, где хранятся входные блоки.
+    @param out Указатель на область памяти, куда помещаются зашифрованные блоки.
+    @param blocks Количество блоков.                                                               */
+/* ----------------------------------------------------------------------------------------------- */
+ void ak_bckey_encrypt_blocks( ak_bckey bkey, ak_pointer in, ak_pointer out, size_t blocks )
+{
+  ak_uint8 *inptr = (ak_uint8 *)in, *outptr = (ak_uint8 *)out;
+
+  if( bkey->encrypt_blocks != NULL ) {
+    bkey->encrypt_blocks( &bkey->key, in, out, blocks );
+    return;
+  }
+  while( blocks-- > 0 ) {
+    bkey->encrypt( &bkey->key, inptr, outptr );
+    inptr += bkey->bsize; outptr += bkey->bsize;
+  }
+}
+
+/* ----------------------------------------------------------------------------------------------- */
+/*! Функция является аналогом функции ak_bckey_encrypt_blocks() для расшифрования данных.
+
+    @param bkey Контекст ключа алгоритма блочного шифрования.
+    @param in Указатель на область памяти, где хранятся входные блоки.
+    @param out Указатель на область памяти, куда помещаются расшифрованные блоки.
+    @param blocks Количество блоков.                                                               */
+/* ----------------------------------------------------------------------------------------------- */
+ void ak_bckey_decrypt_blocks( ak_bckey bkey, ak_pointer in, ak_pointer out, size_t blocks )
+{
+  ak_uint8 *inptr = (ak_uint8 *)in, *outptr = (ak_uint8 *)out;
+
+  if( bkey->decrypt_blocks != NULL ) {
+    bkey->decrypt_blocks( &bkey->key, in, out, blocks );
+    return;
+  }
+  while( blocks-- > 0 ) {
+    bkey->decrypt( &bkey->key, inptr, outptr );
+    inptr += bkey->bsize; outptr += bkey->bsize;
+  }
+}
+
+/* ----------------------------------------------------------------------------------------------- */
+/*! Функция складывает по модулю два входные данные с выработанной гаммой. При наличии
+    128-ми битных регистров данные обрабатываются фрагментами по 16 октетов.
+
+    @param out Указатель на область памяти, куда помещается результат;
+    может совпадать с указателем in.
+    @param in Указатель на входные данные.
+    @param gamma Указатель на гамму.
+    @param size Размер обрабатываемых данных (в байтах); должен быть кратен восьми.                */
+/* ----------------------------------------------------------------------------------------------- */
+ void ak_bckey_xor_gamma( ak_pointer out, ak_pointer in, ak_pointer gamma, size_t size )
+{
+  size_t i = 0;
+  ak_uint8 *outptr = (ak_uint8 *)out, *inptr = (ak_uint8 *)in, *gptr = (ak_uint8 *)gamma;
+
+#ifdef AK_HAVE_BUILTIN_XOR_SI128
+  for( ; i + 16 <= size; i += 16 )
+     _mm_storeu_si128( (__m128i *)( outptr + i ),
+                       _mm_xor_si128( _mm_loadu_si128( (const __m128i *)( inptr + i )),
+                                      _mm_loadu_si128( (const __m128i *)( gptr + i ))));
+#endif
+  for( ; i < size; i += 8 )
+     *(ak_uint64 *)( outptr + i ) = *(ak_uint64 *)( inptr + i ) ^ *(ak_uint64 *)( gptr + i );
+}
+
 /* ----------------------------------------------------------------------------------------------- */
 /*                             теперь реализация режимов шифрования                                */
 /* ----------------------------------------------------------------------------------------------- */
@@ -359,7 +523,6 @@
 {
   size_t blocks = 0;
   int error = ak_error_ok;
-  ak_uint64 *inptr = (ak_uint64 *)in, *outptr = (ak_uint64 *)out;
 
  /* выполняем проверку размера входных данных */
   if( size%bkey->bsize != 0 )
@@ -367,7 +530,7 @@
                             __func__ , "the length of input data is not divided by block length" );
 
  /* проверяем целостность ключа */
-  if( bkey->key.check_icode( &bkey->key ) != ak_true )
+  if( ak_skey_verify_icode( &bkey->key, ak_bckey_size_in_blocks( bkey, size )) != ak_true )
     return ak_error_message( ak_error_wrong_key_icode,
                                         __func__, "incorrect integrity code of secret key value" );
  /* уменьшаем значение ресурса ключа */
@@ -378,24 +541,13 @@
    else bkey->key.resource.value.counter -= blocks;
 
  /* теперь приступаем к зашифрованию данных */
-  switch( bkey->bsize ) {
-    case  8: /* шифр с длиной блока 64 бита */
-      do {
-        bkey->encrypt( &bkey->key, inptr++, outptr++ );
-      } while( --blocks > 0 );
-    break;
-
-    case 16: /* шифр с длиной блока 128 бит */
-      do {
-        bkey->encrypt( &bkey->key, inptr, outptr );
-        inptr+=2; outptr+=2;
-      } while( --blocks > 0 );
-    break;
-    default: return ak_error_message( ak_error_wrong_block_cipher,
+  if(( bkey->bsize != 8 ) && ( bkey->bsize != 16 ))
+    return ak_error_message( ak_error_wrong_block_cipher,
                                           __func__ , "incorrect block size of block cipher key" );
-  }
+  ak_bckey_encrypt_blocks( bkey, in, out, blocks );
+
  /* перемаскируем ключ */
-  if(( error = bkey->key.set_mask( &bkey->key )) != ak_error_ok )
+  if(( error = ak_skey_remask( &bkey->key, ak_bckey_size_in_blocks( bkey, size ))) != ak_error_ok )
     ak_error_message( error, __func__ , "wrong remasking of secret key" );
 
  return ak_error_ok;
@@ -416,7 +568,6 @@
 {
   size_t blocks = 0;
   int error = ak_error_ok;
-  ak_uint64 *inptr = (ak_uint64 *)in, *outptr = (ak_uint64 *)out;
 
  /* выполняем проверку размера входных данных */
   if( size%bkey->bsize != 0 )
@@ -424,7 +575,7 @@
                             __func__ , "the length of input data is not divided by block length" );
 
  /* проверяем целостность ключа */
-  if( bkey->key.check_icode( &bkey->key ) != ak_true )
+  if( ak_skey_verify_icode( &bkey->key, ak_bckey_size_in_blocks( bkey, size )) != ak_true )
     return ak_error_message( ak_error_wrong_key_icode,
                                         __func__, "incorrect integrity code of secret key value" );
  /* уменьшаем значение ресурса ключа */
@@ -435,29 +586,371 @@
    else bkey->key.resource.value.counter -= blocks;
 
  /* теперь приступаем к расшифрованию данных */
+  if(( bkey->bsize != 8 ) && ( bkey->bsize != 16 ))
+    return ak_error_message( ak_error_wrong_block_cipher,
+                                          __func__ , "incorrect block size of block cipher key" );
+  ak_bckey_decrypt_blocks( bkey, in, out, blocks );
+
+ /* перемаскируем ключ */
+  if(( error = ak_skey_remask( &bkey->key, ak_bckey_size_in_blocks( bkey, size ))) != ak_error_ok )
+    ak_error_message( error, __func__ , "wrong remasking of secret key" );
+
+ return ak_error_ok;
+}
+
+/* ----------------------------------------------------------------------------------------------- */
+/*! @param threads Запрошенное пользователем количество потоков; нулевое значение означает,
+    что количество потоков определяется числом доступных процессорных ядер.
+    @return Количество потоков, лежащее в пределах от единицы до \ref ak_bckey_max_threads.        */
+/* ----------------------------------------------------------------------------------------------- */
+ size_t ak_bckey_get_threads_count( size_t threads )
+{
+  if( threads == 0 ) {
+   #if defined( AK_HAVE_UNISTD_H ) && defined( _SC_NPROCESSORS_ONLN )
+    long cpus = sysconf( _SC_NPROCESSORS_ONLN );
+    threads = ( cpus > 0 ) ? ( size_t ) cpus : 1;
+   #else
+    threads = 1;
+   #endif
+  }
+ return ak_min( threads, ak_bckey_max_threads );
+}
+
+/* ----------------------------------------------------------------------------------------------- */
+/*! Многопоточные режимы шифрования создают копии ключа с помощью функции
+    ak_bckey_create_and_set_bckey(), которая использует функцию создания ключа,
+    связанную с идентификатором алгоритма. Ключи, для которых идентификатор не определен
+    (например, ключи алгоритма AES), а также ключи, созданные при другом значении опции
+    `openssl_compability`, должны обрабатываться последовательно.
+
+    @param bkey Контекст ключа алгоритма блочного шифрования.
+    @return Функция возвращает истину, если для ключа может быть создана копия.                    */
+/* ----------------------------------------------------------------------------------------------- */
+ bool_t ak_bckey_is_duplicable( ak_bckey bkey )
+{
+  if( bkey == NULL ) return ak_false;
+  if( bkey->key.oid == NULL ) return ak_false;
+  if( bkey->key.oid->func.first.create == NULL ) return ak_false;
+  if( bkey->key.options.openssl_compability != ak_libakrypt_get_openssl_compability( ))
+    return ak_false;
+ return ak_true;
+}
+
+/* ----------------------------------------------------------------------------------------------- */
+/*! \brief Функция проверяет синхропосылку режима гаммирования и, если синхропосылка задана,
+    помещает ее в контекст ключа.
+
+    Флаг `ak_key_flag_not_ctr` опускается при вызове функции с заданным значением синхропосылки;
+    если синхропосылка не задана, то используется значение счетчика, сохраненное в контексте
+    ключа. Ресурс ключа функцией не изменяется.
+    \return Функция возвращает \ref ak_error_ok, если синхропосылка может быть использована. */
+/* ----------------------------------------------------------------------------------------------- */
+ static int ak_bckey_ctr_set_ivector( ak_bckey bkey, ak_pointer iv, size_t iv_size )
+{
+  size_t halfsize = bkey->bsize >> 1; /* данное значение определяет в точности половину блока */
+  int oc = bkey->key.options.openssl_compability;
+
+  if(( bkey->bsize != 8 ) && ( bkey->bsize != 16 )) return ak_error_wrong_block_cipher;
+  if(( iv == NULL ) || ( iv_size == 0 )) { /* запрос на использование внутреннего значения */
+    if( bkey->key.flags&ak_key_flag_not_ctr ) return ak_error_wrong_block_cipher_function;
+    return ak_error_ok;
+  }
+ /* проверяем длину синхропосылки (если меньше половины блока, то плохо)
+    если больше, то нормально - лишнее простое не используется */
+  if( iv_size < halfsize ) return ak_error_wrong_iv_length;
+
+ /* помещаем во внутренний буффер значение синхропосылки */
+  memset( bkey->ivector, 0, ( bkey->ivector_size = bkey->bsize ));
+ /* слишком большое значение iv_size может привести к выходу за границы памяти,
+                                                       выделенной под переменную ivector */
+  memcpy( bkey->ivector + halfsize*((unsigned int)(1-oc)), iv, ak_min( halfsize, iv_size ));
+
+ /* опускаем значение флага: синхропосылка установлена */
+  bkey->key.flags = ( bkey->key.flags&( ~ak_key_flag_not_ctr ));
+ return ak_error_ok;
+}
+
+/* ----------------------------------------------------------------------------------------------- */
+/*! \brief Функция гаммирует данные, начиная со значения счетчика, хранящегося в контексте ключа,
+    и сохраняет в контексте следующее значение счетчика.
+
+    Функция не проверяет целостность ключа, не изменяет его ресурс и не перемаскирует ключ;
+    эти действия выполняются вызывающей функцией один раз для всех обрабатываемых данных.
+    \return Функция возвращает \ref ak_error_ok в случае успешного завершения.                */
+/* ----------------------------------------------------------------------------------------------- */
+ static int ak_bckey_ctr_process( ak_bckey bkey, ak_pointer in, ak_pointer out, size_t size )
+{
+  ak_int64 blocks = (ak_int64)( size/bkey->bsize ),
+             tail = (ak_int64)( size%bkey->bsize ), j, n;
+  ak_uint64 x, yaout[2], *inptr = (ak_uint64 *)in, *outptr = (ak_uint64 *)out;
+  ak_uint64 counter[2*ak_bckey_batch_blocks], gamma[2*ak_bckey_batch_blocks];
+  int oc = bkey->key.options.openssl_compability;
+
+ /* обработка основного массива данных (кратного длине блока):
+    значения счетчика формируются группами и зашифровываются за один вызов многоблочной функции */
   switch( bkey->bsize ) {
-    case  8: /* шифр с длиной блока 64 бита */
-      do {
-        bkey->decrypt( &bkey->key, inptr++, outptr++ );
-      } while( --blocks > 0 );
+    case  8: /* шифр с длиной блока 64 бита (Магма) */
+     #ifndef AK_LITTLE_ENDIAN
+      x = oc ? ((ak_uint64 *)bkey->ivector)[0] : bswap_64( ((ak_uint64 *)bkey->ivector)[0] );
+     #else
+      x = oc ? bswap_64( ((ak_uint64 *)bkey->ivector)[0] ) : ((ak_uint64 *)bkey->ivector)[0];
+     #endif
+      while( blocks > 0 ) {
+        n = ak_min( blocks, ak_bckey_batch_blocks );
+        for( j = 0; j < n; j++, x++ )
+         #ifndef AK_LITTLE_ENDIAN
+          counter[j] = oc ? x : bswap_64( x );
+         #else
+          counter[j] = oc ? bswap_64( x ) : x;
+         #endif
+        ak_bckey_encrypt_blocks( bkey, counter, gamma, (size_t) n );
+        ak_bckey_xor_gamma( outptr, inptr, gamma, (size_t) n << 3 );
+        inptr += n; outptr += n; blocks -= n;
+      }
+     #ifndef AK_LITTLE_ENDIAN
+      ((ak_uint64 *)bkey->ivector)[0] = oc ? x : bswap_64( x );
+     #else
+      ((ak_uint64 *)bkey->ivector)[0] = oc ? bswap_64( x ) : x;
+     #endif
     break;
 
-    case 16: /* шифр с длиной блока 128 бит */
-      do {
-        bkey->decrypt( &bkey->key, inptr, outptr );
-        inptr+=2; outptr+=2;
-      } while( --blocks > 0 );
+    case 16: /* шифр с длиной блока 128 бит (Кузнечик) */
+     #ifdef AK_LITTLE_ENDIAN
+      x = oc ? bswap_64( ((ak_uint64 *)bkey->ivector)[oc] ) : ((ak_uint64 *)bkey->ivector)[oc];
+     #else
+      x = oc ? ((ak_uint64 *)bkey->ivector)[oc] : bswap_64( ((ak_uint64 *)bkey->ivector)[oc] );
+     #endif
+      while( blocks > 0 ) {
+        n = ak_min( blocks, ak_bckey_batch_blocks );
+        for( j = 0; j < n; j++, x++ ) {
+           counter[2*j+1-oc] = ((ak_uint64 *)bkey->ivector)[1-oc];
+         #ifdef AK_LITTLE_ENDIAN
+           counter[2*j+oc] = oc ? bswap_64( x ) : x;
+         #else
+           counter[2*j+oc] = oc ? x : bswap_64( x );
+         #endif
+        }
+        ak_bckey_encrypt_blocks( bkey, counter, gamma, (size_t) n );
+        ak_bckey_xor_gamma( outptr, inptr, gamma, (size_t) n << 4 );
+        inptr += 2*n; outptr += 2*n; blocks -= n;
+      }
+                                  /* здесь мы не учитываем знак переноса
+                                     потому что объем данных на одном ключе не должен
+                                     превышать 2^64 блоков (контролируется через ресурс ключа) */
+     #ifdef AK_LITTLE_ENDIAN
+      ((ak_uint64 *)bkey->ivector)[oc] = oc ? bswap_64( x ) : x;
+     #else
+      ((ak_uint64 *)bkey->ivector)[oc] = oc ? x : bswap_64( x );
+     #endif
     break;
+
     default: return ak_error_message( ak_error_wrong_block_cipher,
                                           __func__ , "incorrect block size of block cipher key" );
   }
- /* перемаскируем ключ */
-  if(( error = bkey->key.set_mask( &bkey->key )) != ak_error_ok )
-    ak_error_message( error, __func__ , "wrong remasking of secret key" );
 
+ /* обрабатываем хвост сообщения */
+  if( tail ) {
+    int i;
+    bkey->encrypt( &bkey->key, bkey->ivector, yaout );
+    for( i = 0; i < tail; i++ ) /* теперь мы гаммируем tail байт, используя для этого
+                                   старшие байты (most significant bytes) зашифрованного счетчика */
+       if( oc ) {
+        /* для блочного шифра Магма этот код выдает результат отличный от того, что вырабатывает openssl
+           для блочного шифра Кузнечик результат совпадает
+
+           поиск того, почему Магма реализована по другому - задача за гранью добра и зла */
+         ( (ak_uint8*)outptr )[i] = ( (ak_uint8*)inptr )[i]^( (ak_uint8 *)yaout)[i];
+
+       } else ( (ak_uint8*)outptr )[i] =
+           ( (ak_uint8*)inptr )[i]^( (ak_uint8 *)yaout)[bkey->bsize - (size_t)(tail-i)];
+
+   /* запрещаем дальнейшее использование функции на данном значении синхропосылки,
+                                           поскольку обрабатываемые данные не кратны длине блока. */
+    memset( bkey->ivector, 0, sizeof( bkey->ivector ));
+    bkey->key.flags = bkey->key.flags&( ~ak_key_flag_not_ctr );
+  }
  return ak_error_ok;
 }
 
+#ifdef AK_HAVE_PTHREAD_H
+/* ----------------------------------------------------------------------------------------------- */
+/*! \brief Фрагмент данных, обрабатываемый одним потоком в режиме гаммирования. */
+ typedef struct bckey_ctr_piece {
+  /*! \brief Копия ключа, используемая потоком. */
+   struct bckey key;
+  /*! \brief Указатель на входные данные. */
+   ak_pointer in;
+  /*! \brief Указатель на выходные данные. */
+   ak_pointer out;
+  /*! \brief Размер фрагмента (в байтах), кратный длине блока. */
+   size_t size;
+  /*! \brief Код ошибки, возвращенный при обработке фрагмента. */
+   int error;
+  /*! \brief Дескриптор потока. */
+   pthread_t thread;
+  /*! \brief Флаг того, что поток был успешно создан. */
+   bool_t started;
+ } *ak_bckey_ctr_piece;
+
+/* ----------------------------------------------------------------------------------------------- */
+/*! \brief Функция потока, гаммирующая один фрагмент данных. */
+ static void *ak_bckey_ctr_thread( void *ptr )
+{
+  ak_bckey_ctr_piece piece = ( ak_bckey_ctr_piece ) ptr;
+  piece->error = ak_bckey_ctr_process( &piece->key, piece->in, piece->out, piece->size );
+ return NULL;
+}
+
+/* ----------------------------------------------------------------------------------------------- */
+/*! \brief Функция увеличивает значение счетчика, хранящегося в синхропосылке, на заданное
+    количество блоков. Значение счетчика хранится так же, как это делает функция ak_bckey_ctr(). */
+/* ----------------------------------------------------------------------------------------------- */
+ static void ak_bckey_ctr_shift_ivector( ak_uint8 *ivector, size_t bsize,
+                                                                    ak_uint64 offset, int oc )
+{
+  ak_uint64 *ctr = ( ak_uint64 *)ivector + ( bsize == 16 ? oc : 0 ), x;
+
+ #ifdef AK_LITTLE_ENDIAN
+  x = oc ? bswap_64( *ctr ) : *ctr;
+  x += offset;
+  *ctr = oc ? bswap_64( x ) : x;
+ #else
+  x = oc ? *ctr : bswap_64( *ctr );
+  x += offset;
+  *ctr = oc ? x : bswap_64( x );
+ #endif
+}
+#endif
+
+/* ----------------------------------------------------------------------------------------------- */
+/*! Функция реализует режим гаммирования из ГОСТ Р 34.13-2015 и вырабатывает тот же результат,
+    что и функция ak_bckey_ctr(). Данные, кратные длине блока, разбиваются на непрерывные
+    фрагменты, каждый из которых обрабатывается в отдельном потоке, начиная со своего значения
+    счетчика. Каждый поток использует собственную копию ключа, поскольку маскирование ключа
+    (например, для алгоритма Магма) изменяет его контекст. Ресурс ключа `bkey` уменьшается,
+    а ключ перемаскируется, один раз для всех обрабатываемых данных; значение синхропосылки,
+    сохраняемое в контексте ключа, совпадает со значением, которое было бы получено функцией
+    ak_bckey_ctr().
+
+    Потоки и копии ключа создаются при каждом вызове функции и уничтожаются перед возвратом
+    (пул потоков не используется), поэтому функция предназначена для обработки больших
+    объемов данных. Если библиотека собрана без поддержки потоков или объем данных мал, то
+    функция вызывает ak_bckey_ctr(); если копии ключа создать не удалось, то данные
+    обрабатываются последовательно.
+
+    @param bkey Контекст ключа алгоритма блочного шифрования.
+    @param in Указатель на область памяти, где хранятся входные (открытые) данные.
+    @param out Указатель на область памяти, куда помещаются зашифрованные данные
+    (этот указатель может совпадать с `in`).
+    @param size Размер зашировываемых данных (в байтах).
+    @param iv Указатель на синхропосылку; может принимать значение NULL.
+    @param iv_size Длина синхропосылки в байтах.
+    @param threads Количество используемых потоков; нулевое значение означает, что
+    количество потоков совпадает с количеством доступных процессорных ядер.
+
+    @return В случае возникновения ошибки функция возвращает ее код, в противном случае
+    возвращается \ref ak_error_ok (ноль)                                                           */
+/* ----------------------------------------------------------------------------------------------- */
+ int ak_bckey_ctr_threads( ak_bckey bkey, ak_pointer in, ak_pointer out, size_t size,
+                                                   ak_pointer iv, size_t iv_size, size_t threads )
+{
+#ifdef AK_HAVE_PTHREAD_H
+  size_t i, count = 0, blocks, tail, offset = 0;
+  ak_bckey_ctr_piece pieces = NULL;
+  int error = ak_error_ok, oc = 0;
+
+  if( bkey == NULL ) return ak_error_message( ak_error_null_pointer, __func__,
+                                                        "using null pointer to block cipher key" );
+  if(( bkey->bsize != 8 ) && ( bkey->bsize != 16 ))
+    return ak_error_message( ak_error_wrong_block_cipher,
+                                          __func__ , "incorrect block size of block cipher key" );
+  blocks = size/bkey->bsize;
+  tail = size%bkey->bsize;
+  threads = ak_min( ak_bckey_get_threads_count( threads ), blocks/ak_bckey_thread_blocks );
+  if(( threads < 2 ) || !ak_bckey_is_duplicable( bkey ))
+    return ak_bckey_ctr( bkey, in, out, size, iv, iv_size );
+
+ /* выполняем те же проверки, что и функция ak_bckey_ctr() */
+  if(( bkey->key.flags&ak_key_flag_set_key ) == 0 ) return ak_error_message( ak_error_key_value,
+                                    __func__, "using secret key context with undefined key value" );
+  if( ak_skey_verify_icode( &bkey->key, ak_bckey_size_in_blocks( bkey, size )) != ak_true )
+    return ak_error_message( ak_error_wrong_key_icode, __func__,
+                                                   "incorrect integrity code of secret key value" );
+  if( bkey->key.resource.value.counter < ( ssize_t )( blocks + ( tail > 0 )))
+    return ak_error_message( ak_error_low_key_resource,
+                                                    __func__ , "low resource of block cipher key" );
+  if(( error = ak_bckey_ctr_set_ivector( bkey, iv, iv_size )) != ak_error_ok )
+    return ak_error_message( error, __func__ , "incorrect initial value" );
+ /* ресурс ключа уменьшается один раз для всех обрабатываемых данных */
+  bkey->key.resource.value.counter -= ( ssize_t )( blocks + ( tail > 0 ));
+  oc = bkey->key.options.openssl_compability;
+
+ /* формируем фрагменты данных и копии ключа для каждого потока;
+    если копии ключа создать не удалось, данные обрабатываются последовательно */
+  if(( pieces = calloc( threads, sizeof( struct bckey_ctr_piece ))) == NULL ) {
+    ak_error_message( ak_error_out_of_memory, __func__,
+                            "incorrect memory allocation for threads, data is processed serially" );
+    goto labserial;
+  }
+  for( count = 0; count < threads; count++ ) {
+     size_t len = blocks/threads + ( count < blocks%threads );
+     ak_bckey_ctr_piece piece = pieces + count;
+
+     if(( error = ak_bckey_create_and_set_bckey( &piece->key, bkey )) != ak_error_ok ) {
+       ak_error_message( error, __func__,
+                                      "incorrect key duplication, data is processed serially" );
+       for( i = 0; i < count; i++ ) ak_bckey_destroy( &pieces[i].key );
+       free( pieces );
+       pieces = NULL;
+       goto labserial;
+     }
+     memcpy( piece->key.ivector, bkey->ivector, piece->key.ivector_size = bkey->bsize );
+     ak_bckey_ctr_shift_ivector( piece->key.ivector, bkey->bsize, offset, oc );
+     piece->in = ( ak_uint8 *)in + offset*bkey->bsize;
+     piece->out = ( ak_uint8 *)out + offset*bkey->bsize;
+     piece->size = len*bkey->bsize;
+     offset += len;
+  }
+
+ /* запускаем потоки; первый фрагмент, а также фрагменты,
+                                для которых не удалось создать поток, обрабатываются здесь */
+  for( i = 1; i < count; i++ )
+     pieces[i].started = ( pthread_create( &pieces[i].thread, NULL,
+                                             ak_bckey_ctr_thread, pieces + i ) == 0 );
+  ak_bckey_ctr_thread( pieces );
+  for( i = 1; i < count; i++ ) {
+     if( pieces[i].started ) pthread_join( pieces[i].thread, NULL );
+       else ak_bckey_ctr_thread( pieces + i );
+  }
+  for( i = 0; i < count; i++ ) {
+     if(( error == ak_error_ok ) && ( pieces[i].error != ak_error_ok ))
+       ak_error_message( error = pieces[i].error, __func__, "incorrect encryption in thread" );
+     ak_bckey_destroy( &pieces[i].key );
+  }
+  free( pieces );
+  if( error != ak_error_ok ) return error;
+
+ /* обновляем синхропосылку и обрабатываем хвост сообщения */
+  ak_bckey_ctr_shift_ivector( bkey->ivector, bkey->bsize, blocks, oc );
+  if( tail ) error = ak_bckey_ctr_process( bkey, ( ak_uint8 *)in + blocks*bkey->bsize,
+                                                   ( ak_uint8 *)out + blocks*bkey->bsize, tail );
+  goto labremask;
+
+  labserial:
+   error = ak_bckey_ctr_process( bkey, in, out, size );
+
+  labremask:
+  if( error != ak_error_ok ) return error;
+ /* ключ перемаскируется один раз для всех обрабатываемых данных */
+  if(( error = ak_skey_remask( &bkey->key, ak_bckey_size_in_blocks( bkey, size ))) != ak_error_ok )
+    ak_error_message( error, __func__ , "wrong remasking of secret key" );
+ return error;
+#else
+  (void) threads;
+ return ak_bckey_ctr( bkey, in, out, size, iv, iv_size );
+#endif
+}
+
 /* ----------------------------------------------------------------------------------------------- */
 /*! Поскольку в режиме гаммирования операцией шифрования является сложение открытого текста по
     модулю два с последовательностью, вырабатываемой блочным шифром из заданной синхропосылки,
@@ -513,127 +1006,32 @@
 {
   ak_int64 blocks = (ak_int64)( size/bkey->bsize ),
              tail = (ak_int64)( size%bkey->bsize );
-  ak_uint64 x, yaout[2], *inptr = (ak_uint64 *)in, *outptr = (ak_uint64 *)out;
-  int error = ak_error_ok, oc = (int) ak_libakrypt_get_option_by_name( "openssl_compability" );
-
-  if(( oc < 0 ) || ( oc > 1 )) return ak_error_message( ak_error_wrong_option, __func__,
-                                                "wrong value for \"openssl_compability\" option" );
+  int error = ak_error_ok;
 
  /* проверяем, установлен ли ключ */
   if(( bkey->key.flags&ak_key_flag_set_key ) == 0 ) return ak_error_message( ak_error_key_value,
                                     __func__, "using secret key context with undefined key value" );
 
  /* проверяем целостность ключа */
-  if( bkey->key.check_icode( &bkey->key ) != ak_true )
+  if( ak_skey_verify_icode( &bkey->key, ak_bckey_size_in_blocks( bkey, size )) != ak_true )
     return ak_error_message( ak_error_wrong_key_icode, __func__,
                                                    "incorrect integrity code of secret key value" );
- /* уменьшаем значение ресурса ключа */
+ /* проверяем ресурс ключа */
   if( bkey->key.resource.value.counter < ( blocks + ( tail > 0 )))
     return ak_error_message( ak_error_low_key_resource,
                                                     __func__ , "low resource of block cipher key" );
-   else bkey->key.resource.value.counter -= ( blocks + ( tail > 0 ));
-
- /* выбираем, как вычислять синхропосылку проверяем флаг
-    флаг поднимается при вызове функции с заданным значением синхропосылки и
-    всегда опускается при обработке данных, не кратных длина блока */
-  if(( iv == NULL ) || ( iv_size == 0 )) { /* запрос на использование внутреннего значения */
-
-    if( bkey->key.flags&ak_key_flag_not_ctr )
-      return ak_error_message( ak_error_wrong_block_cipher_function, __func__ ,
-                                           "function call with undefined value of initial vector" );
-  } else {
-    /* данное значение определяет в точности половину блока */
-     size_t halfsize = bkey->bsize >> 1 ;
-
-    /* проверяем длину синхропосылки (если меньше половины блока, то плохо)
-        если больше, то нормально - лишнее простое не используется */
-     if( iv_size < halfsize )
-       return ak_error_message( ak_error_wrong_iv_length, __func__,
-                                                              "incorrect length of initial value" );
-    /* помещаем во внутренний буффер значение синхропосылки */
-     memset( bkey->ivector, 0, ( bkey->ivector_size = bkey->bsize ));
-    /* слишком большое значение iv_size может привести к выходу за границы памяти,
-                                                       выделенной под переменную ivector */
-     memcpy( bkey->ivector + halfsize*((unsigned int)(1-oc)), iv, ak_min( halfsize, iv_size ));
-
-    /* поднимаем значение флага: синхропосылка установлена */ 
-     bkey->key.flags = ( bkey->key.flags&( ~ak_key_flag_not_ctr ));
-    }
-
- /* обработка основного массива данных (кратного длине блока) */
-  switch( bkey->bsize ) {
-    case  8: /* шифр с длиной блока 64 бита (Магма) */
-      while( blocks > 0 ) {
-        #ifndef AK_LITTLE_ENDIAN
-          x = oc ? ((ak_uint64 *)bkey->ivector)[0] : bswap_64( ((ak_uint64 *)bkey->ivector)[0] );
-        #else
-          x = oc ? bswap_64( ((ak_uint64 *)bkey->ivector)[0] ) : ((ak_uint64 *)bkey->ivector)[0];
-        #endif
-          bkey->encrypt( &bkey->key, bkey->ivector, yaout );
-          *outptr = *inptr ^ yaout[0];
-          outptr++; inptr++;
-
-        #ifndef AK_LITTLE_ENDIAN
-          ((ak_uint64 *)bkey->ivector)[0] = oc ? ++x : bswap_64( ++x );
-        #else
-          ((ak_uint64 *)bkey->ivector)[0] = oc ? bswap_64( ++x ) : ++x;
-        #endif
-        --blocks;
-      }
-    break;
-
-    case 16: /* шифр с длиной блока 128 бит (Кузнечик) */
-     #ifndef AK_LITTLE_ENDIAN
-      x = bswap_64( ((ak_uint64 *)bkey->ivector)[oc] );
-     #else
-      x = ((ak_uint64 *)bkey->ivector)[oc];
-     #endif
-
-      while( blocks > 0 ) {
-          bkey->encrypt( &bkey->key, bkey->ivector, yaout );
-          *outptr = *inptr ^ yaout[0]; outptr++; inptr++;
-          *outptr = *inptr ^ yaout[1]; outptr++; inptr++;
-
-       /* за элементарное сложение с единицей приходится платить одним разворотом */
-        #ifdef AK_LITTLE_ENDIAN
-         ((ak_uint64 *)bkey->ivector)[oc] = oc ? bswap_64(++x) : ++x;
-        #else
-          ((ak_uint64 *)bkey->ivector)[oc] = oc ? ++x : bswap_64( ++x );
-        #endif                    /* здесь мы не учитываем знак переноса
-                                     потому что объем данных на одном ключе не должен
-                                     превышать 2^64 блоков (контролируется через ресурс ключа) */
-        --blocks;
-      }
-    break;
-
-    default: return ak_error_message( ak_error_wrong_block_cipher,
-                                          __func__ , "incorrect block size of block cipher key" );
-  }
-
- /* обрабатываем хвост сообщения */
-  if( tail ) {
-    int i;
-    bkey->encrypt( &bkey->key, bkey->ivector, yaout );
-    for( i = 0; i < tail; i++ ) /* теперь мы гаммируем tail байт, используя для этого
-                                   старшие байты (most significant bytes) зашифрованного счетчика */
-       if( oc ) {
-        /* для блочного шифра Магма этот код выдает результат отличный от того, что вырабатывает openssl
-           для блочного шифра Кузнечик результат совпадает
-
-           поиск того, почему Магма реализована по другому - задача за гранью добра и зла */
-         ( (ak_uint8*)outptr )[i] = ( (ak_uint8*)inptr )[i]^( (ak_uint8 *)yaout)[i];
-
-       } else ( (ak_uint8*)outptr )[i] =
-           ( (ak_uint8*)inptr )[i]^( (ak_uint8 *)yaout)[bkey->bsize - (size_t)(tail-i)];
+ /* выбираем, как вычислять синхропосылку */
+  if(( error = ak_bckey_ctr_set_ivector( bkey, iv, iv_size )) != ak_error_ok )
+    return ak_error_message( error, __func__ , "incorrect initial value" );
+ /* уменьшаем значение ресурса ключа */
+  bkey->key.resource.value.counter -= ( blocks + ( tail > 0 ));
 
-   /* запрещаем дальнейшее использование функции на данном значении синхропосылки,
-                                           поскольку обрабатываемые данные не кратны длине блока. */
-    memset( bkey->ivector, 0, sizeof( bkey->ivector ));
-    bkey->key.flags = bkey->key.flags&( ~ak_key_flag_not_ctr );
-  }
+ /* обрабатываем данные */
+  if(( error = ak_bckey_ctr_process( bkey, in, out, size )) != ak_error_ok )
+    return ak_error_message( error, __func__ , "incorrect encryption of data" );
 
  /* перемаскируем ключ */
-  if(( error = bkey->key.set_mask( &bkey->key )) != ak_error_ok )
+  if(( error = ak_skey_remask( &bkey->key, ak_bckey_size_in_blocks( bkey, size ))) != ak_error_ok )
     ak_error_message( error, __func__ , "wrong remasking of secret key" );
 
  return error;
@@ -646,10 +1044,7 @@
    ak_int64 blocks = 0;
    ak_uint64 yaout[2], z = iv_size / bkey->bsize;
    ak_uint64 *inptr = (ak_uint64 *)in, *outptr = (ak_uint64 *)out, *ivector = (ak_uint64 *)bkey->ivector;
-   int error = ak_error_ok, oc = (int) ak_libakrypt_get_option_by_name( "openssl_compability" );
-
-   if(( oc < 0 ) || ( oc > 1 )) return ak_error_message( ak_error_wrong_option, __func__,
-                                                 "wrong value for \"openssl_compability\" option" );
+   int error = ak_error_ok;
 
   /* выполняем проверку размера входных данных */
    if( size%bkey->bsize != 0 )
@@ -657,7 +1052,7 @@
                              __func__ , "the length of input data is not divided by block length" );
 
   /* проверяем целостность ключа */
-   if( bkey->key.check_icode( &bkey->key ) != ak_true )
+   if( ak_skey_verify_icode( &bkey->key, ak_bckey_size_in_blocks( bkey, size )) != ak_true )
      return ak_error_message( ak_error_wrong_key_icode,
                                          __func__, "incorrect integrity code of secret key value" );
   /* уменьшаем значение ресурса ключа */
@@ -707,7 +1102,7 @@
                                            __func__ , "incorrect block size of block cipher key" );
    }
   /* перемаскируем ключ */
-   if(( error = bkey->key.set_mask( &bkey->key )) != ak_error_ok )
+   if(( error = ak_skey_remask( &bkey->key, ak_bckey_size_in_blocks( bkey, size ))) != ak_error_ok )
      ak_error_message( error, __func__ , "wrong remasking of secret key" );
 
   return ak_error_ok;
@@ -717,13 +1112,11 @@
  int ak_bckey_decrypt_cbc( ak_bckey bkey, ak_pointer in, ak_pointer out, size_t size,
                                                                     ak_pointer iv, size_t iv_size )
  {
-  ak_int64 blocks = 0;
-  ak_uint64 yaout[2], z = iv_size / bkey->bsize;
-  ak_uint64 *inptr = (ak_uint64 *)in, *outptr = (ak_uint64 *)out, *ivector = (ak_uint64 *)bkey->ivector;
-  int error = ak_error_ok, oc = (int) ak_libakrypt_get_option_by_name( "openssl_compability" );
-
-  if(( oc < 0 ) || ( oc > 1 )) return ak_error_message( ak_error_wrong_option, __func__,
-                                                "wrong value for \"openssl_compability\" option" );
+  ak_int64 blocks = 0, j, n;
+  size_t i = 0, k, w, z = iv_size / bkey->bsize;
+  ak_uint64 x, yaout[2*ak_bckey_batch_blocks];
+  ak_uint64 *inptr = (ak_uint64 *)in, *outptr = (ak_uint64 *)out, *ivector = NULL;
+  int error = ak_error_ok;
 
  /* выполняем проверку размера входных данных */
   if( size%bkey->bsize != 0 )
@@ -731,7 +1124,7 @@
                             __func__ , "the length of input data is not divided by block length" );
 
  /* проверяем целостность ключа */
-  if( bkey->key.check_icode( &bkey->key ) != ak_true )
+  if( ak_skey_verify_icode( &bkey->key, ak_bckey_size_in_blocks( bkey, size )) != ak_true )
     return ak_error_message( ak_error_wrong_key_icode,
                                         __func__, "incorrect integrity code of secret key value" );
  /* уменьшаем значение ресурса ключа */
@@ -749,40 +1142,28 @@
                                                              "incorrect length of initial value" );
    memcpy(bkey->ivector, iv, iv_size);
 
- /* теперь приступаем к расшифрованию данных */
-  switch( bkey->bsize ) {
-    case  8: /* шифр с длиной блока 64 бита */
-      while( blocks > 0 ) {
-          bkey->decrypt( &bkey->key, inptr, yaout );
-          if( z == 0 ) {
-              ivector = (ak_uint64 *)in;
-          }
-          *outptr = yaout[0] ^ *ivector; outptr++; ivector++;
-          inptr++;
-          --blocks;
-          --z;
-      }
-    break;
-
-    case 16: /* шифр с длиной блока 128 бит */
-      while( blocks > 0 ) {
-          bkey->decrypt( &bkey->key, inptr, yaout );
-          if( z == 0 ) {
-              ivector = (ak_uint64 *)in;
-          }
-          *outptr = yaout[0] ^ *ivector; outptr++; ivector++;
-          *outptr = yaout[1] ^ *ivector; outptr++; ivector++;
-          inptr+=2;
-          --blocks;
-          --z;
-      }
-
-    break;
-    default: return ak_error_message( ak_error_wrong_block_cipher,
+ /* теперь приступаем к расшифрованию данных:
+    блоки шифртекста расшифровываются группами, после чего к ним прибавляются значения,
+    хранящиеся в регистре из z блоков; регистр заполняется блоками шифртекста */
+  if(( bkey->bsize != 8 ) && ( bkey->bsize != 16 ))
+    return ak_error_message( ak_error_wrong_block_cipher,
                                           __func__ , "incorrect block size of block cipher key" );
+  w = bkey->bsize >> 3;
+  while( blocks > 0 ) {
+    n = ak_min( blocks, ak_bckey_batch_blocks );
+    ak_bckey_decrypt_blocks( bkey, inptr, yaout, (size_t) n );
+    for( j = 0; j < n; j++ ) {
+       ivector = (ak_uint64 *)( bkey->ivector + i*bkey->bsize );
+       for( k = 0; k < w; k++ ) {
+          x = inptr[k]; outptr[k] = yaout[j*w+k] ^ ivector[k]; ivector[k] = x;
+       }
+       inptr += w; outptr += w;
+       if( ++i == z ) i = 0;
+    }
+    blocks -= n;
   }
  /* перемаскируем ключ */
-  if(( error = bkey->key.set_mask( &bkey->key )) != ak_error_ok )
+  if(( error = ak_skey_remask( &bkey->key, ak_bckey_size_in_blocks( bkey, size ))) != ak_error_ok )
     ak_error_message( error, __func__ , "wrong remasking of secret key" );
 
  return ak_error_ok;
@@ -796,13 +1177,10 @@
   ak_int64 blocks = (ak_int64)( size/bkey->bsize ),
              tail = (ak_int64)( size%bkey->bsize );
   ak_uint64 yaout[2], *inptr = (ak_uint64 *)in, *outptr = (ak_uint64 *)out;
-  int error = ak_error_ok, oc = (int) ak_libakrypt_get_option_by_name( "openssl_compability" );
+  int error = ak_error_ok;
   unsigned long counter = 0, z = iv_size / bkey->bsize; /* во сколько раз синхрпосылка длиннее блока */
-
-  if(( oc < 0 ) || ( oc > 1 )) return ak_error_message( ak_error_wrong_option, __func__,
-                                               "wrong value for \"openssl_compability\" option" );
  /* проверяем целостность ключа */
-  if( bkey->key.check_icode( &bkey->key ) != ak_true )
+  if( ak_skey_verify_icode( &bkey->key, ak_bckey_size_in_blocks( bkey, size )) != ak_true )
     return ak_error_message( ak_error_wrong_key_icode, __func__,
                                                    "incorrect integrity code of secret key value" );
  /* уменьшаем значение ресурса ключа */
@@ -880,12 +1258,49 @@
    }
 
   /* перемаскируем ключ */
-   if(( error = bkey->key.set_mask( &bkey->key )) != ak_error_ok )
+   if(( error = ak_skey_remask( &bkey->key, ak_bckey_size_in_blocks( bkey, size ))) != ak_error_ok )
      ak_error_message( error, __func__ , "wrong remasking of secret key" );
 
   return error;
  }
 
+/* ----------------------------------------------------------------------------------------------- */
+/*! \brief Функция проверяет синхропосылку, передаваемую в функции режима cfb.
+
+    Если синхропосылка не задана, то проверяется, что в контексте ключа сохранено значение,
+    выработанное предыдущим вызовом функции на данных, длина которых кратна длине блока.
+    \return Функция возвращает \ref ak_error_ok, если синхропосылка может быть использована. */
+/* ----------------------------------------------------------------------------------------------- */
+ static int ak_bckey_cfb_check_ivector( ak_bckey bkey, ak_pointer iv, size_t iv_size )
+{
+  if(( bkey->bsize != 8 ) && ( bkey->bsize != 16 )) return ak_error_wrong_block_cipher;
+  if(( iv == NULL ) || ( iv_size == 0 )) { /* запрос на использование внутреннего значения */
+    if(( bkey->key.flags&ak_key_flag_not_ctr ) || ( bkey->ivector_size < bkey->bsize ) ||
+       ( bkey->ivector_size%bkey->bsize ) || ( bkey->ivector_size > sizeof( bkey->ivector )))
+      return ak_error_wrong_block_cipher_function;
+  }
+   else { /* длина синхропосылки должна быть кратна длине блока */
+    if(( iv_size%bkey->bsize ) || ( iv_size > sizeof( bkey->ivector )))
+      return ak_error_wrong_iv_length;
+   }
+ return ak_error_ok;
+}
+
+/* ----------------------------------------------------------------------------------------------- */
+/*! \brief Функция циклически сдвигает регистр режима cfb так, чтобы блок с индексом `i`
+    стал первым; следующий вызов функции без синхропосылки начинает обработку с этого блока. */
+/* ----------------------------------------------------------------------------------------------- */
+ static void ak_bckey_cfb_shift_ivector( ak_bckey bkey, size_t i )
+{
+  ak_uint8 reg[sizeof( bkey->ivector )];
+  size_t len = i*bkey->bsize;
+
+  if( len == 0 ) return;
+  memcpy( reg, bkey->ivector, len );
+  memmove( bkey->ivector, bkey->ivector + len, bkey->ivector_size - len );
+  memcpy( bkey->ivector + ( bkey->ivector_size - len ), reg, len );
+}
+
 /* ----------------------------------------------------------------------------------------------- */
  int ak_bckey_encrypt_cfb( ak_bckey bkey, ak_pointer in, ak_pointer out, size_t size,
                                                                       ak_pointer iv, size_t iv_size )
@@ -894,13 +1309,14 @@
               tail = (ak_int64)( size%bkey->bsize );
    ak_uint8 *vecptr = NULL;
    ak_uint64 yaout[2], *inptr = (ak_uint64 *)in, *outptr = (ak_uint64 *)out;
-   int error = ak_error_ok, oc = (int) ak_libakrypt_get_option_by_name( "openssl_compability" );
-   unsigned long i = 0, z = iv_size / bkey->bsize; // во сколько раз синхрпосылка длиннее блока
+   int error = ak_error_ok;
+   unsigned long i = 0, z = 0; // во сколько раз синхрпосылка длиннее блока
 
-   if(( oc < 0 ) || ( oc > 1 )) return ak_error_message( ak_error_wrong_option, __func__,
-                                                 "wrong value for \"openssl_compability\" option" );
+  /* проверяем синхропосылку до изменения ресурса и состояния ключа */
+   if(( error = ak_bckey_cfb_check_ivector( bkey, iv, iv_size )) != ak_error_ok )
+     return ak_error_message( error, __func__, "incorrect initial value" );
   /* проверяем целостность ключа */
-   if( bkey->key.check_icode( &bkey->key ) != ak_true )
+   if( ak_skey_verify_icode( &bkey->key, ak_bckey_size_in_blocks( bkey, size )) != ak_true )
      return ak_error_message( ak_error_wrong_key_icode, __func__,
                                                     "incorrect integrity code of secret key value" );
   /* уменьшаем значение ресурса ключа */
@@ -909,27 +1325,13 @@
                                                      __func__ , "low resource of block cipher key" );
     else bkey->key.resource.value.counter -= ( blocks + ( tail > 0 ));
 
-  /* выбираем, как вычислять синхропосылку проверяем флаг
-     флаг поднимается при вызове функции с заданным значением синхропосылки и
-     всегда опускается при обработке данных, не кратных длине блока */
-   if(( iv == NULL ) || ( iv_size == 0 )) { /* запрос на использование внутреннего значения */
-
-     if( bkey->key.flags&ak_key_flag_not_ctr )
-       return ak_error_message( ak_error_wrong_block_cipher_function, __func__ ,
-                                            "function call with undefined value of initial vector" );
-   } else {
-
-     /* проверяем длину синхропосылки (если меньше длины блока, то плохо)
-         если больше, то нормально - лишнее просто не используется */
-      if( (iv_size % bkey->bsize) || (iv_size > 64) )
-        return ak_error_message( ak_error_wrong_iv_length, __func__,
-                                                               "incorrect length of initial value" );
-     /* помещаем во внутренний буффер значение синхропосылки */
-      memcpy(bkey->ivector, iv, iv_size);
-
-     /* поднимаем значение флага: синхропосылка установлена */
-      bkey->key.flags = ( bkey->key.flags&( ~ak_key_flag_not_ctr ))^ak_key_flag_not_ctr;
-     }
+  /* если синхропосылка задана, то помещаем ее во внутренний буффер и опускаем флаг;
+     в противном случае используется значение, сохраненное при предыдущем вызове функции */
+   if(( iv != NULL ) && ( iv_size != 0 )) {
+     memcpy( bkey->ivector, iv, bkey->ivector_size = iv_size );
+     bkey->key.flags = bkey->key.flags&( ~ak_key_flag_not_ctr );
+   }
+   z = bkey->ivector_size / bkey->bsize;
 
   /* обработка основного массива данных (кратного длине блока) */
    switch( bkey->bsize ) {
@@ -964,7 +1366,7 @@
 
   /* обрабатываем хвост сообщения */
    if( tail ) {
-     vecptr = (bkey->ivector + bkey->bsize * (i % (int)(iv_size / bkey->bsize)));
+     vecptr = bkey->ivector + i*bkey->bsize;
      bkey->encrypt( &bkey->key, vecptr, yaout );
      for( i = 0; i < (unsigned long)tail; i++ )
         ( (ak_uint8*)outptr)[i] = ( (ak_uint8*)inptr )[i]^( (ak_uint8 *)yaout)[i];
@@ -972,11 +1374,12 @@
      /* запрещаем дальнейшее использование функции на данном значении синхропосылки,
                                                поскольку обрабатываемые данные не кратны длине блока. */
      memset( bkey->ivector, 0, sizeof( bkey->ivector ));
-     bkey->key.flags = bkey->key.flags&( ~ak_key_flag_not_ctr );
+     bkey->key.flags = ( bkey->key.flags&( ~ak_key_flag_not_ctr ))^ak_key_flag_not_ctr;
      /* перемаскируем ключ */
-     if(( error = bkey->key.set_mask( &bkey->key )) != ak_error_ok )
+     if(( error = ak_skey_remask( &bkey->key, ak_bckey_size_in_blocks( bkey, size ))) != ak_error_ok )
         ak_error_message( error, __func__ , "wrong remasking of secret key" );
    }
+    else ak_bckey_cfb_shift_ivector( bkey, i );
    return error;
 }
 
@@ -985,16 +1388,18 @@
                                                                       ak_pointer iv, size_t iv_size )
  {
    ak_int64 blocks = (ak_int64)( size/bkey->bsize ),
-              tail = (ak_int64)( size%bkey->bsize );
+              tail = (ak_int64)( size%bkey->bsize ), j, n;
    ak_uint8 *vecptr = NULL;
-   ak_uint64 yaout[2], *inptr = (ak_uint64 *)in, *outptr = (ak_uint64 *)out;
-   int error = ak_error_ok, oc = (int) ak_libakrypt_get_option_by_name( "openssl_compability" );
-   unsigned long i = 0, z = iv_size / bkey->bsize; // во сколько раз синхрпосылка длиннее блока
-
-   if(( oc < 0 ) || ( oc > 1 )) return ak_error_message( ak_error_wrong_option, __func__,
-                                                 "wrong value for \"openssl_compability\" option" );
+   ak_uint64 x, yaout[2], *inptr = (ak_uint64 *)in, *outptr = (ak_uint64 *)out;
+   ak_uint64 counter[2*ak_bckey_batch_blocks], gamma[2*ak_bckey_batch_blocks];
+   int error = ak_error_ok;
+   unsigned long i = 0, k, w, z = 0; // во сколько раз синхрпосылка длиннее блока
+
+  /* проверяем синхропосылку до изменения ресурса и состояния ключа */
+   if(( error = ak_bckey_cfb_check_ivector( bkey, iv, iv_size )) != ak_error_ok )
+     return ak_error_message( error, __func__, "incorrect initial value" );
   /* проверяем целостность ключа */
-   if( bkey->key.check_icode( &bkey->key ) != ak_true )
+   if( ak_skey_verify_icode( &bkey->key, ak_bckey_size_in_blocks( bkey, size )) != ak_true )
      return ak_error_message( ak_error_wrong_key_icode, __func__,
                                                     "incorrect integrity code of secret key value" );
   /* уменьшаем значение ресурса ключа */
@@ -1003,62 +1408,42 @@
                                                      __func__ , "low resource of block cipher key" );
     else bkey->key.resource.value.counter -= ( blocks + ( tail > 0 ));
 
-  /* выбираем, как вычислять синхропосылку проверяем флаг
-     флаг поднимается при вызове функции с заданным значением синхропосылки и
-     всегда опускается при обработке данных, не кратных длине блока */
-   if(( iv == NULL ) || ( iv_size == 0 )) { /* запрос на использование внутреннего значения */
-
-     if( bkey->key.flags&ak_key_flag_not_ctr )
-       return ak_error_message( ak_error_wrong_block_cipher_function, __func__ ,
-                                            "function call with undefined value of initial vector" );
-   } else {
-
-     /* проверяем длину синхропосылки (если меньше длины блока, то плохо)
-         если больше, то нормально - лишнее просто не используется */
-      if( (iv_size % bkey->bsize) || (iv_size > 64) )
-        return ak_error_message( ak_error_wrong_iv_length, __func__,
-                                                               "incorrect length of initial value" );
-     /* помещаем во внутренний буффер значение синхропосылки */
-      memcpy(bkey->ivector, iv, iv_size);
-
-     /* поднимаем значение флага: синхропосылка установлена */
-      bkey->key.flags = ( bkey->key.flags&( ~ak_key_flag_not_ctr ))^ak_key_flag_not_ctr;
+  /* если синхропосылка задана, то помещаем ее во внутренний буффер и опускаем флаг;
+     в противном случае используется значение, сохраненное при предыдущем вызове функции */
+   if(( iv != NULL ) && ( iv_size != 0 )) {
+     memcpy( bkey->ivector, iv, bkey->ivector_size = iv_size );
+     bkey->key.flags = bkey->key.flags&( ~ak_key_flag_not_ctr );
+   }
+   z = bkey->ivector_size / bkey->bsize;
+
+  /* обработка основного массива данных (кратного длине блока):
+     поскольку на вход блочного шифра подаются либо значения из регистра,
+     либо ранее полученные блоки шифртекста, гамма может вырабатываться группами блоков */
+   w = bkey->bsize >> 3;
+   while( blocks > 0 ) {
+     n = ak_min( blocks, ak_bckey_batch_blocks );
+     for( j = 0, k = i; j < n; j++ ) {
+        if( (size_t)j < z ) {
+          memcpy( counter + j*w, bkey->ivector + k*bkey->bsize, bkey->bsize );
+          if( ++k == z ) k = 0;
+        }
+         else memcpy( counter + j*w, inptr + (j-z)*w, bkey->bsize );
      }
-
-  /* обработка основного массива данных (кратного длине блока) */
-   switch( bkey->bsize ) {
-     case  8: /* шифр с длиной блока 64 бита */
-       while( blocks > 0 ) {
-           vecptr = (bkey->ivector + i*bkey->bsize);
-           bkey->encrypt( &bkey->key, vecptr, yaout );
-           *outptr = *inptr ^ yaout[0];
-           ((ak_uint64 *)vecptr)[0] = *inptr;
-           outptr++; inptr++;
-           if (++i == z) i = 0;
-           --blocks;
-       }
-     break;
-
-     case 16: /* шифр с длиной блока 128 бит */
-       while( blocks > 0 ) {
-           vecptr = (bkey->ivector + i*bkey->bsize );
-           bkey->encrypt( &bkey->key, vecptr, yaout );
-           *outptr = *inptr ^ yaout[0];
-           ((ak_uint64 *)vecptr)[0] = *inptr; ++outptr; ++inptr;
-           *outptr = *inptr ^ yaout[1];
-           ((ak_uint64 *)vecptr)[1] = *inptr; ++outptr; ++inptr;
-           if (++i == z) i = 0;
-           --blocks;
-       }
-     break;
-
-     default: return ak_error_message( ak_error_wrong_block_cipher,
-                                           __func__ , "incorrect block size of block cipher key" );
+     ak_bckey_encrypt_blocks( bkey, counter, gamma, (size_t) n );
+     for( j = 0; j < n; j++ ) {
+        vecptr = (bkey->ivector + i*bkey->bsize );
+        for( k = 0; k < w; k++ ) {
+           x = inptr[k]; outptr[k] = x ^ gamma[j*w+k]; ((ak_uint64 *)vecptr)[k] = x;
+        }
+        inptr += w; outptr += w;
+        if( ++i == z ) i = 0;
+     }
+     blocks -= n;
    }
 
   /* обрабатываем хвост сообщения */
    if( tail ) {
-     vecptr = (bkey->ivector + bkey->bsize * (i % (int)(iv_size / bkey->bsize)));
+     vecptr = bkey->ivector + i*bkey->bsize;
      bkey->encrypt( &bkey->key, vecptr, yaout );
      for( i = 0; i < (unsigned long)tail; i++ )
         ( (ak_uint8*)outptr)[i] = ( (ak_uint8*)inptr )[i]^( (ak_uint8 *)yaout)[i];
@@ -1066,14 +1451,228 @@
      /* запрещаем дальнейшее использование функции на данном значении синхропосылки,
                                                поскольку обрабатываемые данные не кратны длине блока. */
      memset( bkey->ivector, 0, sizeof( bkey->ivector ));
-     bkey->key.flags = bkey->key.flags&( ~ak_key_flag_not_ctr );
+     bkey->key.flags = ( bkey->key.flags&( ~ak_key_flag_not_ctr ))^ak_key_flag_not_ctr;
      /* перемаскируем ключ */
-     if(( error = bkey->key.set_mask( &bkey->key )) != ak_error_ok )
+     if(( error = ak_skey_remask( &bkey->key, ak_bckey_size_in_blocks( bkey, size ))) != ak_error_ok )
         ak_error_message( error, __func__ , "wrong remasking of secret key" );
    }
+    else ak_bckey_cfb_shift_ivector( bkey, i );
    return error;
 }
 
+#ifdef AK_HAVE_PTHREAD_H
+/* ----------------------------------------------------------------------------------------------- */
+/*! \brief Функция расшифрования в режимах простой замены с зацеплением или
+    гаммирования с обратной связью по шифртексту. */
+ typedef int ( ak_function_bckey_decrypt_chain )( ak_bckey , ak_pointer , ak_pointer , size_t ,
+                                                                             ak_pointer , size_t );
+
+/* ----------------------------------------------------------------------------------------------- */
+/*! \brief Фрагмент данных, расшифровываемый одним потоком в режимах cbc и cfb. */
+ typedef struct bckey_decrypt_piece {
+  /*! \brief Копия ключа, используемая потоком. */
+   struct bckey key;
+  /*! \brief Указатель на входные данные. */
+   ak_pointer in;
+  /*! \brief Указатель на выходные данные. */
+   ak_pointer out;
+  /*! \brief Размер фрагмента (в байтах), кратный длине блока. */
+   size_t size;
+  /*! \brief Блоки шифртекста, предшествующие фрагменту и используемые в качестве синхропосылки. */
+   ak_uint8 iv[64];
+  /*! \brief Длина синхропосылки (в байтах). */
+   size_t iv_size;
+  /*! \brief Функция расшифрования фрагмента. */
+   ak_function_bckey_decrypt_chain *decrypt;
+  /*! \brief Код ошибки, возвращенный при обработке фрагмента. */
+   int error;
+  /*! \brief Дескриптор потока. */
+   pthread_t thread;
+  /*! \brief Флаг того, что поток был успешно создан. */
+   bool_t started;
+ } *ak_bckey_decrypt_piece;
+
+/* ----------------------------------------------------------------------------------------------- */
+/*! \brief Функция потока, расшифровывающая один фрагмент данных. */
+ static void *ak_bckey_decrypt_thread( void *ptr )
+{
+  ak_bckey_decrypt_piece piece = ( ak_bckey_decrypt_piece ) ptr;
+  piece->error = piece->decrypt( &piece->key, piece->in, piece->out,
+                                                       piece->size, piece->iv, piece->iv_size );
+ return NULL;
+}
+
+/* ----------------------------------------------------------------------------------------------- */
+/*! \brief Многопоточное расшифрование в режимах cbc и cfb.
+
+    В обоих режимах очередной блок открытого текста зависит только от текущего блока шифртекста
+    и от блока шифртекста (или синхропосылки), отстоящего от него на `z` блоков, где `z` -- число
+    блоков в синхропосылке. Поэтому данные разбиваются на непрерывные фрагменты, длина которых
+    кратна `z` блокам, а в качестве синхропосылки каждого фрагмента используются `z` предшествующих
+    ему блоков шифртекста. Синхропосылки копируются до запуска потоков, что позволяет
+    расшифровывать данные "на месте".
+
+    Последний фрагмент (вместе с неполным блоком) расшифровывается исходным ключом
+    в вызывающем потоке, поэтому значение синхропосылки, сохраняемое в контексте ключа,
+    и перемаскирование ключа совпадают с результатом последовательной функции.                   */
+/* ----------------------------------------------------------------------------------------------- */
+ static int ak_bckey_decrypt_chain_threads( ak_bckey bkey, ak_pointer in, ak_pointer out,
+                            size_t size, ak_pointer iv, size_t iv_size, size_t threads,
+                                                           ak_function_bckey_decrypt_chain *decrypt )
+{
+  size_t i, count = 0, blocks, units, z, offset = 0;
+  ak_bckey_decrypt_piece pieces = NULL;
+  ak_uint8 ivector[64];
+  int error = ak_error_ok;
+
+  if( bkey == NULL ) return ak_error_message( ak_error_null_pointer, __func__,
+                                                        "using null pointer to block cipher key" );
+  if(( bkey->bsize != 8 ) && ( bkey->bsize != 16 ))
+    return ak_error_message( ak_error_wrong_block_cipher,
+                                          __func__ , "incorrect block size of block cipher key" );
+  blocks = size/bkey->bsize;
+  threads = ak_min( ak_bckey_get_threads_count( threads ), blocks/ak_bckey_thread_blocks );
+ /* некорректные значения параметров обрабатываются последовательной функцией */
+  if(( threads < 2 ) || ( iv == NULL ) || ( iv_size < bkey->bsize ) ||
+     ( iv_size%bkey->bsize != 0 ) || ( iv_size > sizeof( bkey->ivector )) ||
+                                                                 !ak_bckey_is_duplicable( bkey ))
+    return decrypt( bkey, in, out, size, iv, iv_size );
+
+ /* проверяем целостность и ресурс ключа до его копирования */
+  if( ak_skey_verify_icode( &bkey->key, blocks ) != ak_true )
+    return ak_error_message( ak_error_wrong_key_icode,
+                                        __func__, "incorrect integrity code of secret key value" );
+  if( bkey->key.resource.value.counter < ( ssize_t )( ak_bckey_size_in_blocks( bkey, size )))
+    return ak_error_message( ak_error_low_key_resource,
+                                                    __func__ , "low resource of block cipher key" );
+
+  if(( pieces = calloc( threads-1, sizeof( struct bckey_decrypt_piece ))) == NULL )
+    return ak_error_message( ak_error_out_of_memory, __func__,
+                                                         "incorrect memory allocation for threads" );
+ /* формируем фрагменты, длина которых кратна длине синхропосылки */
+  z = iv_size/bkey->bsize;
+  units = blocks/z;
+  for( count = 0; count < threads-1; count++ ) {
+     size_t len = z*( units/threads + ( count < units%threads ));
+     ak_bckey_decrypt_piece piece = pieces + count;
+
+     if(( error = ak_bckey_create_and_set_bckey( &piece->key, bkey )) != ak_error_ok ) {
+       ak_error_message( error, __func__, "incorrect key duplication" );
+       goto labex;
+     }
+     if( offset == 0 ) memcpy( piece->iv, iv, iv_size );
+       else memcpy( piece->iv, ( ak_uint8 *)in + ( offset - z )*bkey->bsize, iv_size );
+     piece->iv_size = iv_size;
+     piece->key.key.resource.value.counter = ( ssize_t ) len;
+     piece->in = ( ak_uint8 *)in + offset*bkey->bsize;
+     piece->out = ( ak_uint8 *)out + offset*bkey->bsize;
+     piece->size = len*bkey->bsize;
+     piece->decrypt = decrypt;
+     offset += len;
+  }
+  bkey->key.resource.value.counter -= ( ssize_t ) offset;
+
+ /* запускаем потоки, последний фрагмент обрабатывается исходным ключом в текущем потоке;
+    синхропосылка последнего фрагмента копируется до начала расшифрования */
+  memcpy( ivector, ( ak_uint8 *)in + ( offset - z )*bkey->bsize, iv_size );
+  for( i = 0; i < count; i++ )
+     pieces[i].started = ( pthread_create( &pieces[i].thread, NULL,
+                                                ak_bckey_decrypt_thread, pieces + i ) == 0 );
+  error = decrypt( bkey, ( ak_uint8 *)in + offset*bkey->bsize,
+                                ( ak_uint8 *)out + offset*bkey->bsize, size - offset*bkey->bsize,
+                                                                              ivector, iv_size );
+  for( i = 0; i < count; i++ ) {
+     if( pieces[i].started ) pthread_join( pieces[i].thread, NULL );
+       else ak_bckey_decrypt_thread( pieces + i );
+  }
+  if( error != ak_error_ok ) ak_error_message( error, __func__, "incorrect decryption" );
+  for( i = 0; i < count; i++ )
+     if( pieces[i].error != ak_error_ok ) {
+       ak_error_message( error = pieces[i].error, __func__, "incorrect decryption in thread" );
+       break;
+     }
+
+  labex:
+   for( i = 0; i < count; i++ ) ak_bckey_destroy( &pieces[i].key );
+   free( pieces );
+ return error;
+}
+#endif
+
+/* ----------------------------------------------------------------------------------------------- */
+/*! Функция реализует режим простой замены с зацеплением из ГОСТ Р 34.13-2015 и вырабатывает
+    тот же результат, что и функция ak_bckey_decrypt_cbc(). Данные разбиваются на непрерывные
+    фрагменты, каждый из которых расшифровывается в отдельном потоке с использованием
+    собственной копии ключа; внутри потока блоки расшифровываются группами
+    (см. ak_bckey_decrypt_blocks()).
+
+    Если библиотека собрана без поддержки потоков или объем данных мал, то
+    функция вызывает ak_bckey_decrypt_cbc().
+
+    @param bkey Контекст ключа алгоритма блочного шифрования.
+    @param in Указатель на область памяти, где хранятся зашифрованные данные.
+    @param out Указатель на область памяти, куда помещаются расшифрованные данные
+    (этот указатель может совпадать с `in`).
+    @param size Размер расшифровываемых данных (в байтах), должен быть кратен длине блока.
+    @param iv Указатель на синхропосылку.
+    @param iv_size Длина синхропосылки в байтах, должна быть кратна длине блока.
+    @param threads Количество используемых потоков; нулевое значение означает, что
+    количество потоков совпадает с количеством доступных процессорных ядер.
+
+    @return В случае возникновения ошибки функция возвращает ее код, в противном случае
+    возвращается \ref ak_error_ok (ноль)                                                           */
+/* ----------------------------------------------------------------------------------------------- */
+ int ak_bckey_decrypt_cbc_threads( ak_bckey bkey, ak_pointer in, ak_pointer out, size_t size,
+                                                   ak_pointer iv, size_t iv_size, size_t threads )
+{
+#ifdef AK_HAVE_PTHREAD_H
+  if(( bkey != NULL ) && ( size%bkey->bsize != 0 ))
+    return ak_error_message( ak_error_wrong_block_cipher_length,
+                            __func__ , "the length of input data is not divided by block length" );
+ return ak_bckey_decrypt_chain_threads( bkey, in, out, size, iv, iv_size, threads,
+                                                                           ak_bckey_decrypt_cbc );
+#else
+  (void) threads;
+ return ak_bckey_decrypt_cbc( bkey, in, out, size, iv, iv_size );
+#endif
+}
+
+/* ----------------------------------------------------------------------------------------------- */
+/*! Функция реализует режим гаммирования с обратной связью по шифртексту из ГОСТ Р 34.13-2015
+    и вырабатывает тот же результат, что и функция ak_bckey_decrypt_cfb(). Данные, кратные длине
+    блока, разбиваются на непрерывные фрагменты, каждый из которых расшифровывается в отдельном
+    потоке с использованием собственной копии ключа. Неполный последний блок, а также значение
+    синхропосылки, сохраняемое в контексте ключа, обрабатываются так же, как и в функции
+    ak_bckey_decrypt_cfb().
+
+    Если библиотека собрана без поддержки потоков, объем данных мал или синхропосылка
+    не задана, то функция вызывает ak_bckey_decrypt_cfb().
+
+    @param bkey Контекст ключа алгоритма блочного шифрования.
+    @param in Указатель на область памяти, где хранятся зашифрованные данные.
+    @param out Указатель на область памяти, куда помещаются расшифрованные данные
+    (этот указатель может совпадать с `in`).
+    @param size Размер расшифровываемых данных (в байтах).
+    @param iv Указатель на синхропосылку; может принимать значение NULL.
+    @param iv_size Длина синхропосылки в байтах.
+    @param threads Количество используемых потоков; нулевое значение означает, что
+    количество потоков совпадает с количеством доступных процессорных ядер.
+
+    @return В случае возникновения ошибки функция возвращает ее код, в противном случае
+    возвращается \ref ak_error_ok (ноль)                                                           */
+/* ----------------------------------------------------------------------------------------------- */
+ int ak_bckey_decrypt_cfb_threads( ak_bckey bkey, ak_pointer in, ak_pointer out, size_t size,
+                                                   ak_pointer iv, size_t iv_size, size_t threads )
+{
+#ifdef AK_HAVE_PTHREAD_H
+ return ak_bckey_decrypt_chain_threads( bkey, in, out, size, iv, iv_size, threads,
+                                                                           ak_bckey_decrypt_cfb );
+#else
+  (void) threads;
+ return ak_bckey_decrypt_cfb( bkey, in, out, size, iv, iv_size );
+#endif
+}
+
 /* ----------------------------------------------------------------------------------------------- */
 /*! Функция реализует последовательную комбинацию алгоритма выработки имитовставки HMAC и
     режима гаммирования данных, согласно ГОСТ Р 34.12-2015. В начале
@@ -26,7 +26,7 @@
  int ak_bckey_cmac( ak_bckey bkey, ak_pointer in,
                                           const size_t size, ak_pointer out, const size_t out_size )
 {
-  ak_int64 i = 0, oc = (int) ak_libakrypt_get_option_by_name( "openssl_compability" ),
+  ak_int64 i = 0, oc = bkey->key.options.openssl_compability,
         #ifdef AK_LITTLE_ENDIAN
            one64[2] = { 0x02, 0x00 },
         #else
@@ -44,7 +44,7 @@
   if( !out_size ) return ak_error_message( ak_error_zero_length, __func__,
                                                             "using zero length of result buffer" );
  /* проверяем целостность ключа */
-  if( bkey->key.check_icode( &bkey->key ) != ak_true )
+  if( ak_skey_verify_icode( &bkey->key, ( size_t ) blocks +1 ) != ak_true )
     return ak_error_message( ak_error_wrong_key_icode, __func__,
                                                   "incorrect integrity code of secret key value" );
 
@@ -199,7 +199,7 @@
   if(( size%bkey->bsize ) != 0 ) return ak_error_message( ak_error_wrong_length, __func__,
                                                                 "using a data with wrong length" );
  /* проверяем целостность ключа */
-  if( bkey->key.check_icode( &bkey->key ) != ak_true )
+  if( ak_skey_verify_icode( &bkey->key, size/bkey->bsize ) != ak_true )
     return ak_error_message( ak_error_wrong_key_icode, __func__,
                                                   "incorrect integrity code of secret key value" );
 
@@ -267,7 +267,7 @@
  int ak_bckey_cmac_finalize( ak_bckey bkey, const ak_pointer in, const size_t size,
                                                            ak_pointer out, const size_t out_size )
 {
-  ak_int64 oc = (int) ak_libakrypt_get_option_by_name( "openssl_compability" ),
+  ak_int64 oc = 0,
         #ifdef AK_LITTLE_ENDIAN
            one64[2] = { 0x02, 0x00 };
         #else
@@ -277,6 +277,7 @@
 
   if( bkey == NULL ) return ak_error_message( ak_error_null_pointer, __func__,
                                                         "using null pointer to block cipher key" );
+  oc = bkey->key.options.openssl_compability;
   if( size == 0 ) return ak_error_message( ak_error_zero_length, __func__,
                                                                  "using a data with zero length" );
   if( size > bkey->bsize ) return ak_error_message( ak_error_zero_length, __func__,
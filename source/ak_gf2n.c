@@ -46,6 +46,74 @@
 #endif
 }
 
+/* ----------------------------------------------------------------------------------------------- */
+/*! \brief Таблица приведения для табличного умножения в поле \f$ \mathbb F_{2^{64}}\f$.
+    \details Элемент с индексом \f$ i \f$ содержит остаток от деления многочлена
+    \f$ i(x) \cdot x^{64} \f$ на \f$ f(x) = x^{64} + x^4 + x^3 + x + 1 \f$, то есть
+    произведение \f$ i(x) \cdot (x^4 + x^3 + x + 1) \f$, где степень \f$ i(x) \f$ меньше 4. */
+ static const ak_uint64 gf64_reduction_table[16] = {
+   0x00, 0x1b, 0x36, 0x2d, 0x6c, 0x77, 0x5a, 0x41, 0xd8, 0xc3, 0xee, 0xf5, 0xb4, 0xaf, 0x82, 0x99 };
+
+/* ----------------------------------------------------------------------------------------------- */
+/*! Функция реализует операцию умножения двух элементов конечного поля \f$ \mathbb F_{2^{64}}\f$,
+    порожденного неприводимым многочленом
+    \f$ f(x) = x^{64} + x^4 + x^3 + x + 1 \in \mathbb F_2[x]\f$. Для умножения используется
+    табличная реализация с окном в 4 бита: для первого множителя вычисляется таблица из
+    16 кратных ему элементов, после чего второй множитель обрабатывается по четыре бита,
+    начиная со старших, с использованием постоянной таблицы приведения.
+    Функция используется вместо функции ak_gf64_mul_uint64() при отсутствии команды PCLMULQDQ.    */
+/* ----------------------------------------------------------------------------------------------- */
+ void ak_gf64_mul_table( ak_pointer z, ak_pointer x, ak_pointer y )
+{
+ int i = 0;
+ ak_uint64 table[16], zv = 0,
+#ifdef AK_LITTLE_ENDIAN
+   t = ((ak_uint64 *)y)[0], s = ((ak_uint64 *)x)[0];
+#else
+   t = bswap_64( ((ak_uint64 *)y)[0] ), s = bswap_64( ((ak_uint64 *)x)[0] );
+#endif
+
+ /* вычисляем кратные первого множителя */
+  table[0] = 0; table[1] = s;
+  for( i = 2; i < 16; i += 2 ) {
+     table[i] = ( table[i>>1] << 1 ) ^ gf64_reduction_table[ table[i>>1] >> 63 ];
+     table[i+1] = table[i] ^ s;
+  }
+
+ /* схема Горнера по четырехбитным фрагментам второго множителя */
+  for( i = 60; i >= 0; i -= 4 ) {
+     zv = ( zv << 4 ) ^ gf64_reduction_table[ zv >> 60 ];
+     zv ^= table[ ( t >> i )&0xF ];
+  }
+#ifdef AK_LITTLE_ENDIAN
+ ((ak_uint64 *)z)[0] = zv;
+#else
+ ((ak_uint64 *)z)[0] = bswap_64(zv);
+#endif
+}
+
+/* ----------------------------------------------------------------------------------------------- */
+/*! Функция вычисляет сумму \f$ z = \sum_{i=0}^{count-1} a_i \cdot b_i \f$ попарных произведений
+    элементов конечного поля \f$ \mathbb F_{2^{64}}\f$, последовательно расположенных в памяти.
+    Для умножения используется функция ak_gf64_mul_table().
+
+    @param z Указатель на область памяти, куда помещается результат.
+    @param a Указатель на массив из `count` элементов поля.
+    @param b Указатель на массив из `count` элементов поля.
+    @param count Количество перемножаемых пар.                                                     */
+/* ----------------------------------------------------------------------------------------------- */
+ void ak_gf64_mul_sum_table( ak_pointer z, ak_pointer a, ak_pointer b, const size_t count )
+{
+  size_t i = 0;
+  ak_uint64 t, s = 0;
+
+  for( i = 0; i < count; i++ ) {
+     ak_gf64_mul_table( &t, (ak_uint64 *)a + i, (ak_uint64 *)b + i );
+     s ^= t;
+  }
+  ((ak_uint64 *)z)[0] = s;
+}
+
 /* ----------------------------------------------------------------------------------------------- */
 /*! Функция реализует операцию умножения двух элементов конечного поля \f$ \mathbb F_{2^{128}}\f$,
     порожденного неприводимым многочленом
@@ -101,6 +169,28 @@
 #endif
 }
 
+/* ----------------------------------------------------------------------------------------------- */
+/*! Функция вычисляет сумму \f$ z = \sum_{i=0}^{count-1} a_i \cdot b_i \f$ попарных произведений
+    элементов конечного поля \f$ \mathbb F_{2^{128}}\f$, последовательно расположенных в памяти.
+
+    @param z Указатель на область памяти, куда помещается результат.
+    @param a Указатель на массив из `count` элементов поля.
+    @param b Указатель на массив из `count` элементов поля.
+    @param count Количество перемножаемых пар.                                                     */
+/* ----------------------------------------------------------------------------------------------- */
+ void ak_gf128_mul_sum_uint64( ak_pointer z, ak_pointer a, ak_pointer b, const size_t count )
+{
+  size_t i = 0;
+  ak_uint64 t[2], s[2] = { 0, 0 };
+
+  for( i = 0; i < count; i++ ) {
+     ak_gf128_mul_uint64( t, (ak_uint64 *)a + ( i << 1 ), (ak_uint64 *)b + ( i << 1 ));
+     s[0] ^= t[0]; s[1] ^= t[1];
+  }
+  ((ak_uint64 *)z)[0] = s[0];
+  ((ak_uint64 *)z)[1] = s[1];
+}
+
 /* ----------------------------------------------------------------------------------------------- */
 /*! Функция реализует операцию умножения двух элементов конечного поля \f$ \mathbb F_{2^{256}}\f$,
     порожденного неприводимым многочленом
@@ -322,6 +412,46 @@
  #endif
 }
 
+/* ----------------------------------------------------------------------------------------------- */
+/*! Функция вычисляет сумму \f$ z = \sum_{i=0}^{count-1} a_i \cdot b_i \f$ попарных произведений
+    элементов конечного поля \f$ \mathbb F_{2^{64}}\f$ с помощью команды PCLMULQDQ.
+    Произведения суммируются как 128-ми битные значения, приведение выполняется один раз
+    (см. также ak_gf128_mul_sum_pcmulqdq()).
+
+    @param z Указатель на область памяти, куда помещается результат.
+    @param a Указатель на массив из `count` элементов поля.
+    @param b Указатель на массив из `count` элементов поля.
+    @param count Количество перемножаемых пар.                                                     */
+/* ----------------------------------------------------------------------------------------------- */
+ void ak_gf64_mul_sum_pcmulqdq( ak_pointer z, ak_pointer a, ak_pointer b, const size_t count )
+{
+  size_t i = 0;
+  ak_uint64 c[2], h[2];
+  const __m128i gm = _mm_set_epi64x( 0, 0x1B );
+  __m128i am, bm, cm = _mm_setzero_si128(), xm;
+
+ /* умножение и накопление без приведения; пары обрабатываются по две */
+  for( ; i+1 < count; i += 2 ) {
+     am = _mm_loadu_si128( (__m128i *)((ak_uint64 *)a + i ));
+     bm = _mm_loadu_si128( (__m128i *)((ak_uint64 *)b + i ));
+     cm = _mm_xor_si128( cm, _mm_xor_si128( _mm_clmulepi64_si128( am, bm, 0x00 ),
+                                                        _mm_clmulepi64_si128( am, bm, 0x11 )));
+  }
+  if( i < count ) {
+    am = _mm_loadl_epi64( (__m128i *)((ak_uint64 *)a + i ));
+    bm = _mm_loadl_epi64( (__m128i *)((ak_uint64 *)b + i ));
+    cm = _mm_xor_si128( cm, _mm_clmulepi64_si128( am, bm, 0x00 ));
+  }
+  _mm_storeu_si128( (__m128i *)c, cm );
+
+ /* однократное приведение: старшая половина умножается на x^4 + x^3 + x + 1,
+    оставшиеся четыре старших бита приводятся по таблице */
+  xm = _mm_clmulepi64_si128( _mm_set_epi64x( 0, c[1] ), gm, 0x00 );
+  _mm_storeu_si128( (__m128i *)h, xm );
+
+  ((ak_uint64 *)z)[0] = c[0] ^ h[0] ^ gf64_reduction_table[h[1]];
+}
+
 /* ----------------------------------------------------------------------------------------------- */
 /*! Функция реализует операцию умножения двух элементов конечного поля \f$ \mathbb F_{2^{128}}\f$,
     порожденного неприводимым многочленом
@@ -374,6 +504,47 @@
 #endif
 }
 
+/* ----------------------------------------------------------------------------------------------- */
+/*! Функция вычисляет сумму \f$ z = \sum_{i=0}^{count-1} a_i \cdot b_i \f$ попарных произведений
+    элементов конечного поля \f$ \mathbb F_{2^{128}}\f$ с помощью команды PCLMULQDQ.
+
+    Поскольку приведение по модулю многочлена \f$ f(x) \f$ является линейной операцией,
+    произведения суммируются без приведения (как 256-ти битные значения), а приведение
+    выполняется один раз для всей суммы. Аналогичный прием используется при вычислении GHASH.
+
+    @param z Указатель на область памяти, куда помещается результат.
+    @param a Указатель на массив из `count` элементов поля.
+    @param b Указатель на массив из `count` элементов поля.
+    @param count Количество перемножаемых пар.                                                     */
+/* ----------------------------------------------------------------------------------------------- */
+ void ak_gf128_mul_sum_pcmulqdq( ak_pointer z, ak_pointer a, ak_pointer b, const size_t count )
+{
+  size_t i = 0;
+  ak_uint64 c[2], d[2], e[2], x3, D;
+  __m128i am, bm, cm = _mm_setzero_si128(), dm = _mm_setzero_si128(), em = _mm_setzero_si128();
+
+ /* умножение и накопление без приведения */
+  for( i = 0; i < count; i++ ) {
+     am = _mm_loadu_si128( (__m128i *)a + i );
+     bm = _mm_loadu_si128( (__m128i *)b + i );
+     cm = _mm_xor_si128( cm, _mm_clmulepi64_si128( am, bm, 0x00 )); /* a0*b0 */
+     dm = _mm_xor_si128( dm, _mm_clmulepi64_si128( am, bm, 0x11 )); /* a1*b1 */
+     em = _mm_xor_si128( em, _mm_xor_si128( _mm_clmulepi64_si128( am, bm, 0x10 ),
+                                            _mm_clmulepi64_si128( am, bm, 0x01 ))); /* a0*b1 + a1*b0 */
+  }
+  _mm_storeu_si128( (__m128i *)c, cm );
+  _mm_storeu_si128( (__m128i *)d, dm );
+  _mm_storeu_si128( (__m128i *)e, em );
+
+ /* однократное приведение */
+  x3 = d[1];
+  D = d[0] ^ e[1] ^ (x3 >> 63) ^ (x3 >> 62) ^ (x3 >> 57);
+
+  ((ak_uint64 *)z)[0] = c[0] ^ D ^ (D << 1) ^ (D << 2) ^ (D << 7);
+  ((ak_uint64 *)z)[1] = c[1] ^ e[0] ^ x3 ^ (x3 << 1) ^ (D >> 63) ^ (x3 << 2) ^ (D >> 62) ^
+                                                                           (x3 << 7) ^ (D >> 57);
+}
+
 /* ----------------------------------------------------------------------------------------------- */
 /*! Функция реализует операцию умножения двух элементов конечного поля \f$ \mathbb F_{2^{256}}\f$,
     порожденного неприводимым многочленом
@@ -840,6 +1011,23 @@ void ak_gf512_mul_pcmulqdq( ak_pointer z, ak_pointer a, ak_pointer b )
     x = y; y = z;
   }
 
+ /* сравнение табличной реализации с контрольными примерами */
+#ifdef AK_LITTLE_ENDIAN
+  y = 0xF000000000000011LL; x = 0x00001aaabcda1115LL;
+#else
+  y = 0x11000000000000F0LL; x = 0x1511dabcaa1a0000LL;
+#endif
+ for( i = 0; i < 8; i++ ) {
+    ak_gf64_mul_table( &z, &x, &y );
+    if( z != values[i] ) {
+      ak_error_message_fmt( ak_error_not_equal_data, __func__ ,
+                                         "table calculated %s on iteration %d",
+                                                           ak_ptr_to_hexstr( &z, 8, ak_true ), i );
+      return ak_false;
+    }
+    x = y; y = z;
+ }
+
 #ifdef AK_HAVE_BUILTIN_CLMULEPI64
  if( ak_log_get_level() >= ak_log_maximum )
    ak_error_message( ak_error_ok, __func__, "comparison between two implementations included");
@@ -876,6 +1064,17 @@ void ak_gf512_mul_pcmulqdq( ak_pointer z, ak_pointer a, ak_pointer b )
   }
  if( ak_log_get_level() >= ak_log_maximum )
    ak_error_message( ak_error_ok, __func__, "one thousand iterations for random values is Ok");
+
+ /* сравнение способов вычисления суммы попарных произведений */
+ for( i = 1; i <= 8; i++ ) {
+    ak_gf64_mul_sum_table( &z, values, values +( 8 - i ), (size_t) i );
+    ak_gf64_mul_sum_pcmulqdq( &z1, values, values +( 8 - i ), (size_t) i );
+    if( z != z1 ) {
+      ak_error_message_fmt( ak_error_not_equal_data, __func__ ,
+                  "sum of products with pcmulqdq differs from table method for %d pairs", i );
+      return ak_false;
+    }
+ }
 #endif
  return ak_true;
 }
@@ -892,6 +1091,9 @@ void ak_gf512_mul_pcmulqdq( ak_pointer z, ak_pointer a, ak_pointer b )
  ak_uint8 m8[16] = {
       0xd2, 0x06, 0x35, 0x32, 0xda, 0x10, 0x4e, 0x7e, 0x2e, 0xd1, 0x5e, 0x9a, 0xa0, 0x29, 0x02, 0x04 };
  ak_uint8 result[16], result2[16];
+#ifdef AK_HAVE_BUILTIN_CLMULEPI64
+ ak_uint128 x[8], y[8];
+#endif
 
  ak_uint128 a, b, m;
 #ifdef AK_LITTLE_ENDIAN
@@ -962,6 +1164,23 @@ void ak_gf512_mul_pcmulqdq( ak_pointer z, ak_pointer a, ak_pointer b )
  }
  if( ak_log_get_level() >= ak_log_maximum )
    ak_error_message( ak_error_ok, __func__, "one thousand iterations for random values is Ok");
+
+ /* сравнение для двух способов вычисления суммы попарных произведений */
+ for( i = 0; i < 8; i++ ) {
+   a.q[0] = b.q[1]; a.q[1] = b.q[0];
+   memcpy( b.b, result, 16 );
+   ak_gf128_mul_uint64( result, &a, &b );
+   x[i] = a; y[i] = b;
+ }
+ for( i = 1; i <= 8; i++ ) {
+   ak_gf128_mul_sum_uint64( result, x, y, (size_t) i );
+   ak_gf128_mul_sum_pcmulqdq( result2, x, y, (size_t) i );
+   if( !ak_ptr_is_equal_with_log( result, result2, 16 )) {
+     ak_error_message_fmt( ak_error_ok, __func__,
+                  "sum of products with pcmulqdq differs from standard method for %d pairs", i );
+     goto lexit;
+   }
+ }
 #endif
 
  return ak_true;
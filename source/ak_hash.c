@@ -3,6 +3,11 @@
 /*                                                                                                 */
 /*  Файл ak_hash.c                                                                                 */
 /*  - содержит реализацию алгоритмов итерационного сжатия                                          */
+/* ----------------------------------------------------------------------------------------------- */
+#ifdef AK_HAVE_PTHREAD_H
+ #include <pthread.h>
+#endif
+
 /* ----------------------------------------------------------------------------------------------- */
  #include <libakrypt-internal.h>
 
@@ -1136,7 +1141,13 @@
 /*                            Реализация функции хеширования Стрибог                               */
 /* ----------------------------------------------------------------------------------------------- */
 /*! \brief Преобразование LPS.
-    \note Мы предполагаем, что данные содержат 64 байта.                                           */
+    \note Мы предполагаем, что данные содержат 64 байта.
+
+    Преобразование выполняется с помощью 64-х выборок из таблиц, объединяющих
+    преобразования S, P и L; скорость вычисления функции сжатия ограничивается количеством
+    операций чтения из памяти, выполняемых процессором за такт. Реализации, использующие
+    команды gather (AVX2, AVX-512) или вычисление двух преобразований LPS в одном цикле,
+    выполняют те же 64 выборки и не дают выигрыша, поэтому здесь не используются.                */
 /* ----------------------------------------------------------------------------------------------- */
  static inline void ak_hash_context_streebog_lps( ak_uint64 *result, const ak_uint64 *data )
 {
@@ -1165,6 +1176,15 @@
 }
 
 
+/* ----------------------------------------------------------------------------------------------- */
+/*! \brief Итерационные ключи K1, ..., K13 первого вызова функции сжатия для Стрибог256.
+    \details При первом вызове функции сжатия значения h и N равны начальным значениям,
+    поэтому все итерационные ключи не зависят от сжимаемых данных и вычисляются один раз
+    при инициализации библиотеки функцией ak_hash_streebog_init_tables().                          */
+ static ak_uint64 streebog256_first_keys[13][8];
+/*! \brief Итерационные ключи K1, ..., K13 первого вызова функции сжатия для Стрибог512. */
+ static ak_uint64 streebog512_first_keys[13][8];
+
 /* ----------------------------------------------------------------------------------------------- */
 /*! \brief Преобразование G
     \note Мы предполагаем, что массивы n и m содержат по 64 байта.                                 */
@@ -1174,6 +1194,20 @@
    int idx = 0;
    ak_uint64 K[8], T[8], B[8];
 
+      /* первый вызов функции сжатия (h и N имеют начальные значения):
+                                      используем заранее вычисленные итерационные ключи */
+       if(( n != NULL ) && ( n[0] == 0 ) && ( n[1] == 0 )) {
+         ak_uint64 (*keys)[8] = ( ctx->hsize == 32 ) ? streebog256_first_keys :
+                                                                         streebog512_first_keys;
+         ak_hash_context_streebog_x( B, keys[0], m );
+         for( idx = 1; idx < 13; idx++ ) {
+            ak_hash_context_streebog_lps( T, B );
+            ak_hash_context_streebog_x( B, T, keys[idx] );
+         }
+         for ( idx = 0; idx < 8; idx++ ) ctx->h[idx] ^= B[idx] ^ m[idx];
+         return;
+       }
+
        if( n != NULL ) {
          ak_hash_context_streebog_x( B, ctx->h, n );
          ak_hash_context_streebog_lps( K, B );
@@ -1195,6 +1229,33 @@
        for ( idx = 0; idx < 8; idx++ ) ctx->h[idx] ^= T[idx] ^ K[idx] ^ m[idx];
 }
 
+/* ----------------------------------------------------------------------------------------------- */
+/*! \brief Функция вычисляет итерационные ключи первого вызова функции сжатия.
+    \details Ключ K1 равен LPS( h ), где h - начальное значение функции хеширования,
+    последующие ключи вычисляются по правилу \f$ K_{i+1} = LPS( K_i \oplus C_i ) \f$.
+
+    @return Функция возвращает \ref ak_error_ok.                                                   */
+/* ----------------------------------------------------------------------------------------------- */
+ int ak_hash_streebog_init_tables( void )
+{
+  int idx = 0;
+  ak_uint64 iv[8], B[8];
+
+  memset( iv, 1, sizeof( iv ));
+  ak_hash_context_streebog_lps( streebog256_first_keys[0], iv );
+  memset( iv, 0, sizeof( iv ));
+  ak_hash_context_streebog_lps( streebog512_first_keys[0], iv );
+
+  for( idx = 0; idx < 12; idx++ ) {
+     ak_hash_context_streebog_x( B, streebog256_first_keys[idx], streebog_c[idx] );
+     ak_hash_context_streebog_lps( streebog256_first_keys[idx+1], B );
+     ak_hash_context_streebog_x( B, streebog512_first_keys[idx], streebog_c[idx] );
+     ak_hash_context_streebog_lps( streebog512_first_keys[idx+1], B );
+  }
+
+ return ak_error_ok;
+}
+
 /* ----------------------------------------------------------------------------------------------- */
 /*! \brief Преобразование Add (увеличение счетчика длины обработаного сообщения).                  */
 /* ----------------------------------------------------------------------------------------------- */
@@ -1263,14 +1324,28 @@
 /* ----------------------------------------------------------------------------------------------- */
  static int ak_hash_context_streebog_update( ak_pointer sctx, const ak_pointer in, const size_t size )
 {
+  ak_uint64 m[8];
   ak_streebog cx = ( ak_streebog ) sctx;
   ak_uint64 quot = size >> 6, *dt = ( ak_uint64 *) in;
+  const ak_uint8 *ptr = ( const ak_uint8 *) in;
 
   if( cx == NULL ) return ak_error_message( ak_error_null_pointer, __func__,
                                                "using null pointer to internal streebog context" );
   if(( !size ) || ( in == NULL )) return ak_error_ok;
   if(( size - ( quot << 6 )) != 0 ) return ak_error_message( ak_error_wrong_length, __func__,
                                       "data length is not a multiple of the length of the block" );
+ /* данные, не выровненные на границу 64-х битного слова, копируются поблочно */
+  if((( size_t ) in )&0x7 ) {
+    do{
+        memcpy( m, ptr, 64 );
+        ak_hash_context_streebog_g( cx, cx->n, m );
+        ak_hash_context_streebog_add( cx, 512 );
+        ak_hash_context_streebog_sadd( cx, m );
+        quot--; ptr += 64;
+    } while( quot > 0 );
+    return ak_error_ok;
+  }
+
   do{
       ak_hash_context_streebog_g( cx, cx->n, dt );
       ak_hash_context_streebog_add( cx, 512 );
@@ -1318,6 +1393,254 @@
  return result;
 }
 
+/* ----------------------------------------------------------------------------------------------- */
+/*                         Реализация древовидного режима хеширования                              */
+/* ----------------------------------------------------------------------------------------------- */
+/*! \brief Метка, дописываемая к данным каждого листа. */
+ #define ak_streebog_tree_leaf_label       (0x00)
+/*! \brief Метка, дописываемая к данным, хешируемым в корне дерева. */
+ #define ak_streebog_tree_root_label       (0x01)
+/*! \brief Максимальное количество листьев, обрабатываемых параллельно за один раз. */
+ #define ak_streebog_tree_batch_leaves     (ak_bckey_max_threads)
+
+/* ----------------------------------------------------------------------------------------------- */
+/*! \brief Функция дописывает к данным метку и вычисляет хеш-код.
+    \details Длина данных `size` должна быть меньше 64 октетов. Контекст `cx` не изменяется.       */
+/* ----------------------------------------------------------------------------------------------- */
+ static int ak_hash_context_streebog_tree_close( ak_streebog cx, const ak_uint8 *in,
+                                                 size_t size, const ak_uint8 label, ak_uint8 *out )
+{
+  ak_uint64 m[8];
+  int error = ak_error_ok;
+  struct streebog sx;
+
+  memcpy( &sx, cx, sizeof( struct streebog ));
+  if( size ) memcpy( m, in, size );
+  (( ak_uint8 *)m )[size++] = label;
+  if( size == 64 ) {
+    if(( error = ak_hash_context_streebog_update( &sx, m, 64 )) != ak_error_ok ) return error;
+    size = 0;
+  }
+ return ak_hash_context_streebog_finalize( &sx, m, size, out, sx.hsize );
+}
+
+/* ----------------------------------------------------------------------------------------------- */
+/*! \brief Функция передает хеш-коды листьев (или завершающие данные) в контекст корня дерева. */
+/* ----------------------------------------------------------------------------------------------- */
+ static int ak_hash_context_streebog_tree_absorb( ak_streebog_tree tx,
+                                                              const ak_uint8 *in, size_t size )
+{
+  size_t len = 0;
+  int error = ak_error_ok;
+
+  while( size > 0 ) {
+    len = ak_min( 64 - tx->length, size );
+    memcpy( tx->buffer + tx->length, in, len );
+    in += len; size -= len;
+    if(( tx->length += len ) == 64 ) {
+      if(( error = ak_hash_context_streebog_update( &tx->root, tx->buffer, 64 )) != ak_error_ok )
+        return error;
+      tx->length = 0;
+    }
+  }
+ return ak_error_ok;
+}
+
+/* ----------------------------------------------------------------------------------------------- */
+/*! \brief Функция вычисляет хеш-коды последовательности полных листьев. */
+/* ----------------------------------------------------------------------------------------------- */
+ static int ak_hash_context_streebog_tree_leaves( const size_t hsize,
+                                            const ak_uint8 *in, size_t count, ak_uint8 *out )
+{
+  struct streebog sx;
+  int error = ak_error_ok;
+
+  sx.hsize = hsize;
+  for( ; count > 0; count--, in += ak_streebog_tree_leaf_size, out += hsize ) {
+     ak_hash_context_streebog_clean( &sx );
+     if(( error = ak_hash_context_streebog_update( &sx,
+                           ( ak_pointer )in, ak_streebog_tree_leaf_size )) != ak_error_ok ) break;
+     if(( error = ak_hash_context_streebog_tree_close( &sx,
+                                 NULL, 0, ak_streebog_tree_leaf_label, out )) != ak_error_ok ) break;
+  }
+ return error;
+}
+
+#ifdef AK_HAVE_PTHREAD_H
+/* ----------------------------------------------------------------------------------------------- */
+/*! \brief Последовательность листьев, обрабатываемая одним потоком. */
+ typedef struct streebog_tree_piece {
+  /*! \brief Указатель на данные первого листа. */
+   const ak_uint8 *in;
+  /*! \brief Указатель на область памяти для хеш-кодов листьев. */
+   ak_uint8 *out;
+  /*! \brief Количество листьев. */
+   size_t count;
+  /*! \brief Длина хеш-кода (в октетах). */
+   size_t hsize;
+  /*! \brief Код ошибки, возвращенный при обработке листьев. */
+   int error;
+  /*! \brief Дескриптор потока. */
+   pthread_t thread;
+  /*! \brief Флаг того, что поток был успешно создан. */
+   bool_t started;
+ } *ak_streebog_tree_piece;
+
+/* ----------------------------------------------------------------------------------------------- */
+/*! \brief Функция потока, вычисляющая хеш-коды последовательности листьев. */
+ static void *ak_hash_context_streebog_tree_thread( void *ptr )
+{
+  ak_streebog_tree_piece piece = ( ak_streebog_tree_piece ) ptr;
+  piece->error = ak_hash_context_streebog_tree_leaves( piece->hsize,
+                                                            piece->in, piece->count, piece->out );
+ return NULL;
+}
+#endif
+
+/* ----------------------------------------------------------------------------------------------- */
+/*! \brief Функция вычисляет хеш-коды не более чем \ref ak_streebog_tree_batch_leaves полных
+    листьев, распределяя их между потоками, и передает результаты в контекст корня дерева
+    в порядке следования листьев.                                                                  */
+/* ----------------------------------------------------------------------------------------------- */
+ static int ak_hash_context_streebog_tree_batch( ak_streebog_tree tx,
+                                                             const ak_uint8 *in, size_t count )
+{
+  int error = ak_error_ok;
+  size_t hsize = tx->leaf.hsize;
+  ak_uint8 digests[ ak_streebog_tree_batch_leaves*64 ];
+ #ifdef AK_HAVE_PTHREAD_H
+  size_t i, offset = 0, threads = ak_min( tx->threads, count );
+  struct streebog_tree_piece pieces[ ak_streebog_tree_batch_leaves ];
+
+  if( threads > 1 ) {
+    for( i = 0; i < threads; i++ ) {
+       pieces[i].count = count/threads + ( i < count%threads );
+       pieces[i].in = in + offset*ak_streebog_tree_leaf_size;
+       pieces[i].out = digests + offset*hsize;
+       pieces[i].hsize = hsize;
+       pieces[i].error = ak_error_ok;
+       offset += pieces[i].count;
+    }
+   /* первая последовательность листьев, а также последовательности,
+                                для которых не удалось создать поток, обрабатываются здесь */
+    for( i = 1; i < threads; i++ )
+       pieces[i].started = ( pthread_create( &pieces[i].thread, NULL,
+                                          ak_hash_context_streebog_tree_thread, pieces + i ) == 0 );
+    ak_hash_context_streebog_tree_thread( pieces );
+    for( i = 1; i < threads; i++ ) {
+       if( pieces[i].started ) pthread_join( pieces[i].thread, NULL );
+         else ak_hash_context_streebog_tree_thread( pieces + i );
+    }
+    for( i = 0; i < threads; i++ )
+       if(( error = pieces[i].error ) != ak_error_ok ) return error;
+  } else
+ #endif
+    if(( error = ak_hash_context_streebog_tree_leaves( hsize,
+                                                          in, count, digests )) != ak_error_ok )
+      return error;
+
+ return ak_hash_context_streebog_tree_absorb( tx, digests, count*hsize );
+}
+
+/* ----------------------------------------------------------------------------------------------- */
+ static int ak_hash_context_streebog_tree_clean( ak_pointer sctx )
+{
+  ak_streebog_tree tx = ( ak_streebog_tree ) sctx;
+  if( tx == NULL ) return ak_error_null_pointer;
+
+  ak_hash_context_streebog_clean( &tx->leaf );
+  ak_hash_context_streebog_clean( &tx->root );
+  memset( tx->buffer, 0, sizeof( tx->buffer ));
+  tx->filled = tx->length = 0;
+  tx->total = 0;
+
+ return ak_error_ok;
+}
+
+/* ----------------------------------------------------------------------------------------------- */
+ static int ak_hash_context_streebog_tree_update( ak_pointer sctx,
+                                                          const ak_pointer in, const size_t size )
+{
+  size_t len = 0, rest = size;
+  int error = ak_error_ok;
+  ak_uint8 digest[64];
+  const ak_uint8 *ptr = ( const ak_uint8 *) in;
+  ak_streebog_tree tx = ( ak_streebog_tree ) sctx;
+
+  if( tx == NULL ) return ak_error_message( ak_error_null_pointer, __func__,
+                                          "using null pointer to internal streebog tree context" );
+  if(( !size ) || ( in == NULL )) return ak_error_ok;
+  if( size&0x3f ) return ak_error_message( ak_error_wrong_length, __func__,
+                                      "data length is not a multiple of the length of the block" );
+  while( rest > 0 ) {
+   /* полные листья, начинающиеся с текущей позиции, обрабатываются параллельно */
+    if(( tx->filled == 0 ) && ( rest >= ak_streebog_tree_leaf_size )) {
+      len = ak_min( rest/ak_streebog_tree_leaf_size, ak_streebog_tree_batch_leaves );
+      if(( error = ak_hash_context_streebog_tree_batch( tx, ptr, len )) != ak_error_ok )
+        return ak_error_message( error, __func__, "incorrect hashing of leaves" );
+      len *= ak_streebog_tree_leaf_size;
+    } else {
+       len = ak_min( ak_streebog_tree_leaf_size - tx->filled, rest );
+       if(( error = ak_hash_context_streebog_update( &tx->leaf,
+                                                  ( ak_pointer )ptr, len )) != ak_error_ok )
+         return ak_error_message( error, __func__, "incorrect updating of leaf context" );
+       if(( tx->filled += len ) == ak_streebog_tree_leaf_size ) {
+         if((( error = ak_hash_context_streebog_tree_close( &tx->leaf,
+                           NULL, 0, ak_streebog_tree_leaf_label, digest )) != ak_error_ok ) ||
+            (( error = ak_hash_context_streebog_tree_absorb( tx,
+                                                  digest, tx->leaf.hsize )) != ak_error_ok ))
+           return ak_error_message( error, __func__, "incorrect closing of leaf" );
+         ak_hash_context_streebog_clean( &tx->leaf );
+         tx->filled = 0;
+       }
+    }
+    ptr += len; rest -= len;
+    tx->total += len;
+  }
+
+ return ak_error_ok;
+}
+
+/* ----------------------------------------------------------------------------------------------- */
+ static int ak_hash_context_streebog_tree_finalize( ak_pointer sctx,
+                   const ak_pointer in, const size_t size, ak_pointer out, const size_t out_size )
+{
+  int i = 0;
+  ak_uint8 digest[64], total[8];
+  int error = ak_error_ok;
+  struct streebog_tree tx; /* структура для хранения копии текущего состояния контекста */
+
+  if( sctx == NULL ) return ak_error_message( ak_error_null_pointer, __func__,
+                                          "using null pointer to internal streebog tree context" );
+  if( out == NULL ) return ak_error_message( ak_error_null_pointer, __func__,
+                                                   "using null pointer to externl result buffer" );
+  if( size >= 64 ) return ak_error_message( ak_error_wrong_length, __func__,
+                                                                      "input length is too huge" );
+  if(( in == NULL ) && ( size > 0 )) return ak_error_message( ak_error_null_pointer, __func__,
+                                                              "using null pointer to input data" );
+ /* при финализации мы изменяем копию существующей структуры */
+  memcpy( &tx, sctx, sizeof( struct streebog_tree ));
+
+ /* завершаем последний (неполный или пустой) лист */
+  if(( tx.filled > 0 ) || ( size > 0 ) || ( tx.total == 0 )) {
+    if((( error = ak_hash_context_streebog_tree_close( &tx.leaf,
+                              in, size, ak_streebog_tree_leaf_label, digest )) != ak_error_ok ) ||
+       (( error = ak_hash_context_streebog_tree_absorb( &tx,
+                                                      digest, tx.leaf.hsize )) != ak_error_ok ))
+      return ak_error_message( error, __func__, "incorrect closing of last leaf" );
+    tx.total += size;
+  }
+ /* дописываем длину сообщения и вычисляем хеш-код корня */
+  for( i = 0; i < 8; i++ ) total[i] = ( ak_uint8 )( tx.total >> ( i << 3 ));
+  if((( error = ak_hash_context_streebog_tree_absorb( &tx, total, 8 )) != ak_error_ok ) ||
+     (( error = ak_hash_context_streebog_tree_close( &tx.root,
+                     tx.buffer, tx.length, ak_streebog_tree_root_label, digest )) != ak_error_ok ))
+    return ak_error_message( error, __func__, "incorrect closing of tree root" );
+
+  memcpy( out, digest, ak_min( tx.root.hsize, out_size ));
+ return error;
+}
+
 /* ----------------------------------------------------------------------------------------------- */
 /*                               Реализация функция класса hash                                    */
 /* ----------------------------------------------------------------------------------------------- */
@@ -1370,6 +1693,86 @@
   return ak_hash_context_streebog_clean( &hctx->data.sctx );
 }
 
+/* ----------------------------------------------------------------------------------------------- */
+/*! \brief Функция инициализирует контекст древовидного режима хеширования. */
+/* ----------------------------------------------------------------------------------------------- */
+ static int ak_hash_create_streebog_tree( ak_hash hctx, const char *name, const size_t hsize )
+{
+  int error = ak_error_ok;
+  ak_streebog_tree tx = NULL;
+
+  if( hctx == NULL ) return ak_error_message( ak_error_null_pointer, __func__,
+                                                            "using null pointer to hash context" );
+  if(( hctx->oid = ak_oid_find_by_name( name )) == NULL )
+    return ak_error_message_fmt( ak_error_wrong_oid, __func__,
+                                                "incorrect internal search of %s identifier", name );
+ /* структура древовидного режима превышает размер объединения data, поэтому память
+    под нее выделяется отдельно и освобождается функцией ak_hash_destroy() */
+  if(( tx = malloc( sizeof( struct streebog_tree ))) == NULL )
+    return ak_error_message( ak_error_out_of_memory, __func__,
+                                               "incorrect memory allocation for tree hash context" );
+  tx->leaf.hsize = tx->root.hsize = hsize;
+  tx->threads = ak_bckey_get_threads_count( 0 );
+  if(( error = ak_mac_create( &hctx->mctx, 64, tx,
+                                        ak_hash_context_streebog_tree_clean,
+                                        ak_hash_context_streebog_tree_update,
+                                        ak_hash_context_streebog_tree_finalize )) != ak_error_ok ) {
+    free( tx );
+    return ak_error_message( error, __func__, "incorrect initialization of internal mac context" );
+  }
+  hctx->data.tctx = tx;
+
+  return ak_hash_context_streebog_tree_clean( tx );
+}
+
+/* ----------------------------------------------------------------------------------------------- */
+/*! Функция инициализирует контекст древовидного режима хеширования, построенного на основе
+    функции Стрибог256 (OID `1.2.643.2.52.1.8.1`, имя `streebog256-tree`).
+    Результат древовидного режима отличается от результата функции Стрибог256 и
+    предназначен для контроля целостности больших объемов данных (образов дисков, архивов),
+    хеширование которых может быть выполнено одновременно на всех процессорных ядрах.
+
+    Хеш-код вычисляется следующим образом. Пусть \f$ H \f$ функция хеширования Стрибог
+    с длиной хеш-кода \f$ n \f$ октетов, \f$ L = 2^{20} \f$ октетов
+    (значение \ref ak_streebog_tree_leaf_size).
+     - Сообщение \f$ M \f$ разбивается на последовательные листья \f$ M_0, \ldots, M_{k-1} \f$
+     длины \f$ L \f$ октетов; длина последнего листа может быть меньше \f$ L \f$, но больше нуля.
+     Пустое сообщение состоит из одного пустого листа, т.е. \f$ k = 1 \f$.
+     - Для каждого листа вычисляется значение \f$ h_i = H( M_i \| 00 ) \f$ длины \f$ n \f$ октетов.
+     - Результатом является значение
+       \f$ H( h_0 \| \ldots \| h_{k-1} \| \mbox{len}(M) \| 01 ) \f$, где
+       \f$ \mbox{len}(M) \f$ длина сообщения в октетах, записанная в виде
+       восьми октетов в порядке little-endian.
+
+    Конкатенация \f$ \| \f$ выполняется над последовательностями октетов, хеш-коды записываются
+    в том порядке, в котором они возвращаются функцией ak_hash_ptr().
+    Хеш-коды полных листьев вычисляются параллельно; количество потоков определяется количеством
+    процессорных ядер и может быть изменено с помощью поля `data.tctx->threads` контекста.
+    Результат не зависит от количества потоков и от того, какими фрагментами данные
+    передаются функции ak_hash_update(). Для файлов функция ak_hash_file() считывает данные
+    фрагментами, содержащими по одному листу на каждый поток.
+
+    @param hctx Контекст функции хеширования
+    @return Функция возвращает код ошибки или \ref ak_error_ok (в случае успеха)                   */
+/* ----------------------------------------------------------------------------------------------- */
+ int ak_hash_create_streebog256_tree( ak_hash hctx )
+{
+ return ak_hash_create_streebog_tree( hctx, "streebog256-tree", 32 );
+}
+
+/* ----------------------------------------------------------------------------------------------- */
+/*! Функция инициализирует контекст древовидного режима хеширования, построенного на основе
+    функции Стрибог512 (OID `1.2.643.2.52.1.8.2`, имя `streebog512-tree`). Формат вычисляемого
+    значения описан в документации к функции ak_hash_create_streebog256_tree().
+
+    @param hctx Контекст функции хеширования
+    @return Функция возвращает код ошибки или \ref ak_error_ok (в случае успеха)                   */
+/* ----------------------------------------------------------------------------------------------- */
+ int ak_hash_create_streebog512_tree( ak_hash hctx )
+{
+ return ak_hash_create_streebog_tree( hctx, "streebog512-tree", 64 );
+}
+
 /* ----------------------------------------------------------------------------------------------- */
 /*! @param hctx Контекст функции хеширования
     @param oid OID алгоритма бесключевого хеширования.
@@ -1415,7 +1818,11 @@
   if( hctx == NULL ) return ak_error_message( ak_error_null_pointer, __func__,
                                                        "destroying null pointer to hash context" );
   hctx->oid = NULL;
-  memset( &hctx->data.sctx, 0, sizeof( struct streebog ));
+  if(( hctx->mctx.clean == ak_hash_context_streebog_tree_clean ) && ( hctx->data.tctx != NULL )) {
+    memset( hctx->data.tctx, 0, sizeof( struct streebog_tree ));
+    free( hctx->data.tctx );
+  }
+  memset( &hctx->data, 0, sizeof( hctx->data ));
   if( ak_mac_destroy( &hctx->mctx ) != ak_error_ok )
     ak_error_message( ak_error_get_value(), __func__,
                                                     "incorrect cleaning of internal mac context" );
@@ -1433,7 +1840,8 @@
     ak_error_message( ak_error_null_pointer, __func__, "using null pointer to hash context" );
     return 0;
   }
-
+  if( hctx->mctx.clean == ak_hash_context_streebog_tree_clean )
+    return hctx->data.tctx->root.hsize;
  return hctx->data.sctx.hsize;
 }
 
@@ -1476,6 +1884,67 @@
  return ak_mac_ptr( &hctx->mctx, in, size, out, out_size );
 }
 
+/* ----------------------------------------------------------------------------------------------- */
+/*! Функция вычисляет хеш-коды массива независимых сообщений. Для каждого сообщения
+    контекст очищается, после чего сообщение обрабатывается целиком; результат обработки
+    сообщения с индексом `i` помещается в область памяти `out[i]`.
+
+    Функция предназначена для хеширования большого количества коротких сообщений
+    (отпечатков сертификатов, идентификаторов и т.п.): проверки контекста выполняются
+    один раз, а сообщения передаются функциям сжатия напрямую, минуя буферизацию
+    контекста \ref mac.
+
+    @param hctx Контекст функции хеширования.
+    @param in Массив указателей на сообщения.
+    @param size Массив длин сообщений (в октетах).
+    @param out Массив указателей на области памяти, куда помещаются хеш-коды.
+    @param out_size Размер каждой из областей памяти (в октетах).
+    @param count Количество сообщений.
+
+    @return В случае успеха функция возвращает ноль (\ref ak_error_ok). В противном случае
+    возвращается код ошибки.                                                                       */
+/* ----------------------------------------------------------------------------------------------- */
+ int ak_hash_ptr_many( ak_hash hctx, const ak_pointer *in, const size_t *size,
+                                     ak_pointer *out, const size_t out_size, const size_t count )
+{
+  size_t i = 0, tail = 0;
+  int error = ak_error_ok;
+  ak_uint8 *ptr = NULL;
+  ak_mac mctx = NULL;
+
+  if( hctx == NULL ) return ak_error_message( ak_error_null_pointer, __func__,
+                                                            "using null pointer to hash context" );
+  if(( in == NULL ) || ( size == NULL ) || ( out == NULL ))
+    return ak_error_message( ak_error_null_pointer, __func__,
+                                                       "using null pointer to array of messages" );
+  mctx = &hctx->mctx;
+  if(( mctx->clean == NULL ) || ( mctx->update == NULL ) || ( mctx->finalize == NULL ))
+    return ak_error_message( ak_error_undefined_function, __func__,
+                                                      "using hash context with undefined methods" );
+  for( i = 0; i < count; i++ ) {
+     if(( in[i] == NULL ) && ( size[i] > 0 ))
+       return ak_error_message( ak_error_null_pointer, __func__,
+                                                        "using null pointer to message data" );
+     if( out[i] == NULL )
+       return ak_error_message( ak_error_null_pointer, __func__,
+                                                      "using null pointer to message hash code" );
+     if(( error = mctx->clean( mctx->ctx )) != ak_error_ok )
+       return ak_error_message( error, __func__, "incorrect cleaning of hash context" );
+
+     tail = size[i]%mctx->bsize;
+     if( size[i] > tail ) {
+       if(( error = mctx->update( mctx->ctx, in[i], size[i] - tail )) != ak_error_ok )
+         return ak_error_message( error, __func__, "incorrect updating of hash context" );
+     }
+    /* для пустого сообщения указатель на данные может быть равен NULL */
+     ptr = ( size[i] > 0 ) ? ( ak_uint8 *)in[i] + size[i] - tail : NULL;
+     if(( error = mctx->finalize( mctx->ctx, ptr, tail, out[i], out_size )) != ak_error_ok )
+       return ak_error_message( error, __func__, "incorrect finalizing of hash context" );
+  }
+
+ return ak_mac_clean( mctx );
+}
+
 /* ----------------------------------------------------------------------------------------------- */
 /*! @param hctx Контекст функции хеширования
     @param filename Имя файла, для котрого вычисляется хеш-код.
@@ -1492,6 +1961,11 @@
 {
   if( hctx == NULL ) return ak_error_message( ak_error_null_pointer, __func__,
                                                             "using null pointer to hash context" );
+ /* в древовидном режиме файл считывается фрагментами, содержащими по листу на каждый поток */
+  if( hctx->mctx.clean == ak_hash_context_streebog_tree_clean )
+    return ak_mac_file_with_block_size( &hctx->mctx, filename, ak_streebog_tree_leaf_size*
+        ak_max( 1, ak_min( hctx->data.tctx->threads, ak_streebog_tree_batch_leaves )),
+                                                                                out, out_size );
  return ak_mac_file( &hctx->mctx, filename, out, out_size );
 }
 
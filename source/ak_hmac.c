@@ -18,8 +18,110 @@
  #error Library cannot be compiled without string.h header
 #endif
 
+/* ----------------------------------------------------------------------------------------------- */
+/*! \brief Вычисление внутренних состояний функции хеширования после обработки блоков ipad и opad.
+    \details Для каждого из блоков `ipad` и `opad` функция формирует сумму ключа с константой,
+    обрабатывает ее функцией хеширования и сохраняет полученные векторы h и \f$ \Sigma \f$ в
+    контексте алгоритма HMAC в маскированном виде. После этого в контексте ключа устанавливается
+    флаг \ref ak_key_flag_precomputed, который сбрасывается при изменении значения ключа.
+    \param hctx Контекст алгоритма HMAC выработки имитовставки.
+    \return В случае успеха функция возвращает \ref ak_error_ok. В противном случае
+    возвращается код ошибки.                                                                       */
+/* ----------------------------------------------------------------------------------------------- */
+ static int ak_hmac_internal_set_states( ak_hmac hctx )
+{
+  int error = ak_error_ok;
+  size_t idx = 0, jdx = 0, len = 0, k = 0;
+  ak_uint8 buffer[64]; /* буффер для хранения промежуточных значений */
+  const ak_uint8 pads[2] = { 0x36, 0x5C };
+  ak_streebog sx = &hctx->ctx.data.sctx;
+
+  if( hctx->mctx.bsize > sizeof( buffer )) return ak_error_message( ak_error_wrong_length,
+                                            __func__, "using hash function with huge block size" );
+  for( k = 0; k < 2; k++ ) {
+    /* фомируем маскированное значение ключа */
+     len = ak_min( hctx->mctx.bsize, jdx = hctx->key.key_size );
+     for( idx = 0; idx < len; idx++, jdx++ ) {
+        buffer[idx] = hctx->key.key[idx] ^ pads[k];
+        buffer[idx] ^= hctx->key.key[jdx];
+     }
+     for( ; idx < hctx->mctx.bsize; idx++ ) buffer[idx] = pads[k];
+
+    /* вычисляем состояние контекста хеширования после обработки одного блока */
+     if(( error = ak_hash_clean( &hctx->ctx )) != ak_error_ok ) {
+       ak_error_message( error, __func__, "wrong cleaning of hash function context" );
+       break;
+     }
+     if(( error = ak_hash_update( &hctx->ctx, buffer, hctx->mctx.bsize )) != ak_error_ok ) {
+       ak_error_message( error, __func__, "invalid 1st step iteration for hmac key context" );
+       break;
+     }
+    /* сохраняем векторы h и sigma в маскированном виде */
+     if(( error = ak_random_ptr( &hctx->key.generator,
+                                     hctx->masks[k], sizeof( hctx->masks[k] ))) != ak_error_ok ) {
+       ak_error_message( error, __func__, "wrong generation a random mask for hmac states" );
+       break;
+     }
+     for( idx = 0; idx < 8; idx++ ) {
+        hctx->states[k][idx] = sx->h[idx] ^ hctx->masks[k][idx];
+        hctx->states[k][8+idx] = sx->sigma[idx] ^ hctx->masks[k][8+idx];
+     }
+     memcpy( hctx->counter, sx->n, sizeof( hctx->counter ));
+
+    /* перемаскируем ключ */
+     hctx->key.set_mask( &hctx->key );
+  }
+
+ /* очищаем буффер и контекст хеширования */
+  ak_ptr_wipe( buffer, sizeof( buffer ), &hctx->key.generator );
+  ak_hash_clean( &hctx->ctx );
+  if( error == ak_error_ok ) hctx->key.flags |= ak_key_flag_precomputed;
+
+ return error;
+}
+
+/* ----------------------------------------------------------------------------------------------- */
+/*! \brief Восстановление состояния функции хеширования после обработки блока ipad или opad.
+    \details Функция снимает маску с сохраненного состояния, помещает его в контекст
+    функции хеширования, после чего сменяет маску сохраненного состояния. Частота смены маски
+    определяется политикой перемаскирования ключа (см. ak_skey_remask_is_required()).
+    \param hctx Контекст алгоритма HMAC выработки имитовставки.
+    \param k Индекс состояния: 0 для блока ipad, 1 для блока opad.
+    \return В случае успеха функция возвращает \ref ak_error_ok. В противном случае
+    возвращается код ошибки.                                                                       */
+/* ----------------------------------------------------------------------------------------------- */
+ static int ak_hmac_internal_load_state( ak_hmac hctx, const size_t k )
+{
+  size_t idx = 0;
+  ak_uint64 mask[16];
+  int error = ak_error_ok;
+  ak_streebog sx = &hctx->ctx.data.sctx;
+
+  if(( error = ak_hash_clean( &hctx->ctx )) != ak_error_ok )
+    return ak_error_message( error, __func__, "wrong cleaning of hash function context" );
+  for( idx = 0; idx < 8; idx++ ) {
+     sx->h[idx] = hctx->states[k][idx] ^ hctx->masks[k][idx];
+     sx->sigma[idx] = hctx->states[k][8+idx] ^ hctx->masks[k][8+idx];
+  }
+  memcpy( sx->n, hctx->counter, sizeof( hctx->counter ));
+
+ /* сменяем маску сохраненного состояния в соответствии с политикой перемаскирования ключа */
+  if( !ak_skey_remask_is_required( &hctx->key, 1 )) return ak_error_ok;
+  if(( error = ak_random_ptr( &hctx->key.generator, mask, sizeof( mask ))) != ak_error_ok )
+    return ak_error_message( error, __func__, "wrong generation a random mask for hmac states" );
+  for( idx = 0; idx < 16; idx++ ) {
+     hctx->states[k][idx] ^= mask[idx];
+     hctx->masks[k][idx] ^= mask[idx];
+  }
+
+ return ak_error_ok;
+}
+
 /* ----------------------------------------------------------------------------------------------- */
 /*! \brief Очистка контекста алгоритма hmac.
+    \details Функция помещает в контекст функции хеширования состояние, полученное после
+    обработки блока ipad. Состояние вычисляется один раз для каждого значения ключа
+    функцией ak_hmac_internal_set_states().
     \param ctx Контекст алгоритма HMAC выработки имитовставки.
     \return В случае успеха функция возвращает \ref ak_error_ok. В противном случае
     возвращается код ошибки.                                                                       */
@@ -28,8 +130,6 @@
 {
   int error = ak_error_ok;
   ak_hmac hctx = ( ak_hmac ) ctx;
-  size_t idx = 0, jdx = 0, len = 0;
-  ak_uint8 buffer[64]; /* буффер для хранения промежуточных значений */
 
   if( ctx == NULL ) return ak_error_message( ak_error_null_pointer, __func__,
                                                       "using a null pointer to hmac key context" );
@@ -40,32 +140,17 @@
   if( hctx->key.resource.value.counter <= 1 ) return ak_error_message( ak_error_low_key_resource,
                                             __func__, "using hmac key context with low resource" );
                       /* нам надо два раза использовать ключ => ресурс должен быть не менее двух */
-  if( hctx->mctx.bsize > sizeof( buffer )) return ak_error_message( ak_error_wrong_length,
-                                            __func__, "using hash function with huge block size" );
-
- /* фомируем маскированное значение ключа */
-  len = ak_min( hctx->mctx.bsize, jdx = hctx->key.key_size );
-  for( idx = 0; idx < len; idx++, jdx++ ) {
-     buffer[idx] = hctx->key.key[idx] ^ 0x36;
-     buffer[idx] ^= hctx->key.key[jdx];
+ /* при первом использовании ключа вычисляем состояния после обработки блоков ipad и opad */
+  if( !((hctx->key.flags)&ak_key_flag_precomputed )) {
+    if(( error = ak_hmac_internal_set_states( hctx )) != ak_error_ok )
+      return ak_error_message( error, __func__, "incorrect precomputation of hmac states" );
   }
-  for( ; idx < hctx->mctx.bsize; idx++ ) buffer[idx] = 0x36;
-
- /* инициализируем начальное состояние контекста хеширования */
-  if(( error = ak_hash_clean( &hctx->ctx )) != ak_error_ok )
-    return ak_error_message( error, __func__, "wrong cleaning of hash function context" );
-
- /* обновляем состояние контекста хеширования */
-  if(( error = ak_hash_update( &hctx->ctx, buffer, hctx->mctx.bsize )) != ak_error_ok )
-    ak_error_message( error, __func__, "invalid 1st step iteration for hmac key context" );
 
- /* очищаем буффер */
-  ak_ptr_wipe( buffer, sizeof( buffer ), &hctx->key.generator );
+ /* восстанавливаем состояние контекста хеширования после обработки блока ipad */
+  if(( error = ak_hmac_internal_load_state( hctx, 0 )) != ak_error_ok )
+    return ak_error_message( error, __func__, "invalid 1st step iteration for hmac key context" );
 
- /* перемаскируем ключ и меняем его ресурс */
-  hctx->key.set_mask( &hctx->key );
   hctx->key.resource.value.counter--; /* мы использовали ключ один раз */
-
  return error;
 }
 
@@ -112,9 +197,7 @@
 {
   int error = ak_error_ok;
   ak_hmac hctx = ( ak_hmac ) ctx;
-  size_t idx = 0, jdx = 0, len = 0;
-  ak_uint8 temporary[128]; /* первый буффер для хранения промежуточных значений */
-  ak_uint8 keybuffer[128]; /* второй буффер для хранения промежуточных значений */
+  ak_uint8 temporary[128]; /* буффер для хранения промежуточных значений */
 
  /* выполняем проверки */
   if( hctx == NULL ) return ak_error_message( ak_error_null_pointer, __func__,
@@ -128,33 +211,19 @@
  /* проверяем наличие ключа (ресурс проверен при вызове clean) */
   if( !((hctx->key.flags)&ak_key_flag_set_key )) return ak_error_message( ak_error_key_value,
                                                __func__ , "using hmac key with unassigned value" );
+  if( !((hctx->key.flags)&ak_key_flag_precomputed )) return ak_error_message( ak_error_key_value,
+                                            __func__ , "using hmac key without precomputed states" );
  /* обрабатываем хвост предыдущих данных */
   memset( temporary, 0, sizeof( temporary ));
   if(( error = ak_hash_finalize( &hctx->ctx, in, size, temporary,
                                                             sizeof( temporary ))) != ak_error_ok )
     return ak_error_message( error, __func__ , "wrong updating of finalized data" );
 
- /* фомируем маскированное значение ключа */
-  len = ak_min( hctx->mctx.bsize, jdx = hctx->key.key_size );
-  for( idx = 0; idx < len; idx++ , jdx++ ) {
-     keybuffer[idx] = hctx->key.key[idx] ^ 0x5C;
-     keybuffer[idx] ^= hctx->key.key[jdx];
-  }
-  for( ; idx < hctx->mctx.bsize; idx++ ) keybuffer[idx] = 0x5C;
-
- /* возвращаем контекст хеширования в начальное состояние */
-  if(( error = ak_hash_clean( &hctx->ctx )) != ak_error_ok )
-    return ak_error_message( error, __func__, "wrong cleaning of hash function context" );
-
- /* обновляем состояние контекста хеширования */
-  if(( error = ak_hash_update( &hctx->ctx, keybuffer, hctx->mctx.bsize )) != ak_error_ok )
+ /* восстанавливаем состояние контекста хеширования после обработки блока opad */
+  if(( error = ak_hmac_internal_load_state( hctx, 1 )) != ak_error_ok )
     return ak_error_message( error, __func__, "invalid 1st step iteration for hmac key context" );
 
- /* очищаем буффер */
-  ak_ptr_wipe( keybuffer, sizeof( keybuffer ), &hctx->key.generator );
-
  /* ресурс ключа */
-  hctx->key.set_mask( &hctx->key );
   hctx->key.resource.value.counter--; /* мы использовали ключ один раз */
 
  /* последний update/finalize и возврат результата */
@@ -251,6 +320,10 @@
                                                             "using null pointer to hmac context" );
   if(( error = ak_hash_destroy( &hctx->ctx )) != ak_error_ok )
     ak_error_message( error, __func__, "incorrect destroying of hash context" );
+  if(( hctx->key.flags )&ak_key_flag_precomputed ) {
+    ak_ptr_wipe( hctx->states, sizeof( hctx->states ), &hctx->key.generator );
+    ak_ptr_wipe( hctx->masks, sizeof( hctx->masks ), &hctx->key.generator );
+  }
   if(( error = ak_skey_destroy( &hctx->key )) != ak_error_ok )
     ak_error_message( error, __func__, "incorrect destroying of secret key context" );
   if(( error = ak_mac_destroy( &hctx->mctx )) != ak_error_ok )
@@ -679,6 +752,14 @@
     ak_error_message( error, __func__ , "wrong creation of hmac-streebog512 key context" );
     return ak_false;
   }
+ /* сначала используем другое значение ключа: при смене ключа
+    вычисленные из него внутренние состояния должны быть обновлены */
+  if((( error = ak_hmac_set_key( &hkey, buffer, 64 )) != ak_error_ok ) ||
+     (( error = ak_hmac_ptr( &hkey, data, 16, out, sizeof( out ))) != ak_error_ok )) {
+    ak_error_message( error, __func__ , "wrong using of random hmac key value" );
+    result = ak_false;
+    goto lab_exit;
+  }
   if(( error = ak_hmac_set_key( &hkey, key, 32 )) != ak_error_ok ) {
     ak_error_message( error, __func__ , "wrong assigning a constant hmac key value" );
     result = ak_false;
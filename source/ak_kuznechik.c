@@ -4,6 +4,14 @@
 /*  Файл ak_kuznechik.h                                                                            */
 /*  - содержит реализацию алгоритма блочного шифрования Кузнечик,                                  */
 /*    регламентированного ГОСТ Р 34.12-2015                                                        */
+/* ----------------------------------------------------------------------------------------------- */
+#ifdef AK_HAVE_BUILTIN_XOR_SI128
+ #include <emmintrin.h>
+#endif
+#ifdef AK_HAVE_BUILTIN_CLMULEPI64
+ #include <wmmintrin.h>
+#endif
+
 /* ----------------------------------------------------------------------------------------------- */
  #include <libakrypt-internal.h>
 
@@ -313,12 +321,13 @@
   ak_uint8 reverse[64];
   int i = 0, j = 0, l = 0, kdx = 2;
   ak_uint64 a0[2], a1[2], c[2], t[2], idx = 0;
-  ak_int64 oc = ak_libakrypt_get_option_by_name( "openssl_compability" );
+  ak_int64 oc = 0;
   ak_uint64 *ekey = NULL, *mkey = NULL, *dkey = NULL, *xkey = NULL, *rkey = NULL, *lkey = NULL;
 
  /* выполняем стандартные проверки */
   if( skey == NULL ) return ak_error_message( ak_error_null_pointer, __func__ ,
                                                             "using a null pointer to secret key" );
+  oc = skey->options.openssl_compability;
   if( skey->key_size != 32 ) return ak_error_message( ak_error_null_pointer, __func__ ,
                                                               "unsupported length of secret key" );
  /* проверяем целостность ключа */
@@ -670,6 +679,358 @@
   (( ak_uint64 *) out)[1] = x[1] ^ xkey[1];
 }
 
+/* ----------------------------------------------------------------------------------------------- */
+/*                  функции одновременной обработки нескольких блоков информации                   */
+/* ----------------------------------------------------------------------------------------------- */
+/*! \brief Количество блоков, одновременно обрабатываемых многоблочными функциями. */
+ #define ak_kuznechik_interleave    (4)
+
+/*! \brief Индекс октета блока, используемый при обращении к таблицам; в режиме совместимости
+    с openssl октеты блока обрабатываются в обратном порядке. */
+ #define ak_kuznechik_index( j, oc )  ( (oc) ? 15-(j) : (j) )
+
+/* ----------------------------------------------------------------------------------------------- */
+/*! \brief Функция зашифрования четырех блоков информации шифром Кузнечик.
+
+    Блоки обрабатываются одновременно, раунд за раундом, что позволяет процессору совмещать
+    во времени независимые обращения к таблицам различных блоков. Наложение раундовых ключей
+    выполняется так же, как и в функции ak_kuznechik_encrypt_with_mask(): к блоку
+    последовательно прибавляются ключ и его маска.
+
+    \param skey Контекст секретного ключа.
+    \param in Указатель на область памяти, содержащую четыре блока открытого текста.
+    \param out Указатель на область памяти, куда помещаются четыре блока шифртекста.
+    \param oc Флаг режима совместимости с openssl.                                                 */
+/* ----------------------------------------------------------------------------------------------- */
+ static inline void ak_kuznechik_encrypt_interleave( ak_skey skey,
+                                                 const ak_uint8 *in, ak_uint8 *out, const int oc )
+{
+  int i = 0, j, k;
+  ak_uint64 *ekey = ( ak_uint64 *)skey->data;
+  ak_uint64 *mkey = ( ak_uint64 *)skey->data + 40;
+  ak_uint64 t[2*ak_kuznechik_interleave], x[2*ak_kuznechik_interleave];
+  ak_uint8 *b = (ak_uint8 *)x;
+
+  memcpy( x, in, sizeof( x ));
+  while( i < 18 ) {
+     for( k = 0; k < 2*ak_kuznechik_interleave; k += 2 ) {
+        x[k] ^= ekey[i]; x[k] ^= mkey[i];
+        x[k+1] ^= ekey[i+1]; x[k+1] ^= mkey[i+1];
+     }
+     for( k = 0; k < ak_kuznechik_interleave; k++ ) {
+        t[2*k] = t[2*k+1] = 0;
+        for( j = 0; j < 16; j++ ) {
+           t[2*k] ^= kuznechik_parameters.enc[j][b[16*k+ak_kuznechik_index( j, oc )]][0];
+           t[2*k+1] ^= kuznechik_parameters.enc[j][b[16*k+ak_kuznechik_index( j, oc )]][1];
+        }
+     }
+     memcpy( x, t, sizeof( x ));
+     i += 2;
+  }
+  for( k = 0; k < 2*ak_kuznechik_interleave; k += 2 ) {
+     x[k] ^= ekey[18]; x[k] ^= mkey[18];
+     x[k+1] ^= ekey[19]; x[k+1] ^= mkey[19];
+  }
+  memcpy( out, x, sizeof( x ));
+}
+
+/* ----------------------------------------------------------------------------------------------- */
+/*! \brief Функция расшифрования четырех блоков информации шифром Кузнечик.
+    \details Параметры функции аналогичны параметрам функции ak_kuznechik_encrypt_interleave(). */
+/* ----------------------------------------------------------------------------------------------- */
+ static inline void ak_kuznechik_decrypt_interleave( ak_skey skey,
+                                                 const ak_uint8 *in, ak_uint8 *out, const int oc )
+{
+  int i = 19, j, k;
+  ak_uint64 *dkey = ( ak_uint64 *)skey->data + 20;
+  ak_uint64 *xkey = ( ak_uint64 *)skey->data + 60;
+  ak_uint64 t[2*ak_kuznechik_interleave], x[2*ak_kuznechik_interleave];
+  ak_uint8 *b = (ak_uint8 *)x;
+
+  memcpy( x, in, sizeof( x ));
+  for( j = 0; j < 16*ak_kuznechik_interleave; j++ ) b[j] = kuznechik_parameters.pi[b[j]];
+  while( i > 1 ) {
+     for( k = 0; k < ak_kuznechik_interleave; k++ ) {
+        t[2*k] = t[2*k+1] = 0;
+        for( j = 0; j < 16; j++ ) {
+           t[2*k] ^= kuznechik_parameters.dec[j][b[16*k+ak_kuznechik_index( j, oc )]][0];
+           t[2*k+1] ^= kuznechik_parameters.dec[j][b[16*k+ak_kuznechik_index( j, oc )]][1];
+        }
+     }
+     for( k = 0; k < 2*ak_kuznechik_interleave; k += 2 ) {
+        t[k+1] ^= dkey[i]; t[k+1] ^= xkey[i];
+        t[k] ^= dkey[i-1]; t[k] ^= xkey[i-1];
+     }
+     memcpy( x, t, sizeof( x ));
+     i -= 2;
+  }
+  for( j = 0; j < 16*ak_kuznechik_interleave; j++ ) b[j] = kuznechik_parameters.pinv[b[j]];
+  for( k = 0; k < 2*ak_kuznechik_interleave; k += 2 ) {
+     x[k] ^= dkey[0]; x[k] ^= xkey[0];
+     x[k+1] ^= dkey[1]; x[k+1] ^= xkey[1];
+  }
+  memcpy( out, x, sizeof( x ));
+}
+
+#ifdef AK_HAVE_BUILTIN_XOR_SI128
+/* ----------------------------------------------------------------------------------------------- */
+/*! \brief Функция зашифрования четырех блоков информации шифром Кузнечик
+    с использованием 128-ми битных регистров.
+
+    Каждая строка таблицы `kuznechik_parameters.enc` загружается и складывается с текущим
+    значением блока одной командой. Наложение ключа и маски выполняется раздельно.
+    \details Параметры функции аналогичны параметрам функции ak_kuznechik_encrypt_interleave(). */
+/* ----------------------------------------------------------------------------------------------- */
+ static inline void ak_kuznechik_encrypt_interleave_sse2( ak_skey skey,
+                                                 const ak_uint8 *in, ak_uint8 *out, const int oc )
+{
+  int i, j, k;
+  __m128i t[ak_kuznechik_interleave], ek, mk;
+  const __m128i *ekey = ( const __m128i *)skey->data;
+  const __m128i *mkey = ( const __m128i *)(( ak_uint64 *)skey->data + 40 );
+  union {
+    __m128i v[ak_kuznechik_interleave];
+    ak_uint8 b[16*ak_kuznechik_interleave];
+  } x;
+
+  for( k = 0; k < ak_kuznechik_interleave; k++ )
+     x.v[k] = _mm_loadu_si128( ( const __m128i *)in + k );
+  for( i = 0; i < 9; i++ ) {
+     ek = _mm_loadu_si128( ekey + i ); mk = _mm_loadu_si128( mkey + i );
+     for( k = 0; k < ak_kuznechik_interleave; k++ ) {
+        x.v[k] = _mm_xor_si128( x.v[k], ek ); x.v[k] = _mm_xor_si128( x.v[k], mk );
+     }
+     for( k = 0; k < ak_kuznechik_interleave; k++ ) {
+        t[k] = _mm_loadu_si128(( const __m128i *)
+                           kuznechik_parameters.enc[0][x.b[16*k+ak_kuznechik_index( 0, oc )]] );
+        for( j = 1; j < 16; j++ )
+           t[k] = _mm_xor_si128( t[k], _mm_loadu_si128(( const __m128i *)
+                          kuznechik_parameters.enc[j][x.b[16*k+ak_kuznechik_index( j, oc )]] ));
+     }
+     for( k = 0; k < ak_kuznechik_interleave; k++ ) x.v[k] = t[k];
+  }
+  ek = _mm_loadu_si128( ekey + 9 ); mk = _mm_loadu_si128( mkey + 9 );
+  for( k = 0; k < ak_kuznechik_interleave; k++ ) {
+     x.v[k] = _mm_xor_si128( x.v[k], ek ); x.v[k] = _mm_xor_si128( x.v[k], mk );
+     _mm_storeu_si128( ( __m128i *)out + k, x.v[k] );
+  }
+}
+
+/* ----------------------------------------------------------------------------------------------- */
+/*! \brief Функция расшифрования четырех блоков информации шифром Кузнечик
+    с использованием 128-ми битных регистров.
+    \details Параметры функции аналогичны параметрам функции ak_kuznechik_encrypt_interleave(). */
+/* ----------------------------------------------------------------------------------------------- */
+ static inline void ak_kuznechik_decrypt_interleave_sse2( ak_skey skey,
+                                                 const ak_uint8 *in, ak_uint8 *out, const int oc )
+{
+  int i, j, k;
+  __m128i t[ak_kuznechik_interleave], dk, xk;
+  const __m128i *dkey = ( const __m128i *)(( ak_uint64 *)skey->data + 20 );
+  const __m128i *xkey = ( const __m128i *)(( ak_uint64 *)skey->data + 60 );
+  union {
+    __m128i v[ak_kuznechik_interleave];
+    ak_uint8 b[16*ak_kuznechik_interleave];
+  } x;
+
+  for( k = 0; k < ak_kuznechik_interleave; k++ )
+     x.v[k] = _mm_loadu_si128( ( const __m128i *)in + k );
+  for( j = 0; j < 16*ak_kuznechik_interleave; j++ ) x.b[j] = kuznechik_parameters.pi[x.b[j]];
+  for( i = 9; i > 0; i-- ) {
+     dk = _mm_loadu_si128( dkey + i ); xk = _mm_loadu_si128( xkey + i );
+     for( k = 0; k < ak_kuznechik_interleave; k++ ) {
+        t[k] = _mm_loadu_si128(( const __m128i *)
+                           kuznechik_parameters.dec[0][x.b[16*k+ak_kuznechik_index( 0, oc )]] );
+        for( j = 1; j < 16; j++ )
+           t[k] = _mm_xor_si128( t[k], _mm_loadu_si128(( const __m128i *)
+                          kuznechik_parameters.dec[j][x.b[16*k+ak_kuznechik_index( j, oc )]] ));
+     }
+     for( k = 0; k < ak_kuznechik_interleave; k++ ) {
+        t[k] = _mm_xor_si128( t[k], dk ); x.v[k] = _mm_xor_si128( t[k], xk );
+     }
+  }
+  for( j = 0; j < 16*ak_kuznechik_interleave; j++ ) x.b[j] = kuznechik_parameters.pinv[x.b[j]];
+  dk = _mm_loadu_si128( dkey ); xk = _mm_loadu_si128( xkey );
+  for( k = 0; k < ak_kuznechik_interleave; k++ ) {
+     x.v[k] = _mm_xor_si128( x.v[k], dk ); x.v[k] = _mm_xor_si128( x.v[k], xk );
+     _mm_storeu_si128( ( __m128i *)out + k, x.v[k] );
+  }
+}
+#endif
+
+/* ----------------------------------------------------------------------------------------------- */
+/*! \brief Макрос, определяющий функцию многоблочной обработки данных.
+    \details Определяемая функция обрабатывает данные группами по \ref ak_kuznechik_interleave
+    блоков с помощью функции `kernel`; оставшиеся блоки обрабатываются функцией `single`.          */
+/* ----------------------------------------------------------------------------------------------- */
+ #define ak_kuznechik_define_blocks_function( name, kernel, single, oc )                         \
+ static void name( ak_skey skey, ak_pointer in, ak_pointer out, size_t blocks )                  \
+{                                                                                                  \
+  ak_uint8 *inptr = (ak_uint8 *)in, *outptr = (ak_uint8 *)out;                                     \
+                                                                                                   \
+  while( blocks >= ak_kuznechik_interleave ) {                                                     \
+    kernel( skey, inptr, outptr, oc );                                                             \
+    inptr += 16*ak_kuznechik_interleave; outptr += 16*ak_kuznechik_interleave;                     \
+    blocks -= ak_kuznechik_interleave;                                                             \
+  }                                                                                                \
+  while( blocks-- > 0 ) {                                                                          \
+    single( skey, inptr, outptr );                                                                 \
+    inptr += 16; outptr += 16;                                                                     \
+  }                                                                                                \
+}
+
+ ak_kuznechik_define_blocks_function( ak_kuznechik_encrypt_blocks_with_mask,
+                      ak_kuznechik_encrypt_interleave, ak_kuznechik_encrypt_with_mask, 0 )
+ ak_kuznechik_define_blocks_function( ak_kuznechik_decrypt_blocks_with_mask,
+                      ak_kuznechik_decrypt_interleave, ak_kuznechik_decrypt_with_mask, 0 )
+ ak_kuznechik_define_blocks_function( ak_kuznechik_encrypt_blocks_with_mask_oc,
+                      ak_kuznechik_encrypt_interleave, ak_kuznechik_encrypt_with_mask_oc, 1 )
+ ak_kuznechik_define_blocks_function( ak_kuznechik_decrypt_blocks_with_mask_oc,
+                      ak_kuznechik_decrypt_interleave, ak_kuznechik_decrypt_with_mask_oc, 1 )
+#ifdef AK_HAVE_BUILTIN_XOR_SI128
+ ak_kuznechik_define_blocks_function( ak_kuznechik_encrypt_blocks_with_mask_sse2,
+                 ak_kuznechik_encrypt_interleave_sse2, ak_kuznechik_encrypt_with_mask, 0 )
+ ak_kuznechik_define_blocks_function( ak_kuznechik_decrypt_blocks_with_mask_sse2,
+                 ak_kuznechik_decrypt_interleave_sse2, ak_kuznechik_decrypt_with_mask, 0 )
+ ak_kuznechik_define_blocks_function( ak_kuznechik_encrypt_blocks_with_mask_oc_sse2,
+                 ak_kuznechik_encrypt_interleave_sse2, ak_kuznechik_encrypt_with_mask_oc, 1 )
+ ak_kuznechik_define_blocks_function( ak_kuznechik_decrypt_blocks_with_mask_oc_sse2,
+                 ak_kuznechik_decrypt_interleave_sse2, ak_kuznechik_decrypt_with_mask_oc, 1 )
+#endif
+
+#if defined( AK_HAVE_BUILTIN_XOR_SI128 ) && defined( AK_HAVE_BUILTIN_CLMULEPI64 )
+/* ----------------------------------------------------------------------------------------------- */
+/*! \brief Функция обработки блоков данных в режиме MGM, совмещающая зашифрование значений
+    обоих счетчиков и вычисление произведений в поле \f$ \mathbb F_{2^{128}}\f$.
+
+    На каждой итерации цикла обрабатывается \ref ak_kuznechik_interleave блоков данных:
+    раунд за раундом одновременно зашифровываются значения счетчика `ycount` на ключе
+    шифрования и значения счетчика `zcount` на ключе имитозащиты, после чего полученная гамма
+    складывается с данными, а произведения множителей \f$ H_i \f$ на блоки шифртекста
+    накапливаются без приведения. Приведение по модулю многочлена
+    \f$ x^{128} + x^7 + x^2 + x + 1 \f$ выполняется однократно, при выходе из функции.
+    Такое совмещение позволяет процессору выполнять умножения PCLMULQDQ одновременно
+    с обращениями к таблицам шифра.
+
+    \param ekey Ключ шифрования.
+    \param akey Ключ имитозащиты.
+    \param ycount Указатель на счетчик, используемый для шифрования.
+    \param zcount Указатель на счетчик, используемый для выработки имитовставки.
+    \param sum Указатель на текущее значение имитовставки.
+    \param in Указатель на входные данные.
+    \param out Указатель на область памяти, куда помещаются выходные данные;
+    может совпадать с указателем `in`.
+    \param blocks Количество обрабатываемых блоков.
+    \param encrypt Флаг зашифрования (\ref ak_true) или расшифрования (\ref ak_false) данных.
+    \param oc Флаг режима совместимости с openssl.                                                 */
+/* ----------------------------------------------------------------------------------------------- */
+ static inline void ak_kuznechik_mgm_blocks_sse2( ak_skey ekey, ak_skey akey,
+                      ak_pointer ycount, ak_pointer zcount, ak_pointer sum, ak_pointer in,
+                                  ak_pointer out, size_t blocks, bool_t encrypt, const int oc )
+{
+  size_t i, j, k, n;
+  ak_uint64 c[2], d[2], e[2], x3, D;
+  __m128i t[2*ak_kuznechik_interleave], ek, mk, ak, am, data, gamma;
+  __m128i cm = _mm_setzero_si128(), dm = _mm_setzero_si128(), em = _mm_setzero_si128();
+  __m128i y = _mm_loadu_si128( ( const __m128i *)ycount ),
+          z = _mm_loadu_si128( ( const __m128i *)zcount );
+  const __m128i yone = _mm_set_epi64x( 0, 1 ), zone = _mm_set_epi64x( 1, 0 );
+  const __m128i *ekeys = ( const __m128i *)ekey->data,
+                *mkeys = ( const __m128i *)(( ak_uint64 *)ekey->data + 40 ),
+                *akeys = ( const __m128i *)akey->data,
+                *amkeys = ( const __m128i *)(( ak_uint64 *)akey->data + 40 );
+  __m128i *inptr = ( __m128i *)in, *outptr = ( __m128i *)out;
+  union {
+    __m128i v[2*ak_kuznechik_interleave];
+    ak_uint8 b[32*ak_kuznechik_interleave];
+  } x;
+
+  while( blocks > 0 ) {
+     n = ak_min( blocks, ak_kuznechik_interleave );
+    /* первые блоки - значения счетчика ycount, последние - значения счетчика zcount */
+     x.v[0] = y; x.v[ak_kuznechik_interleave] = z;
+     for( k = 1; k < ak_kuznechik_interleave; k++ ) {
+        x.v[k] = _mm_add_epi64( x.v[k-1], yone );
+        x.v[k+ak_kuznechik_interleave] = _mm_add_epi64( x.v[k+ak_kuznechik_interleave-1], zone );
+     }
+    /* раунды шифрования обоих счетчиков */
+     for( i = 0; i < 9; i++ ) {
+        ek = _mm_loadu_si128( ekeys + i ); mk = _mm_loadu_si128( mkeys + i );
+        ak = _mm_loadu_si128( akeys + i ); am = _mm_loadu_si128( amkeys + i );
+        for( k = 0; k < ak_kuznechik_interleave; k++ ) {
+           x.v[k] = _mm_xor_si128( _mm_xor_si128( x.v[k], ek ), mk );
+           x.v[k+ak_kuznechik_interleave] =
+                  _mm_xor_si128( _mm_xor_si128( x.v[k+ak_kuznechik_interleave], ak ), am );
+        }
+        for( k = 0; k < 2*ak_kuznechik_interleave; k++ ) {
+           t[k] = _mm_loadu_si128(( const __m128i *)
+                           kuznechik_parameters.enc[0][x.b[16*k+ak_kuznechik_index( 0, oc )]] );
+           for( j = 1; j < 16; j++ )
+              t[k] = _mm_xor_si128( t[k], _mm_loadu_si128(( const __m128i *)
+                          kuznechik_parameters.enc[j][x.b[16*k+ak_kuznechik_index( j, oc )]] ));
+        }
+        for( k = 0; k < 2*ak_kuznechik_interleave; k++ ) x.v[k] = t[k];
+     }
+     ek = _mm_loadu_si128( ekeys + 9 ); mk = _mm_loadu_si128( mkeys + 9 );
+     ak = _mm_loadu_si128( akeys + 9 ); am = _mm_loadu_si128( amkeys + 9 );
+
+    /* наложение гаммы и накопление произведений (без приведения) */
+     for( k = 0; k < n; k++ ) {
+        gamma = _mm_xor_si128( _mm_xor_si128( x.v[k], ek ), mk );
+        x.v[k+ak_kuznechik_interleave] =
+                  _mm_xor_si128( _mm_xor_si128( x.v[k+ak_kuznechik_interleave], ak ), am );
+        data = _mm_loadu_si128( inptr + k );
+        _mm_storeu_si128( outptr + k, _mm_xor_si128( data, gamma ));
+        if( encrypt ) data = _mm_xor_si128( data, gamma );
+
+        cm = _mm_xor_si128( cm,
+                   _mm_clmulepi64_si128( x.v[k+ak_kuznechik_interleave], data, 0x00 ));
+        dm = _mm_xor_si128( dm,
+                   _mm_clmulepi64_si128( x.v[k+ak_kuznechik_interleave], data, 0x11 ));
+        em = _mm_xor_si128( em, _mm_xor_si128(
+                    _mm_clmulepi64_si128( x.v[k+ak_kuznechik_interleave], data, 0x10 ),
+                    _mm_clmulepi64_si128( x.v[k+ak_kuznechik_interleave], data, 0x01 )));
+     }
+    /* значения счетчиков, выработанные сверх необходимого, не используются */
+     for( k = 0; k < n; k++ ) { y = _mm_add_epi64( y, yone ); z = _mm_add_epi64( z, zone ); }
+     inptr += n; outptr += n; blocks -= n;
+  }
+  _mm_storeu_si128( ( __m128i *)ycount, y );
+  _mm_storeu_si128( ( __m128i *)zcount, z );
+
+ /* однократное приведение и сложение с текущим значением имитовставки */
+  _mm_storeu_si128( ( __m128i *)c, cm );
+  _mm_storeu_si128( ( __m128i *)d, dm );
+  _mm_storeu_si128( ( __m128i *)e, em );
+  x3 = d[1];
+  D = d[0] ^ e[1] ^ (x3 >> 63) ^ (x3 >> 62) ^ (x3 >> 57);
+  ((ak_uint64 *)sum)[0] ^= c[0] ^ D ^ (D << 1) ^ (D << 2) ^ (D << 7);
+  ((ak_uint64 *)sum)[1] ^= c[1] ^ e[0] ^ x3 ^ (x3 << 1) ^ (D >> 63) ^ (x3 << 2) ^ (D >> 62) ^
+                                                                           (x3 << 7) ^ (D >> 57);
+}
+
+/* ----------------------------------------------------------------------------------------------- */
+/*! \brief Функция обработки блоков данных в режиме MGM (см. ak_kuznechik_mgm_blocks_sse2()). */
+/* ----------------------------------------------------------------------------------------------- */
+ static void ak_kuznechik_mgm_blocks_with_mask_sse2( ak_skey ekey, ak_skey akey,
+                      ak_pointer ycount, ak_pointer zcount, ak_pointer sum, ak_pointer in,
+                                               ak_pointer out, size_t blocks, bool_t encrypt )
+{
+  ak_kuznechik_mgm_blocks_sse2( ekey, akey, ycount, zcount, sum, in, out, blocks, encrypt, 0 );
+}
+
+/* ----------------------------------------------------------------------------------------------- */
+/*! \brief Функция обработки блоков данных в режиме MGM для ключей, используемых в режиме
+    совместимости с openssl (см. ak_kuznechik_mgm_blocks_sse2()). */
+/* ----------------------------------------------------------------------------------------------- */
+ static void ak_kuznechik_mgm_blocks_with_mask_oc_sse2( ak_skey ekey, ak_skey akey,
+                      ak_pointer ycount, ak_pointer zcount, ak_pointer sum, ak_pointer in,
+                                               ak_pointer out, size_t blocks, bool_t encrypt )
+{
+  ak_kuznechik_mgm_blocks_sse2( ekey, akey, ycount, zcount, sum, in, out, blocks, encrypt, 1 );
+}
+#endif
+
 /* ----------------------------------------------------------------------------------------------- */
 /*! После инициализации устанавливаются обработчики (функции класса). Однако само значение
     ключу не присваивается - поле `bkey->key` остается неопределенным.
@@ -679,16 +1040,15 @@
 /* ----------------------------------------------------------------------------------------------- */
  int ak_bckey_create_kuznechik( ak_bckey bkey )
 {
-  int error = ak_error_ok, oc = (int) ak_libakrypt_get_option_by_name( "openssl_compability" );
+  int error = ak_error_ok, oc = 0;
 
   if( bkey == NULL ) return ak_error_message( ak_error_null_pointer, __func__,
                                                "using null pointer to block cipher key context" );
-  if(( oc < 0 ) || ( oc > 1 )) return ak_error_message( ak_error_wrong_option, __func__,
-                                                "wrong value for \"openssl_compability\" option" );
 
  /* создаем ключ алгоритма шифрования и определяем его методы */
   if(( error = ak_bckey_create( bkey, 32, 16 )) != ak_error_ok )
     return ak_error_message( error, __func__, "wrong initalization of block cipher key context" );
+  oc = bkey->key.options.openssl_compability;
 
  /* устанавливаем OID алгоритма шифрования */
   if(( bkey->key.oid = ak_oid_find_by_name( "kuznechik" )) == NULL ) {
@@ -706,11 +1066,31 @@
   if( oc ) {
     bkey->encrypt = ak_kuznechik_encrypt_with_mask_oc;
     bkey->decrypt = ak_kuznechik_decrypt_with_mask_oc;
+    bkey->encrypt_blocks = ak_kuznechik_encrypt_blocks_with_mask_oc;
+    bkey->decrypt_blocks = ak_kuznechik_decrypt_blocks_with_mask_oc;
   }
    else {
     bkey->encrypt = ak_kuznechik_encrypt_with_mask;
     bkey->decrypt = ak_kuznechik_decrypt_with_mask;
+    bkey->encrypt_blocks = ak_kuznechik_encrypt_blocks_with_mask;
+    bkey->decrypt_blocks = ak_kuznechik_decrypt_blocks_with_mask;
   }
+
+ /* 128-ми битные многоблочные функции выбираются на этапе компиляции */
+#ifdef AK_HAVE_BUILTIN_XOR_SI128
+  if( oc ) {
+    bkey->encrypt_blocks = ak_kuznechik_encrypt_blocks_with_mask_oc_sse2;
+    bkey->decrypt_blocks = ak_kuznechik_decrypt_blocks_with_mask_oc_sse2;
+  }
+   else {
+    bkey->encrypt_blocks = ak_kuznechik_encrypt_blocks_with_mask_sse2;
+    bkey->decrypt_blocks = ak_kuznechik_decrypt_blocks_with_mask_sse2;
+  }
+ #ifdef AK_HAVE_BUILTIN_CLMULEPI64
+  bkey->mgm_blocks = oc ? ak_kuznechik_mgm_blocks_with_mask_oc_sse2 :
+                                                         ak_kuznechik_mgm_blocks_with_mask_sse2;
+ #endif
+#endif
  return error;
 }
 
@@ -831,7 +1211,7 @@
 {
   size_t i = 0;
   struct bckey bkey;
-  ak_uint8 myout[256];
+  ak_uint8 myout[256], mydata[176];
   bool_t result = ak_true;
   int error = ak_error_ok, audit = ak_log_get_level(),
       oc = (int) ak_libakrypt_get_option_by_name( "openssl_compability" );
@@ -1064,6 +1444,23 @@
     result = ak_false;
     goto exit;
   }
+
+ /* зашифрование двумя фрагментами: второй фрагмент использует значение счетчика,
+                                                            сохраненное в контексте ключа */
+  if((( error = ak_bckey_ctr( &bkey, oc ? oc_in : in, myout, 32,
+                                   oc ? oc_ivctr : ivctr, sizeof( ivctr ))) != ak_error_ok ) ||
+     (( error = ak_bckey_ctr( &bkey, ( oc ? oc_in : in ) +32,
+                                                  myout +32, 32, NULL, 0 )) != ak_error_ok )) {
+    ak_error_message( error, __func__ , "wrong counter mode encryption by fragments" );
+    result = ak_false;
+    goto exit;
+  }
+  if( !ak_ptr_is_equal_with_log( myout, oc ? oc_outctr : outctr, sizeof( outctr ))) {
+    ak_error_message( ak_error_not_equal_data, __func__ ,
+              "the counter mode encryption by fragments test from GOST R 34.13-2015 is wrong");
+    result = ak_false;
+    goto exit;
+  }
   if( audit >= ak_log_maximum ) ak_error_message( ak_error_ok, __func__ ,
                 "the counter mode encryption/decryption test from GOST R 34.13-2015 is Ok" );
 
@@ -1157,9 +1554,63 @@
     result = ak_false;
     goto exit;
   }
+ /* зашифрование и расшифрование двумя фрагментами: второй фрагмент использует регистр,
+                                                            сохраненный в контексте ключа */
+  if((( error = ak_bckey_encrypt_cfb( &bkey, oc ? oc_in : in, myout, 16,
+                             oc ? openssl_ivofb : ivofb, sizeof( ivofb ))) != ak_error_ok ) ||
+     (( error = ak_bckey_encrypt_cfb( &bkey, ( oc ? oc_in : in ) +16,
+                                                  myout +16, 48, NULL, 0 )) != ak_error_ok )) {
+    ak_error_message( error, __func__ , "wrong cfb mode encryption by fragments" );
+    result = ak_false;
+    goto exit;
+  }
+  if( !ak_ptr_is_equal_with_log( myout, oc ? openssl_outcfb : outcfb, sizeof( outcfb ))) {
+    ak_error_message( ak_error_not_equal_data, __func__ ,
+                  "the cfb mode encryption by fragments test from GOST R 34.13-2015 is wrong");
+    result = ak_false;
+    goto exit;
+  }
+  if((( error = ak_bckey_decrypt_cfb( &bkey, myout, myout, 16,
+                             oc ? openssl_ivofb : ivofb, sizeof( ivofb ))) != ak_error_ok ) ||
+     (( error = ak_bckey_decrypt_cfb( &bkey, myout +16,
+                                                  myout +16, 48, NULL, 0 )) != ak_error_ok )) {
+    ak_error_message( error, __func__ , "wrong cfb mode decryption by fragments" );
+    result = ak_false;
+    goto exit;
+  }
+  if( !ak_ptr_is_equal_with_log( myout, oc ? oc_in : in, sizeof( in ))) {
+    ak_error_message( ak_error_not_equal_data, __func__ ,
+                  "the cfb mode decryption by fragments test from GOST R 34.13-2015 is wrong");
+    result = ak_false;
+    goto exit;
+  }
   if( audit >= ak_log_maximum ) ak_error_message( ak_error_ok, __func__ ,
                 "the cfb mode encryption/decryption test from GOST R 34.13-2015 is Ok" );
 
+ /* -------------------------------------------------------------------------------------- */
+ /* 7. Сравниваем многоблочные функции с функциями обработки одного блока                   */
+ /*    (количество блоков выбрано так, чтобы проверить и обработку оставшихся блоков)       */
+ /* -------------------------------------------------------------------------------------- */
+  for( i = 0; i < sizeof( mydata ); i++ ) mydata[i] = (ak_uint8)( 7*i + 1 );
+  for( i = 0; i < sizeof( mydata ); i += 16 ) bkey.encrypt( &bkey.key, mydata+i, myout+i );
+  bkey.encrypt_blocks( &bkey.key, mydata, mydata, sizeof( mydata )/16 );
+  if( !ak_ptr_is_equal_with_log( myout, mydata, sizeof( mydata ))) {
+    ak_error_message( ak_error_not_equal_data, __func__ ,
+                                                       "the multiblock encryption is wrong" );
+    result = ak_false;
+    goto exit;
+  }
+  bkey.decrypt_blocks( &bkey.key, mydata, myout, sizeof( mydata )/16 );
+  for( i = 0; i < sizeof( mydata ); i += 16 ) bkey.decrypt( &bkey.key, mydata+i, mydata+i );
+  if( !ak_ptr_is_equal_with_log( myout, mydata, sizeof( mydata ))) {
+    ak_error_message( ak_error_not_equal_data, __func__ ,
+                                                       "the multiblock decryption is wrong" );
+    result = ak_false;
+    goto exit;
+  }
+  if( audit >= ak_log_maximum ) ak_error_message( ak_error_ok, __func__ ,
+                                            "the multiblock encryption/decryption test is Ok" );
+
  /* --------------------------------------------------------------------------- */
  /* 10. Тестируем режим выработки имитовставки (плоская реализация).            */
  /* --------------------------------------------------------------------------- */
@@ -79,6 +79,9 @@
   #ifdef AK_HAVE_BUILTIN_CLMULEPI64
    ak_error_message( ak_error_ok, __func__ , "library applies clmulepi64 instruction" );
   #endif
+  #ifdef AK_HAVE_BUILTIN_CPU_SUPPORTS
+   ak_error_message( ak_error_ok, __func__ , "library applies runtime cpu features detection" );
+  #endif
   #ifdef AK_HAVE_BUILTIN_MULQ_GCC
    ak_error_message( ak_error_ok, __func__ , "library applies assembler code for mulq command" );
   #endif
@@ -100,13 +103,23 @@
 /* ----------------------------------------------------------------------------------------------- */
  int ak_libakrypt_set_openssl_compability( bool_t flag )
 {
-  if( ak_libakrypt_set_option( "openssl_compability", flag ) != ak_error_ok )
-    return ak_error_message( ak_error_get_value(), __func__, "using an incorrect option name" );
+  if( ak_libakrypt_set_option_by_index( ak_option_openssl_compability, flag ) != ak_error_ok )
+    return ak_error_message( ak_error_wrong_option, __func__, "using an incorrect option index" );
   ak_bckey_kuznechik_init_gost_tables();
 
  return ak_error_ok;
 }
 
+/* ----------------------------------------------------------------------------------------------- */
+/*! \return Функция возвращает истину, если установлен режим совместимости с библиотекой openssl,
+    и ложь в противном случае.                                                                     */
+/* ----------------------------------------------------------------------------------------------- */
+ bool_t ak_libakrypt_get_openssl_compability( void )
+{
+  return ak_libakrypt_get_option_by_index( ak_option_openssl_compability ) == 1 ?
+                                                                            ak_true : ak_false;
+}
+
 /* ----------------------------------------------------------------------------------------------- */
 /*! @return Возвращает ak_true в случае успешного тестирования. В случае возникновения ошибки
     функция возвращает ak_false. Код ошибки можеть быть получен с помощью
@@ -351,12 +364,30 @@
      return ak_false;
    }
 
+ /* вычисляем итерационные ключи первого вызова функции сжатия Стрибог */
+   if(( error = ak_hash_streebog_init_tables()) != ak_error_ok ) {
+     ak_error_message( error, __func__, "initialization of streebog tables is wrong" );
+     return ak_false;
+   }
+
  /* инициализируем константные таблицы для алгоритма Кузнечик */
    if(( error = ak_bckey_kuznechik_init_gost_tables()) != ak_error_ok ) {
     ak_error_message( error, __func__, "initialization of context manager is wrong" );
      return ak_false;
    }
 
+ /* инициализируем развернутые таблицы замен для алгоритма Магма */
+   if(( error = ak_bckey_magma_init_tables()) != ak_error_ok ) {
+     ak_error_message( error, __func__, "initialization of magma tables is wrong" );
+     return ak_false;
+   }
+
+ /* инициализируем развернутые таблицы для алгоритма AES-128 */
+   if(( error = ak_bckey_aes128_init_tables()) != ak_error_ok ) {
+     ak_error_message( error, __func__, "initialization of aes128 tables is wrong" );
+     return ak_false;
+   }
+
  /* в случае, когда компилируются сетевые функции, инициализируем работу с сокетами */
 #ifdef AK_HAVE_WINDOWS_H
   #ifdef LIBAKRYPT_NETWORK
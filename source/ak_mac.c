@@ -4,7 +4,7 @@
 /*  Файл ak_mac.c                                                                                  */
 /*  - содержит реализацию алгоритмов итерационного сжатия                                          */
 /* ----------------------------------------------------------------------------------------------- */
- #include <libakrypt.h>
+ #include <libakrypt-internal.h>
 
 /* ----------------------------------------------------------------------------------------------- */
  int ak_mac_create( ak_mac mctx, const size_t size, ak_pointer ictx,
@@ -80,6 +80,7 @@
 /* ----------------------------------------------------------------------------------------------- */
  int ak_mac_update( ak_mac mctx, const ak_pointer in, const size_t size )
 {
+  int error = ak_error_ok;
   ak_uint8 *ptrin = (ak_uint8 *) in;
   size_t quot = 0, offset = 0, newsize = size;
 
@@ -99,20 +100,26 @@
     offset = mctx->bsize - mctx->length;
     memcpy( mctx->data + mctx->length, ptrin, offset );
 
-   /* обновляем значение контекста функции и очищаем временный буффер */
-    mctx->update( mctx->ctx, mctx->data, mctx->bsize );
-    memset( mctx->data, 0, mctx->bsize );
+   /* обновляем значение контекста функции; очищать временный буффер не нужно,
+      поскольку при следующем заполнении он будет перезаписан, а функции finalize
+      используют только mctx->length октетов буффера */
     mctx->length = 0;
+    if(( error = mctx->update( mctx->ctx, mctx->data, mctx->bsize )) != ak_error_ok )
+      return ak_error_message( error, __func__, "incorrect updating of internal context" );
     ptrin += offset;
     newsize -= offset;
   }
 
- /* теперь обрабатываем входные данные с пустым временным буффером */
+ /* теперь обрабатываем входные данные с пустым временным буффером:
+    часть, кратная величине bsize, передается функции сжатия без копирования */
   if( newsize != 0 ) {
     quot = newsize/mctx->bsize;
     offset = quot*mctx->bsize;
    /* обрабатываем часть, кратную величине bsize */
-    if( quot > 0 ) mctx->update( mctx->ctx, ptrin, offset );
+    if( quot > 0 ) {
+      if(( error = mctx->update( mctx->ctx, ptrin, offset )) != ak_error_ok )
+        return ak_error_message( error, __func__, "incorrect updating of internal context" );
+    }
    /* хвост оставляем на следующий раз */
     if( offset < newsize ) {
       mctx->length = newsize - offset;
@@ -201,6 +208,29 @@
     возвращается код ошибки.                                                                       */
 /* ----------------------------------------------------------------------------------------------- */
  int ak_mac_file( ak_mac mctx, const char* filename, ak_pointer out, const size_t out_size )
+{
+ return ak_mac_file_with_block_size( mctx, filename, 0, out, out_size );
+}
+
+/* ----------------------------------------------------------------------------------------------- */
+/*! Функция аналогична функции ak_mac_file(), однако позволяет задать минимальную длину
+    фрагмента, считываемого из файла и передаваемого в функцию обновления контекста за один вызов.
+    Это позволяет алгоритмам, обрабатывающим большие фрагменты данных параллельно
+    (например, древовидному режиму хеширования Стрибог), получать данные порциями нужной длины.
+
+    @param mctx Указатель на контекст итерационного сжатия.
+    @param filename имя сжимаемого файла
+    @param size Минимальная длина считываемого фрагмента (в октетах); значение должно быть
+    кратно длине блока контекста `mctx`. Нулевое значение означает, что используется длина блока
+    файловой системы.
+    @param out Область памяти, куда будет помещен результат.
+    @param out_size Размер области памяти (в октетах), в которую будет помещен результат.
+
+    @return В случае успеха функция возвращает ноль (\ref ak_error_ok). В противном случае
+    возвращается код ошибки.                                                                       */
+/* ----------------------------------------------------------------------------------------------- */
+ int ak_mac_file_with_block_size( ak_mac mctx, const char* filename, const size_t size,
+                                                           ak_pointer out, const size_t out_size )
 {
   size_t len = 0;
   struct file file;
@@ -226,7 +256,7 @@
   }
 
  /* готовим область для хранения данных */
-  block_size = ak_max( ( size_t )file.blksize, mctx->bsize );
+  block_size = ak_max( ak_max( ( size_t )file.blksize, mctx->bsize ), size );
  /* здесь мы выделяем локальный буффер для считывания/обработки данных */
   if(( localbuffer = ( ak_uint8 * ) ak_aligned_malloc( block_size )) == NULL ) {
     ak_file_close( &file );
@@ -5,6 +5,11 @@
 /*  Файл ak_magma.h                                                                                */
 /*  - содержит реализацию алгоритма блочного шифрования Магма,                                     */
 /*    регламентированного ГОСТ Р 34.12-2015                                                        */
+/* ----------------------------------------------------------------------------------------------- */
+#ifdef AK_HAVE_BUILTIN_MM256_SLL
+ #include <immintrin.h>
+#endif
+
 /* ----------------------------------------------------------------------------------------------- */
  #include <libakrypt-internal.h>
 
@@ -317,6 +322,37 @@
  };
 
 /* ----------------------------------------------------------------------------------------------- */
+/*! \brief Развернутые таблицы замен: каждый элемент содержит результат замены байта, сдвинутый
+    на свое место в 32-х битном слове и циклически сдвинутый на 11 разрядов влево. */
+ static ak_uint32 magma_tboxes[2][2][4][256];
+
+/* ----------------------------------------------------------------------------------------------- */
+/*! Функция вычисляет развернутые таблицы замен, позволяющие реализовать
+    нелинейное преобразование и циклический сдвиг одного такта алгоритма Магма
+    с помощью четырех обращений к памяти.
+
+    @return Функция возвращает \ref ak_error_ok.                                                   */
+/* ----------------------------------------------------------------------------------------------- */
+ int ak_bckey_magma_init_tables( void )
+{
+  ak_uint32 x;
+  size_t i, j, k, l;
+
+  for( j = 0; j < 2; j++ )
+   for( i = 0; i < 2; i++ )
+    for( k = 0; k < 4; k++ )
+     for( l = 0; l < 256; l++ ) {
+        x = ( ak_uint32 ) magma_boxes[j][i][k][l] << ( 8*k );
+        magma_tboxes[j][i][k][l] = x<<11 | x>>(32-11);
+     }
+
+ return ak_error_ok;
+}
+
+/* ----------------------------------------------------------------------------------------------- */
+/*! \brief Количество случайных траекторий, вырабатываемых за одно обращение к генератору. */
+ #define ak_magma_walk_pool_size (256)
+
 /*! \brief  Структура для хранения внутренних данных в маскированной реализации Магмы. */
  struct magma_encrypted_keys {
   /*! \brief  Две ключевые последовательности - прямая и инвертированная. */
@@ -324,8 +360,32 @@
   /*! \brief  Две маски для двух ключевых последовательностей, соответственно,
       прямой и инвертированной. */
   ak_uint32 inmask[2][8];
+  /*! \brief  Пул заранее выработанных случайных траекторий. */
+  ak_uint32 walk[ak_magma_walk_pool_size];
+  /*! \brief  Индекс первой неиспользованной траектории в пуле. */
+  size_t walk_index;
 };
 
+/* ----------------------------------------------------------------------------------------------- */
+/*! \brief Функция возвращает очередную случайную траекторию из пула, связанного с ключом.
+    \details Пул заполняется генератором случайных чисел, связанным с ключом, сразу для
+    \ref ak_magma_walk_pool_size траекторий; поэтому при шифровании одного блока выработка
+    траектории, как правило, сводится к одному чтению из памяти.
+
+    @param skey Контекст секретного ключа.
+    @return Случайная траектория.                                                                  */
+/* ----------------------------------------------------------------------------------------------- */
+ static inline ak_uint32 ak_magma_next_walk( ak_skey skey )
+{
+  struct magma_encrypted_keys *data = ( struct magma_encrypted_keys *)skey->data;
+
+  if( data->walk_index >= ak_magma_walk_pool_size ) {
+    skey->generator.random( &skey->generator, data->walk, sizeof( data->walk ));
+    data->walk_index = 0;
+  }
+ return data->walk[data->walk_index++];
+}
+
 /* ----------------------------------------------------------------------------------------------- */
 /*! \brief Функция реализует один такт шифрующего преобразования ГОСТ 34.12-2015 (Mагма).
 
@@ -334,9 +394,8 @@
 /* ----------------------------------------------------------------------------------------------- */
  static inline ak_uint32 ak_magma_gostf_boxes( ak_uint32 x, const ak_uint8 i, const ak_uint8 j )
 {
-  x = magma_boxes[j][i][3][x>>24 & 255] << 24 | magma_boxes[j][i][2][x>>16 & 255] << 16 |
-                           magma_boxes[j][i][1][x>> 8 & 255] <<  8 | magma_boxes[j][i][0][x & 255];
-  return x<<11 | x>>(32-11);
+  return magma_tboxes[j][i][3][x>>24 & 255] ^ magma_tboxes[j][i][2][x>>16 & 255] ^
+                           magma_tboxes[j][i][1][x>> 8 & 255] ^ magma_tboxes[j][i][0][x & 255];
 }
 
 /* ----------------------------------------------------------------------------------------------- */
@@ -355,7 +414,7 @@
   register ak_uint32 n3, n4, p = 0;
 
  /* вырабатываем случайную траекторию */
-  skey->generator.random( &skey->generator, &mv, sizeof( ak_uint32 ));
+  mv = ak_magma_next_walk( skey );
 
  /* формируем вектор раундовых поворотов */
   m[0] = m[33] = 0;
@@ -430,7 +489,7 @@
   register ak_uint32 n3, n4, p = 0;
 
  /* вырабатываем случайную траекторию */
-  skey->generator.random( &skey->generator, &mv, sizeof( ak_uint32 ));
+  mv = ak_magma_next_walk( skey );
 
  /* формируем вектор раундовых поворотов */
   m[0] = m[33] = 0;
@@ -505,7 +564,7 @@
   register ak_uint32 n3, n4, p = 0;
 
  /* вырабатываем случайную траекторию */
-  skey->generator.random( &skey->generator, &mv, sizeof( ak_uint32 ));
+  mv = ak_magma_next_walk( skey );
 
  /* формируем вектор раундовых поворотов */
   m[0] = m[1] = m[32] = m[33] = 0;
@@ -581,7 +640,7 @@
   register ak_uint32 n3, n4, p = 0;
 
  /* вырабатываем случайную траекторию */
-  skey->generator.random( &skey->generator, &mv, sizeof( ak_uint32 ));
+  mv = ak_magma_next_walk( skey );
 
  /* формируем вектор раундовых поворотов */
   m[0] = m[1] = m[32] = m[33] = 0;
@@ -639,6 +698,266 @@
 #endif
 }
 
+/* ----------------------------------------------------------------------------------------------- */
+/*                 многоблочная реализация маскированного алгоритма Магма                          */
+/* ----------------------------------------------------------------------------------------------- */
+/*! \brief Количество блоков, одновременно обрабатываемых многоблочными функциями. */
+ #define ak_magma_interleave    (4)
+/*! \brief Количество блоков, одновременно обрабатываемых функциями, использующими
+    256-ти битные регистры. */
+ #define ak_magma_interleave256 (8)
+
+/*! \brief Порядок использования раундовых ключей при зашифровании. */
+ static const ak_uint8 magma_encrypt_order[32] = {
+   7, 6, 5, 4, 3, 2, 1, 0, 7, 6, 5, 4, 3, 2, 1, 0, 7, 6, 5, 4, 3, 2, 1, 0, 0, 1, 2, 3, 4, 5, 6, 7 };
+/*! \brief Порядок использования раундовых ключей при расшифровании. */
+ static const ak_uint8 magma_decrypt_order[32] = {
+   7, 6, 5, 4, 3, 2, 1, 0, 0, 1, 2, 3, 4, 5, 6, 7, 0, 1, 2, 3, 4, 5, 6, 7, 0, 1, 2, 3, 4, 5, 6, 7 };
+
+#ifdef AK_LITTLE_ENDIAN
+ #define ak_magma_word( x, oc ) ( (oc) ? bswap_32( x ) : (x) )
+#else
+ #define ak_magma_word( x, oc ) ( (oc) ? (x) : bswap_32( x ))
+#endif
+
+/* ----------------------------------------------------------------------------------------------- */
+/*! \brief Функция вырабатывает случайную траекторию (вектор раундовых поворотов),
+    общую для группы одновременно обрабатываемых блоков.
+
+    @param skey Контекст секретного ключа.
+    @param m Массив из 34 элементов, в который помещается траектория.
+    @param oc Флаг режима совместимости с openssl.                                                 */
+/* ----------------------------------------------------------------------------------------------- */
+ static inline void ak_magma_random_walk( ak_skey skey, ak_uint8 *m, int oc )
+{
+  ak_uint32 i, mv = 0;
+
+  mv = ak_magma_next_walk( skey );
+  m[0] = m[33] = 0;
+  for( i = 0; i < 32; i++ ) m[i+1] = (ak_uint8)(( mv >> i) & 0x01 );
+  if( oc ) m[1] = m[32] = 0;
+}
+
+/* ----------------------------------------------------------------------------------------------- */
+/*! \brief Функция загружает группу блоков и накладывает на них начальную маску траектории. */
+/* ----------------------------------------------------------------------------------------------- */
+ static inline void ak_magma_load_blocks( const ak_uint32 *in, ak_uint32 *n3, ak_uint32 *n4,
+                                                       size_t count, const ak_uint8 *m, int oc )
+{
+  size_t b;
+  for( b = 0; b < count; b++ ) {
+     ak_uint32 w0 = ak_magma_word( in[2*b], oc ) ^ ( m[1] * 0xffffffff ),
+               w1 = ak_magma_word( in[2*b+1], oc );
+     n3[b] = oc ? w1 : w0;
+     n4[b] = oc ? w0 : w1;
+  }
+}
+
+/* ----------------------------------------------------------------------------------------------- */
+/*! \brief Функция снимает конечную маску траектории и сохраняет группу блоков. */
+/* ----------------------------------------------------------------------------------------------- */
+ static inline void ak_magma_store_blocks( ak_uint32 *out, const ak_uint32 *n3,
+                                  const ak_uint32 *n4, size_t count, const ak_uint8 *m, int oc )
+{
+  size_t b;
+  for( b = 0; b < count; b++ ) {
+     ak_uint32 w = n4[b] ^ ( m[32] * 0xffffffff );
+     out[2*b] = ak_magma_word( oc ? n3[b] : w, oc );
+     out[2*b+1] = ak_magma_word( oc ? w : n3[b], oc );
+  }
+}
+
+/* ----------------------------------------------------------------------------------------------- */
+/*! \brief Функция реализует 32 такта алгоритма Магма для группы из \ref ak_magma_interleave
+    блоков, использующих одну и ту же траекторию `m`.
+
+    @param skey Контекст секретного ключа.
+    @param n3 Младшие половины блоков.
+    @param n4 Старшие половины блоков.
+    @param m Траектория, выработанная функцией ak_magma_random_walk().
+    @param order Порядок использования раундовых ключей.                                           */
+/* ----------------------------------------------------------------------------------------------- */
+ static inline void ak_magma_rounds_interleave( ak_skey skey, ak_uint32 *n3, ak_uint32 *n4,
+                                                      const ak_uint8 *m, const ak_uint8 *order )
+{
+  int r, b;
+  ak_uint32 mask, key;
+  ak_uint32 (*t)[256] = NULL;
+  ak_uint32 (*kp)[8] = ((struct magma_encrypted_keys *)skey->data)->inkey;
+  ak_uint32 (*mp)[8] = ((struct magma_encrypted_keys *)skey->data)->inmask;
+
+  for( r = 1; r < 33; r += 2 ) {
+     t = magma_tboxes[m[r]][m[r+1]^m[r-1]];
+     mask = mp[m[r]][order[r-1]]; key = kp[m[r]][order[r-1]] + m[r];
+     for( b = 0; b < ak_magma_interleave; b++ ) {
+        ak_uint32 p = n3[b] - mask; p += key;
+        n4[b] ^= t[3][p>>24] ^ t[2][p>>16 & 255] ^ t[1][p>>8 & 255] ^ t[0][p & 255];
+     }
+     t = magma_tboxes[m[r+1]][m[r+2]^m[r]];
+     mask = mp[m[r+1]][order[r]]; key = kp[m[r+1]][order[r]] + m[r+1];
+     for( b = 0; b < ak_magma_interleave; b++ ) {
+        ak_uint32 p = n4[b] - mask; p += key;
+        n3[b] ^= t[3][p>>24] ^ t[2][p>>16 & 255] ^ t[1][p>>8 & 255] ^ t[0][p & 255];
+     }
+  }
+}
+
+/* ----------------------------------------------------------------------------------------------- */
+/*! \brief Функция обрабатывает последовательность блоков группами по \ref ak_magma_interleave
+    блоков; случайная траектория вырабатывается один раз для каждой группы.                        */
+/* ----------------------------------------------------------------------------------------------- */
+ static inline void ak_magma_process_blocks( ak_skey skey, const ak_uint32 *inptr,
+                             ak_uint32 *outptr, size_t blocks, const ak_uint8 *order, int oc )
+{
+  ak_uint8 m[34];
+  ak_uint32 n3[ak_magma_interleave] = { 0 }, n4[ak_magma_interleave] = { 0 };
+  size_t count;
+
+  while( blocks > 0 ) {
+     count = ak_min( blocks, ak_magma_interleave );
+     ak_magma_random_walk( skey, m, oc );
+     ak_magma_load_blocks( inptr, n3, n4, count, m, oc );
+     ak_magma_rounds_interleave( skey, n3, n4, m, order );
+     ak_magma_store_blocks( outptr, n3, n4, count, m, oc );
+     inptr += 2*count; outptr += 2*count; blocks -= count;
+  }
+}
+
+/* ----------------------------------------------------------------------------------------------- */
+/*! \brief Функция зашифрования последовательности блоков информации алгоритмом Магма.           */
+/* ----------------------------------------------------------------------------------------------- */
+ static void ak_magma_encrypt_blocks_with_random_walk( ak_skey skey,
+                                                  ak_pointer in, ak_pointer out, size_t blocks )
+{
+  ak_magma_process_blocks( skey, in, out, blocks, magma_encrypt_order, 0 );
+}
+
+/* ----------------------------------------------------------------------------------------------- */
+/*! \brief Функция расшифрования последовательности блоков информации алгоритмом Магма.          */
+/* ----------------------------------------------------------------------------------------------- */
+ static void ak_magma_decrypt_blocks_with_random_walk( ak_skey skey,
+                                                  ak_pointer in, ak_pointer out, size_t blocks )
+{
+  ak_magma_process_blocks( skey, in, out, blocks, magma_decrypt_order, 0 );
+}
+
+/* ----------------------------------------------------------------------------------------------- */
+/*! \brief Функция зашифрования последовательности блоков информации алгоритмом Магма
+    в режиме совместимости с openssl.                                                              */
+/* ----------------------------------------------------------------------------------------------- */
+ static void ak_magma_encrypt_blocks_with_random_walk_oc( ak_skey skey,
+                                                  ak_pointer in, ak_pointer out, size_t blocks )
+{
+  ak_magma_process_blocks( skey, in, out, blocks, magma_encrypt_order, 1 );
+}
+
+/* ----------------------------------------------------------------------------------------------- */
+/*! \brief Функция расшифрования последовательности блоков информации алгоритмом Магма
+    в режиме совместимости с openssl.                                                              */
+/* ----------------------------------------------------------------------------------------------- */
+ static void ak_magma_decrypt_blocks_with_random_walk_oc( ak_skey skey,
+                                                  ak_pointer in, ak_pointer out, size_t blocks )
+{
+  ak_magma_process_blocks( skey, in, out, blocks, magma_decrypt_order, 1 );
+}
+
+#ifdef AK_HAVE_BUILTIN_MM256_SLL
+/* ----------------------------------------------------------------------------------------------- */
+/*! \brief Вычисление значения развернутых таблиц замен для восьми 32-х битных слов. */
+/* ----------------------------------------------------------------------------------------------- */
+ static inline __m256i ak_magma_tboxes_avx2( ak_uint32 (*t)[256], __m256i p )
+{
+  const __m256i ff = _mm256_set1_epi32( 0xff );
+  __m256i x = _mm256_i32gather_epi32( (const int *)t[0], _mm256_and_si256( p, ff ), 4 );
+  x = _mm256_xor_si256( x, _mm256_i32gather_epi32( (const int *)t[1],
+                                         _mm256_and_si256( _mm256_srli_epi32( p, 8 ), ff ), 4 ));
+  x = _mm256_xor_si256( x, _mm256_i32gather_epi32( (const int *)t[2],
+                                        _mm256_and_si256( _mm256_srli_epi32( p, 16 ), ff ), 4 ));
+ return _mm256_xor_si256( x, _mm256_i32gather_epi32( (const int *)t[3],
+                                                             _mm256_srli_epi32( p, 24 ), 4 ));
+}
+
+/* ----------------------------------------------------------------------------------------------- */
+/*! \brief Функция обрабатывает последовательность блоков группами по \ref ak_magma_interleave256
+    блоков, размещая половины блоков в 256-ти битных регистрах; для выборки из таблиц замен
+    используются команды gather.                                                                   */
+/* ----------------------------------------------------------------------------------------------- */
+ static inline void ak_magma_process_blocks_avx2( ak_skey skey, const ak_uint32 *inptr,
+                             ak_uint32 *outptr, size_t blocks, const ak_uint8 *order, int oc )
+{
+  int r;
+  ak_uint8 m[34];
+  __m256i v3, v4;
+  ak_uint32 n3[ak_magma_interleave256] = { 0 }, n4[ak_magma_interleave256] = { 0 };
+  ak_uint32 (*kp)[8] = ((struct magma_encrypted_keys *)skey->data)->inkey;
+  ak_uint32 (*mp)[8] = ((struct magma_encrypted_keys *)skey->data)->inmask;
+  size_t count;
+
+  while( blocks > 0 ) {
+     count = ak_min( blocks, ak_magma_interleave256 );
+     ak_magma_random_walk( skey, m, oc );
+     ak_magma_load_blocks( inptr, n3, n4, count, m, oc );
+     v3 = _mm256_loadu_si256( (const __m256i *) n3 );
+     v4 = _mm256_loadu_si256( (const __m256i *) n4 );
+     for( r = 1; r < 33; r += 2 ) {
+        __m256i p = _mm256_sub_epi32( v3, _mm256_set1_epi32( (int) mp[m[r]][order[r-1]] ));
+        p = _mm256_add_epi32( p, _mm256_set1_epi32( (int)( kp[m[r]][order[r-1]] + m[r] )));
+        v4 = _mm256_xor_si256( v4, ak_magma_tboxes_avx2( magma_tboxes[m[r]][m[r+1]^m[r-1]], p ));
+
+        p = _mm256_sub_epi32( v4, _mm256_set1_epi32( (int) mp[m[r+1]][order[r]] ));
+        p = _mm256_add_epi32( p, _mm256_set1_epi32( (int)( kp[m[r+1]][order[r]] + m[r+1] )));
+        v3 = _mm256_xor_si256( v3, ak_magma_tboxes_avx2( magma_tboxes[m[r+1]][m[r+2]^m[r]], p ));
+     }
+     _mm256_storeu_si256( (__m256i *) n3, v3 );
+     _mm256_storeu_si256( (__m256i *) n4, v4 );
+     ak_magma_store_blocks( outptr, n3, n4, count, m, oc );
+     inptr += 2*count; outptr += 2*count; blocks -= count;
+  }
+}
+
+/* ----------------------------------------------------------------------------------------------- */
+ static void ak_magma_encrypt_blocks_with_random_walk_avx2( ak_skey skey,
+                                                  ak_pointer in, ak_pointer out, size_t blocks )
+{
+  ak_magma_process_blocks_avx2( skey, in, out, blocks, magma_encrypt_order, 0 );
+}
+
+/* ----------------------------------------------------------------------------------------------- */
+ static void ak_magma_decrypt_blocks_with_random_walk_avx2( ak_skey skey,
+                                                  ak_pointer in, ak_pointer out, size_t blocks )
+{
+  ak_magma_process_blocks_avx2( skey, in, out, blocks, magma_decrypt_order, 0 );
+}
+
+/* ----------------------------------------------------------------------------------------------- */
+ static void ak_magma_encrypt_blocks_with_random_walk_oc_avx2( ak_skey skey,
+                                                  ak_pointer in, ak_pointer out, size_t blocks )
+{
+  ak_magma_process_blocks_avx2( skey, in, out, blocks, magma_encrypt_order, 1 );
+}
+
+/* ----------------------------------------------------------------------------------------------- */
+ static void ak_magma_decrypt_blocks_with_random_walk_oc_avx2( ak_skey skey,
+                                                  ak_pointer in, ak_pointer out, size_t blocks )
+{
+  ak_magma_process_blocks_avx2( skey, in, out, blocks, magma_decrypt_order, 1 );
+}
+
+/* ----------------------------------------------------------------------------------------------- */
+/*! \brief Функция проверяет, поддерживает ли процессор команды AVX2.
+    \return Функция возвращает \ref ak_true, если такие команды поддерживаются.                   */
+/* ----------------------------------------------------------------------------------------------- */
+ static bool_t ak_magma_cpu_supports_avx2( void )
+{
+ #ifdef AK_HAVE_BUILTIN_CPU_SUPPORTS
+  __builtin_cpu_init();
+  return __builtin_cpu_supports( "avx2" ) ? ak_true : ak_false;
+ #else
+  return ak_true; /* команды доступны на этапе компиляции */
+ #endif
+}
+#endif
+
 /* ----------------------------------------------------------------------------------------------- */
 /*! \brief Функция уничтожения развернутых ключей для маскированной магмы
 
@@ -689,6 +1008,7 @@
 
  /* выставляем флаги того, что память выделена */
   memset( data, 0, sizeof( struct magma_encrypted_keys ));
+  data->walk_index = ak_magma_walk_pool_size; /* пул траекторий заполняется при первом обращении */
   skey->data = ( ak_pointer )data;
   skey->flags |= ak_key_flag_data_not_free;
 
@@ -856,8 +1176,10 @@
   x.v[0] -= y.v[0]; x.v[1] -= y.v[1];
   skey->icode = x.x;
 
- /* устанавливаем флаг */
+ /* устанавливаем флаг и сбрасываем результат предыдущей проверки,
+    а также признак вычисленных из ключа значений, поскольку значение ключа изменилось */
   skey->flags |= ak_key_flag_set_icode;
+  skey->flags &= ( 0xFFFFFFFFFFFFFFFFLL ^ ( ak_key_flag_icode_checked|ak_key_flag_precomputed ));
 
  return ak_error_ok;
 }
@@ -914,16 +1236,15 @@
 /* ----------------------------------------------------------------------------------------------- */
  int ak_bckey_create_magma( ak_bckey bkey )
 {
-  int error = ak_error_ok, oc = (int) ak_libakrypt_get_option_by_name( "openssl_compability" );
+  int error = ak_error_ok, oc = 0;
 
   if( bkey == NULL ) return ak_error_message( ak_error_null_pointer, __func__,
                                                "using null pointer to block cipher key context" );
-  if(( oc < 0 ) || ( oc > 1 )) return ak_error_message( ak_error_wrong_option, __func__,
-                                                "wrong value for \"openssl_compability\" option" );
 
  /* создаем ключ алгоритма шифрования и определяем его методы */
   if(( error = ak_bckey_create( bkey, 32, 8 )) != ak_error_ok )
     return ak_error_message( error, __func__, "wrong initalization of block cipher key context" );
+  oc = bkey->key.options.openssl_compability;
 
  /* устанавливаем OID алгоритма шифрования */
   if(( bkey->key.oid = ak_oid_find_by_name( "magma" )) == NULL ) {
@@ -946,11 +1267,29 @@
   if( oc ) {
     bkey->encrypt = ak_magma_encrypt_with_random_walk_oc;
     bkey->decrypt = ak_magma_decrypt_with_random_walk_oc;
+    bkey->encrypt_blocks = ak_magma_encrypt_blocks_with_random_walk_oc;
+    bkey->decrypt_blocks = ak_magma_decrypt_blocks_with_random_walk_oc;
   }
    else {
     bkey->encrypt = ak_magma_encrypt_with_random_walk;
     bkey->decrypt = ak_magma_decrypt_with_random_walk;
+    bkey->encrypt_blocks = ak_magma_encrypt_blocks_with_random_walk;
+    bkey->decrypt_blocks = ak_magma_decrypt_blocks_with_random_walk;
   }
+
+ /* многоблочные функции выбираются в зависимости от возможностей процессора */
+#ifdef AK_HAVE_BUILTIN_MM256_SLL
+  if( ak_magma_cpu_supports_avx2( )) {
+    if( oc ) {
+      bkey->encrypt_blocks = ak_magma_encrypt_blocks_with_random_walk_oc_avx2;
+      bkey->decrypt_blocks = ak_magma_decrypt_blocks_with_random_walk_oc_avx2;
+    }
+     else {
+      bkey->encrypt_blocks = ak_magma_encrypt_blocks_with_random_walk_avx2;
+      bkey->decrypt_blocks = ak_magma_decrypt_blocks_with_random_walk_avx2;
+    }
+  }
+#endif
   return error;
 }
 
@@ -1102,7 +1441,7 @@
   struct bckey mkey;
   ak_uint8 icode[8];
   size_t i = 0, j = 0;
-  ak_uint8 myout[256];
+  ak_uint8 myout[256], mydata[152];
   bool_t result = ak_true;
   int error = ak_error_ok, audit = ak_log_get_level(),
       oc = (int) ak_libakrypt_get_option_by_name( "openssl_compability" );
@@ -1320,6 +1659,31 @@
                 "the cfb mode encryption/decryption test from GOST R 34.13-2015 is Ok" );
 
 
+ /* -------------------------------------------------------------------------------------- */
+ /* 7. Сравниваем многоблочные функции с функциями обработки одного блока                   */
+ /*    (количество блоков выбрано так, чтобы проверить и обработку оставшихся блоков)       */
+ /* -------------------------------------------------------------------------------------- */
+  for( i = 0; i < sizeof( mydata ); i++ ) mydata[i] = (ak_uint8)( 7*i + 1 );
+  for( i = 0; i < sizeof( mydata ); i += 8 ) mkey.encrypt( &mkey.key, mydata+i, myout+i );
+  mkey.encrypt_blocks( &mkey.key, mydata, mydata, sizeof( mydata )/8 );
+  if( !ak_ptr_is_equal_with_log( myout, mydata, sizeof( mydata ))) {
+    ak_error_message( ak_error_not_equal_data, __func__ ,
+                                                       "the multiblock encryption is wrong" );
+    result = ak_false;
+    goto exit;
+  }
+  mkey.decrypt_blocks( &mkey.key, mydata, myout, sizeof( mydata )/8 );
+  for( i = 0; i < sizeof( mydata ); i += 8 ) mkey.decrypt( &mkey.key, mydata+i, mydata+i );
+  if( !ak_ptr_is_equal_with_log( myout, mydata, sizeof( mydata ))) {
+    ak_error_message( ak_error_not_equal_data, __func__ ,
+                                                       "the multiblock decryption is wrong" );
+    result = ak_false;
+    goto exit;
+  }
+  if( audit >= ak_log_maximum ) ak_error_message( ak_error_ok, __func__ ,
+                                            "the multiblock encryption/decryption test is Ok" );
+
+
  /* ----------------------------------------------------------------- */
  /* 10. Тестируем режим выработки имитовставки (плоская реализация).  */
  /* ----------------------------------------------------------------- */
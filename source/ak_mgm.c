@@ -51,23 +51,6 @@
     \note Алгоритм аутентифицированного шифрования может не принимать на вход зашифровываемые
     данные. В этом случае алгоритм должен действовать как обычный алгоритм имитозащиты.   */
 
-/* ----------------------------------------------------------------------------------------------- */
-/*! \brief Структура, содержащая текущее состояние внутренних переменных режима `mgm`
-   аутентифицированного шифрования. */
- typedef struct mgm_ctx {
-  /*! \brief Текущее значение имитовставки. */
-   ak_uint128 sum;
-  /*! \brief Счетчик, значения которого используются при шифровании информации. */
-   ak_uint128 ycount;
-  /*! \brief Счетчик, значения которого используются при выработке имитовставки. */
-   ak_uint128 zcount;
-  /*! \brief Размер обработанных зашифровываемых/расшифровываемых данных в битах. */
-   ssize_t pbitlen;
-  /*! \brief Размер обработанных дополнительных данных в битах. */
-   ssize_t abitlen;
-  /*! \brief Флаги состояния контекста. */
-   ak_uint32 flags;
-} *ak_mgm_ctx;
 /** @} */
 
 /* ----------------------------------------------------------------------------------------------- */
@@ -159,6 +142,119 @@
 
 #endif
 
+/* ----------------------------------------------------------------------------------------------- */
+/*! \brief Максимальное количество блоков, обрабатываемых за один вызов
+    функций ak_mgm_astep128_blocks(), ak_mgm_estep128_blocks() и их 64-х битных аналогов. */
+ #define ak_mgm_batch_blocks    (8)
+
+/* ----------------------------------------------------------------------------------------------- */
+/*! Функция обрабатывает `count` последовательно расположенных блоков данных для
+    128-ми битного шифра. Значения счетчика `zcount` сначала зашифровываются все вместе
+    с помощью функции ak_bckey_encrypt_blocks(), после чего сумма произведений вычисляется
+    функцией ak_gf128_mul_sum() с однократным приведением по модулю.
+
+    @param ctx Контекст внутреннего состояния алгоритма.
+    @param authenticationKey Ключ выработки имитовставки.
+    @param data Указатель на обрабатываемые блоки данных.
+    @param count Количество блоков, не превосходящее \ref ak_mgm_batch_blocks.                     */
+/* ----------------------------------------------------------------------------------------------- */
+ static inline void ak_mgm_astep128_blocks( ak_mgm_ctx ctx, ak_bckey authenticationKey,
+                                                         const ak_pointer data, const size_t count )
+{
+  size_t i = 0;
+  ak_uint128 z[ak_mgm_batch_blocks], h[ak_mgm_batch_blocks];
+
+  for( i = 0; i < count; i++ ) {
+     z[i] = ctx->zcount;
+#ifdef AK_LITTLE_ENDIAN
+     ctx->zcount.q[1]++;
+#else
+     ctx->zcount.q[1] = bswap_64( bswap_64( ctx->zcount.q[1] ) + 1 );
+#endif
+  }
+  ak_bckey_encrypt_blocks( authenticationKey, z, h, count );
+  ak_gf128_mul_sum( z, h, data, count );
+  ctx->sum.q[0] ^= z[0].q[0];
+  ctx->sum.q[1] ^= z[0].q[1];
+}
+
+/* ----------------------------------------------------------------------------------------------- */
+/*! Функция зашифровывает (расшифровывает) `count` последовательно расположенных блоков данных
+    128-ми битным шифром. Значения счетчика `ycount` зашифровываются все вместе
+    с помощью функции ak_bckey_encrypt_blocks().
+
+    @param ctx Контекст внутреннего состояния алгоритма.
+    @param encryptionKey Ключ шифрования.
+    @param in Указатель на входные блоки данных.
+    @param out Указатель на область памяти, куда помещаются выходные блоки;
+    может совпадать с указателем `in`.
+    @param count Количество блоков, не превосходящее \ref ak_mgm_batch_blocks.                     */
+/* ----------------------------------------------------------------------------------------------- */
+ static inline void ak_mgm_estep128_blocks( ak_mgm_ctx ctx, ak_bckey encryptionKey,
+                                const ak_uint64 *in, ak_uint64 *out, const size_t count )
+{
+  size_t i = 0;
+  ak_uint128 y[ak_mgm_batch_blocks], e[ak_mgm_batch_blocks];
+
+  for( i = 0; i < count; i++ ) {
+     y[i] = ctx->ycount;
+#ifdef AK_LITTLE_ENDIAN
+     ctx->ycount.q[0]++;
+#else
+     ctx->ycount.q[0] = bswap_64( bswap_64( ctx->ycount.q[0] ) + 1 );
+#endif
+  }
+  ak_bckey_encrypt_blocks( encryptionKey, y, e, count );
+  for( i = 0; i < count; i++ ) {
+     out[2*i] = in[2*i] ^ e[i].q[0];
+     out[2*i+1] = in[2*i+1] ^ e[i].q[1];
+  }
+}
+
+/* ----------------------------------------------------------------------------------------------- */
+/*! Функция является аналогом функции ak_mgm_astep128_blocks() для 64-х битного шифра.
+    Сумма произведений вычисляется функцией ak_gf64_mul_sum().                                     */
+/* ----------------------------------------------------------------------------------------------- */
+ static inline void ak_mgm_astep64_blocks( ak_mgm_ctx ctx, ak_bckey authenticationKey,
+                                                         const ak_pointer data, const size_t count )
+{
+  size_t i = 0;
+  ak_uint64 z[ak_mgm_batch_blocks], h[ak_mgm_batch_blocks], sum;
+
+  for( i = 0; i < count; i++ ) {
+     z[i] = ctx->zcount.q[0];
+#ifdef AK_LITTLE_ENDIAN
+     ctx->zcount.w[1]++;
+#else
+     ctx->zcount.w[1] = bswap_32( bswap_32( ctx->zcount.w[1] ) + 1 );
+#endif
+  }
+  ak_bckey_encrypt_blocks( authenticationKey, z, h, count );
+  ak_gf64_mul_sum( &sum, h, data, count );
+  ctx->sum.q[0] ^= sum;
+}
+
+/* ----------------------------------------------------------------------------------------------- */
+/*! Функция является аналогом функции ak_mgm_estep128_blocks() для 64-х битного шифра.            */
+/* ----------------------------------------------------------------------------------------------- */
+ static inline void ak_mgm_estep64_blocks( ak_mgm_ctx ctx, ak_bckey encryptionKey,
+                                const ak_uint64 *in, ak_uint64 *out, const size_t count )
+{
+  size_t i = 0;
+  ak_uint64 y[ak_mgm_batch_blocks], e[ak_mgm_batch_blocks];
+
+  for( i = 0; i < count; i++ ) {
+     y[i] = ctx->ycount.q[0];
+#ifdef AK_LITTLE_ENDIAN
+     ctx->ycount.w[0]++;
+#else
+     ctx->ycount.w[0] = bswap_32( bswap_32( ctx->ycount.w[0] ) + 1 );
+#endif
+  }
+  ak_bckey_encrypt_blocks( encryptionKey, y, e, count );
+  for( i = 0; i < count; i++ ) out[i] = in[i] ^ e[i];
+}
+
 /* ----------------------------------------------------------------------------------------------- */
 /*! Функция обрабатывает очередной блок дополнительных данных и
     обновляет внутреннее состояние переменных алгоритма MGM, участвующих в алгоритме
@@ -184,7 +280,7 @@
   ak_uint128 h;
   ak_uint8 temp[16], *aptr = (ak_uint8 *)adata;
   ssize_t absize = ( ssize_t ) authenticationKey->bsize;
-  ssize_t resource = 0,
+  ssize_t resource = 0, count = 0,
           tail = ( ssize_t ) adata_size%absize,
           blocks = ( ssize_t ) adata_size/absize;
 
@@ -204,7 +300,10 @@
  if( absize == 16 ) { /* обработка 128-битным шифром */
 
    ctx->abitlen += ( blocks  << 7 );
-   for( ; blocks > 0; blocks--, aptr += 16 ) { astep128( aptr ); }
+   for( ; blocks > 0; blocks -= count, aptr += ( count << 4 )) {
+      count = ak_min( blocks, ak_mgm_batch_blocks );
+      ak_mgm_astep128_blocks( ctx, authenticationKey, aptr, ( size_t ) count );
+   }
    if( tail ) {
     memset( temp, 0, 16 );
     memcpy( temp+absize-tail, aptr, (size_t)tail );
@@ -217,7 +316,10 @@
  } else { /* обработка 64-битным шифром */
 
    ctx->abitlen += ( blocks << 6 );
-   for( ; blocks > 0; blocks--, aptr += 8 ) { astep64( aptr ); }
+   for( ; blocks > 0; blocks -= count, aptr += ( count << 3 )) {
+      count = ak_min( blocks, ak_mgm_batch_blocks );
+      ak_mgm_astep64_blocks( ctx, authenticationKey, aptr, ( size_t ) count );
+   }
    if( tail ) {
     memset( temp, 0, 8 );
     memcpy( temp+absize-tail, aptr, (size_t)tail );
@@ -232,27 +334,21 @@
 }
 
 /* ----------------------------------------------------------------------------------------------- */
-/*! Функция завершает вычисления и возвращает значение имитовставки.
+/*! Функция закрывает добавление данных и обрабатывает последний блок, содержащий длины
+    ассоциированных и зашифрованных данных. После выполнения функции для получения
+    имитовставки остается зашифровать значение `ctx->sum`.
 
    @param ctx
    @param authenticationKey
-   @param out
-   @param out_size
 
    @return Функция возвращает \ref ak_error_ok в случае успешного завершения.
    В противном случае, возвращается код ошибки.                                                    */
 /* ----------------------------------------------------------------------------------------------- */
- static int ak_mgm_authentication_finalize( ak_mgm_ctx ctx,
-                               ak_bckey authenticationKey, ak_pointer out, const size_t out_size )
+ static int ak_mgm_authentication_close( ak_mgm_ctx ctx, ak_bckey authenticationKey )
 {
   ak_uint128 temp, h;
   size_t absize = authenticationKey->bsize;
 
-  if( out == NULL ) return ak_error_message( ak_error_null_pointer, __func__ ,
-                                                           "using null pointer to output buffer" );
- /* проверка запрашиваемой длины iv */
-  if( out_size == 0 ) return ak_error_message( ak_error_zero_length, __func__,
-                                                      "unexpected zero length of integrity code" );
  /* проверка длины блока */
   if( absize > 16 ) return ak_error_message( ak_error_wrong_length, __func__,
                                                                "using key with large block size" );
@@ -291,6 +387,34 @@
      astep64( temp.b );
   }
 
+ return ak_error_ok;
+}
+
+/* ----------------------------------------------------------------------------------------------- */
+/*! Функция завершает вычисления и возвращает значение имитовставки.
+
+   @param ctx
+   @param authenticationKey
+   @param out
+   @param out_size
+
+   @return Функция возвращает \ref ak_error_ok в случае успешного завершения.
+   В противном случае, возвращается код ошибки.                                                    */
+/* ----------------------------------------------------------------------------------------------- */
+ static int ak_mgm_authentication_finalize( ak_mgm_ctx ctx,
+                               ak_bckey authenticationKey, ak_pointer out, const size_t out_size )
+{
+  int error = ak_error_ok;
+  size_t absize = authenticationKey->bsize;
+
+  if( out == NULL ) return ak_error_message( ak_error_null_pointer, __func__ ,
+                                                           "using null pointer to output buffer" );
+ /* проверка запрашиваемой длины iv */
+  if( out_size == 0 ) return ak_error_message( ak_error_zero_length, __func__,
+                                                      "unexpected zero length of integrity code" );
+  if(( error = ak_mgm_authentication_close( ctx, authenticationKey )) != ak_error_ok )
+    return ak_error_message( error, __func__, "incorrect processing of the last block" );
+
  /* последнее шифрование и завершение работы */
   authenticationKey->encrypt( &authenticationKey->key, &ctx->sum, &ctx->sum );
  /* если памяти много (out_size >= absize), то копируем все, */
@@ -350,32 +474,6 @@
  return ak_error_ok;
 }
 
-/* ----------------------------------------------------------------------------------------------- */
-#ifdef AK_LITTLE_ENDIAN
- #define estep64  encryptionKey->encrypt( &encryptionKey->key, &ctx->ycount, &e ); \
-                  outp[0] = inp[0] ^ e.q[0]; \
-                  ctx->ycount.w[0]++;
-
- #define estep128 encryptionKey->encrypt( &encryptionKey->key, &ctx->ycount, &e ); \
-                  outp[0] = inp[0] ^ e.q[0]; \
-                  outp[1] = inp[1] ^ e.q[1]; \
-                  ctx->ycount.q[0]++;
-
-#else
- #define estep64  encryptionKey->encrypt( &encryptionKey->key, &ctx->ycount, &e ); \
-                  outp[0] = inp[0] ^ e.q[0]; \
-                  ctx->ycount.w[0] = bswap_32( ctx->ycount.w[0] ); \
-                  ctx->ycount.w[0]++; \
-                  ctx->ycount.w[0] = bswap_32( ctx->ycount.w[0] );
-
- #define estep128 encryptionKey->encrypt( &encryptionKey->key, &ctx->ycount, &e ); \
-                  outp[0] = inp[0] ^ e.q[0]; \
-                  outp[1] = inp[1] ^ e.q[1]; \
-                  ctx->ycount.q[0] = bswap_64( ctx->ycount.q[0] ); \
-                  ctx->ycount.q[0]++; \
-                  ctx->ycount.q[0] = bswap_64( ctx->ycount.q[0] );
-#endif
-
 /* ----------------------------------------------------------------------------------------------- */
 /*! Функция зашифровывает очередной фрагмент данных и
     обновляет внутреннее состояние переменных алгоритма MGM, участвующих в алгоритме
@@ -401,7 +499,7 @@
   ak_uint8 temp[16];
   size_t i = 0, absize = encryptionKey->bsize;
   ak_uint64 *inp = (ak_uint64 *)in, *outp = (ak_uint64 *)out;
-  size_t resource = 0,
+  size_t resource = 0, count = 0,
          tail = size%absize,
          blocks = size/absize;
 
@@ -436,8 +534,9 @@
 
     if( absize&0x10 ) { /* режим работы для 128-битного шифра */
      /* основная часть */
-      for( ; blocks > 0; blocks--, inp += 2, outp += 2 ) {
-         estep128;
+      for( ; blocks > 0; blocks -= count, inp += ( count << 1 ), outp += ( count << 1 )) {
+         count = ak_min( blocks, ak_mgm_batch_blocks );
+         ak_mgm_estep128_blocks( ctx, encryptionKey, inp, outp, count );
       }
       /* хвост */
       if( tail ) {
@@ -451,8 +550,9 @@
 
     } else { /* режим работы для 64-битного шифра */
        /* основная часть */
-        for( ; blocks > 0; blocks--, inp++, outp++ ) {
-           estep64;
+        for( ; blocks > 0; blocks -= count, inp += count, outp += count ) {
+           count = ak_min( blocks, ak_mgm_batch_blocks );
+           ak_mgm_estep64_blocks( ctx, encryptionKey, inp, outp, count );
         }
        /* хвост */
         if( tail ) {
@@ -468,10 +568,17 @@
   } else { /* основной режим работы => шифрование с одновременной выработкой имитовставки */
 
      if( absize&0x10 ) { /* режим работы для 128-битного шифра */
-      /* основная часть */
-      for( ; blocks > 0; blocks--, inp += 2, outp += 2 ) {
-         estep128;
-         astep128( outp );
+      /* основная часть: при наличии совмещенной реализации шифра используем ее */
+      if(( encryptionKey->mgm_blocks != NULL ) &&
+                                 ( encryptionKey->mgm_blocks == authenticationKey->mgm_blocks )) {
+        encryptionKey->mgm_blocks( &encryptionKey->key, &authenticationKey->key, &ctx->ycount,
+                                           &ctx->zcount, &ctx->sum, inp, outp, blocks, ak_true );
+        inp += ( blocks << 1 ); outp += ( blocks << 1 ); blocks = 0;
+      }
+      for( ; blocks > 0; blocks -= count, inp += ( count << 1 ), outp += ( count << 1 )) {
+         count = ak_min( blocks, ak_mgm_batch_blocks );
+         ak_mgm_estep128_blocks( ctx, encryptionKey, inp, outp, count );
+         ak_mgm_astep128_blocks( ctx, authenticationKey, outp, count );
       }
       /* хвост */
       if( tail ) {
@@ -489,9 +596,10 @@
 
     } else { /* режим работы для 64-битного шифра */
       /* основная часть */
-       for( ; blocks > 0; blocks--, inp++, outp++ ) {
-          estep64;
-          astep64( outp );
+       for( ; blocks > 0; blocks -= count, inp += count, outp += count ) {
+          count = ak_min( blocks, ak_mgm_batch_blocks );
+          ak_mgm_estep64_blocks( ctx, encryptionKey, inp, outp, count );
+          ak_mgm_astep64_blocks( ctx, authenticationKey, outp, count );
        }
        /* хвост */
        if( tail ) {
@@ -537,7 +645,7 @@
   ak_uint128 e, h;
   size_t i = 0, absize = encryptionKey->bsize;
   ak_uint64 *inp = (ak_uint64 *)in, *outp = (ak_uint64 *)out;
-  size_t resource = 0,
+  size_t resource = 0, count = 0,
          tail = size%absize,
          blocks = size/absize;
 
@@ -572,8 +680,9 @@
                                     /* это полная копия кода, содержащегося в функции .. _encryption_ ... */
     if( absize&0x10 ) { /* режим работы для 128-битного шифра */
      /* основная часть */
-      for( ; blocks > 0; blocks--, inp += 2, outp += 2 ) {
-         estep128;
+      for( ; blocks > 0; blocks -= count, inp += ( count << 1 ), outp += ( count << 1 )) {
+         count = ak_min( blocks, ak_mgm_batch_blocks );
+         ak_mgm_estep128_blocks( ctx, encryptionKey, inp, outp, count );
       }
       /* хвост */
       if( tail ) {
@@ -587,8 +696,9 @@
 
     } else { /* режим работы для 64-битного шифра */
        /* основная часть */
-        for( ; blocks > 0; blocks--, inp++, outp++ ) {
-           estep64;
+        for( ; blocks > 0; blocks -= count, inp += count, outp += count ) {
+           count = ak_min( blocks, ak_mgm_batch_blocks );
+           ak_mgm_estep64_blocks( ctx, encryptionKey, inp, outp, count );
         }
        /* хвост */
         if( tail ) {
@@ -604,10 +714,17 @@
   } else { /* основной режим работы => шифрование с одновременной выработкой имитовставки */
 
      if( absize&0x10 ) { /* режим работы для 128-битного шифра */
-      /* основная часть */
-      for( ; blocks > 0; blocks--, inp += 2, outp += 2 ) {
-         astep128( inp );
-         estep128;
+      /* основная часть: при наличии совмещенной реализации шифра используем ее */
+      if(( encryptionKey->mgm_blocks != NULL ) &&
+                                 ( encryptionKey->mgm_blocks == authenticationKey->mgm_blocks )) {
+        encryptionKey->mgm_blocks( &encryptionKey->key, &authenticationKey->key, &ctx->ycount,
+                                           &ctx->zcount, &ctx->sum, inp, outp, blocks, ak_false );
+        inp += ( blocks << 1 ); outp += ( blocks << 1 ); blocks = 0;
+      }
+      for( ; blocks > 0; blocks -= count, inp += ( count << 1 ), outp += ( count << 1 )) {
+         count = ak_min( blocks, ak_mgm_batch_blocks );
+         ak_mgm_astep128_blocks( ctx, authenticationKey, inp, count );
+         ak_mgm_estep128_blocks( ctx, encryptionKey, inp, outp, count );
       }
       /* хвост */
       if( tail ) {
@@ -625,9 +742,10 @@
 
     } else { /* режим работы для 64-битного шифра */
       /* основная часть */
-       for( ; blocks > 0; blocks--, inp++, outp++ ) {
-          astep64( inp );
-          estep64;
+       for( ; blocks > 0; blocks -= count, inp += count, outp += count ) {
+          count = ak_min( blocks, ak_mgm_batch_blocks );
+          ak_mgm_astep64_blocks( ctx, authenticationKey, inp, count );
+          ak_mgm_estep64_blocks( ctx, encryptionKey, inp, outp, count );
        }
        /* хвост */
        if( tail ) {
@@ -902,6 +1020,433 @@
  return error;
 }
 
+/* ----------------------------------------------------------------------------------------------- */
+/*                  функции для обработки данных последовательными фрагментами                     */
+/* ----------------------------------------------------------------------------------------------- */
+/*! Функция проверяет переданные ключи, присваивает контексту синхропосылку и подготавливает его
+    к обработке ассоциированных и шифруемых данных. Все проверки ключей выполняются только
+    в данной функции; функции ak_mgm_adata_update(), ak_mgm_encrypt_update() и
+    ak_mgm_decrypt_update() лишь уменьшают ресурс ключей.
+
+    После вызова функции ak_mgm_finalize() контекст может быть повторно использован для
+    обработки новых данных - для этого необходимо снова вызвать функцию ak_mgm_clean().
+
+    Требования к ключам аналогичны требованиям функции ak_bckey_encrypt_mgm(): один из ключей
+    может принимать значение `NULL`, оба ключа одновременно - нет.
+
+    @param mgm Контекст режима `mgm`.
+    @param encryptionKey Ключ шифрования; может принимать значение `NULL`.
+    @param authenticationKey Ключ выработки имитовставки; может принимать значение `NULL`.
+    @param iv Указатель на синхропосылку.
+    @param iv_size Длина синхропосылки в байтах.
+
+    @return В случае успеха функция возвращает \ref ak_error_ok (ноль). В противном случае
+    возвращается код ошибки.                                                                       */
+/* ----------------------------------------------------------------------------------------------- */
+ int ak_mgm_clean( ak_mgm mgm, ak_bckey encryptionKey, ak_bckey authenticationKey,
+                                                      const ak_pointer iv, const size_t iv_size )
+{
+  int error = ak_error_ok;
+
+  if( mgm == NULL ) return ak_error_message( ak_error_null_pointer, __func__ ,
+                                                                "using null pointer to mgm context");
+  if(( encryptionKey == NULL ) && ( authenticationKey == NULL ))
+    return ak_error_message( ak_error_null_pointer, __func__ ,
+                               "using null pointers both to encryption and authentication keys" );
+  if(( encryptionKey != NULL ) && ( authenticationKey != NULL )) {
+    if( encryptionKey->bsize != authenticationKey->bsize )
+      return ak_error_message( ak_error_not_equal_data, __func__,
+                                                   "different block sizes for given secret keys");
+  }
+
+  memset( &mgm->ctx, 0, sizeof( struct mgm_ctx ));
+  mgm->encryptionKey = encryptionKey;
+  mgm->authenticationKey = authenticationKey;
+
+  if( authenticationKey != NULL ) {
+    if(( error = ak_mgm_authentication_clean( &mgm->ctx,
+                                           authenticationKey, iv, iv_size )) != ak_error_ok ) {
+      ak_ptr_wipe( &mgm->ctx, sizeof( struct mgm_ctx ), &authenticationKey->key.generator );
+      return ak_error_message( error, __func__, "incorrect initialization of internal mgm context" );
+    }
+  }
+  if( encryptionKey != NULL ) {
+    if(( error = ak_mgm_encryption_clean( &mgm->ctx, encryptionKey, iv, iv_size )) != ak_error_ok ) {
+      ak_ptr_wipe( &mgm->ctx, sizeof( struct mgm_ctx ), &encryptionKey->key.generator );
+      return ak_error_message( error, __func__, "incorrect initialization of internal mgm context" );
+    }
+  }
+
+ return ak_error_ok;
+}
+
+/* ----------------------------------------------------------------------------------------------- */
+/*! Функция обрабатывает очередной фрагмент ассоциированных данных. Длина фрагмента должна быть
+    кратна длине блока используемого шифра; фрагмент, длина которого не кратна длине блока,
+    воспринимается как последний. Все ассоциированные данные должны быть обработаны до
+    начала зашифрования (расшифрования) данных.
+
+    @param mgm Контекст режима `mgm`, инициализированный функцией ak_mgm_clean().
+    @param adata Указатель на ассоциированные данные.
+    @param adata_size Длина ассоциированных данных в байтах.
+
+    @return В случае успеха функция возвращает \ref ak_error_ok (ноль). В противном случае
+    возвращается код ошибки.                                                                       */
+/* ----------------------------------------------------------------------------------------------- */
+ int ak_mgm_adata_update( ak_mgm mgm, const ak_pointer adata, const size_t adata_size )
+{
+  int error = ak_error_ok;
+
+  if( mgm == NULL ) return ak_error_message( ak_error_null_pointer, __func__ ,
+                                                                "using null pointer to mgm context");
+  if( mgm->authenticationKey == NULL ) return ak_error_message( ak_error_null_pointer, __func__,
+                                                 "using mgm context without authentication key" );
+  if(( error = ak_bckey_check_mgm_length(( size_t )( mgm->ctx.abitlen >> 3 ) + adata_size,
+           ( size_t )( mgm->ctx.pbitlen >> 3 ), mgm->authenticationKey->bsize )) != ak_error_ok )
+    return ak_error_message( error, __func__, "incorrect length of input data");
+
+  if(( error = ak_mgm_authentication_update( &mgm->ctx,
+                                 mgm->authenticationKey, adata, adata_size )) != ak_error_ok )
+    return ak_error_message( error, __func__, "incorrect hashing of associated data" );
+
+ return ak_error_ok;
+}
+
+/* ----------------------------------------------------------------------------------------------- */
+/*! Функция зашифровывает очередной фрагмент данных и, при наличии ключа выработки имитовставки,
+    обновляет ее текущее значение. Длина фрагмента должна быть кратна длине блока используемого
+    шифра; фрагмент, длина которого не кратна длине блока, воспринимается как последний.
+    После первого вызова функции обработка ассоциированных данных невозможна.
+
+    @param mgm Контекст режима `mgm`, инициализированный функцией ak_mgm_clean().
+    @param in Указатель на зашифровываемые данные.
+    @param out Указатель на область памяти, куда помещаются зашифрованные данные;
+    может совпадать с указателем `in`.
+    @param size Размер зашифровываемых данных в байтах.
+
+    @return В случае успеха функция возвращает \ref ak_error_ok (ноль). В противном случае
+    возвращается код ошибки.                                                                       */
+/* ----------------------------------------------------------------------------------------------- */
+ int ak_mgm_encrypt_update( ak_mgm mgm, const ak_pointer in, ak_pointer out, const size_t size )
+{
+  int error = ak_error_ok;
+
+  if( mgm == NULL ) return ak_error_message( ak_error_null_pointer, __func__ ,
+                                                                "using null pointer to mgm context");
+  if( mgm->encryptionKey == NULL ) return ak_error_message( ak_error_null_pointer, __func__,
+                                                     "using mgm context without encryption key" );
+  if(( error = ak_bckey_check_mgm_length(( size_t )( mgm->ctx.abitlen >> 3 ),
+                ( size_t )( mgm->ctx.pbitlen >> 3 ) + size, mgm->encryptionKey->bsize )) != ak_error_ok )
+    return ak_error_message( error, __func__, "incorrect length of input data");
+
+  if(( error = ak_mgm_encryption_update( &mgm->ctx, mgm->encryptionKey,
+                                     mgm->authenticationKey, in, out, size )) != ak_error_ok )
+    return ak_error_message( error, __func__, "incorrect encryption of plain data" );
+
+ return ak_error_ok;
+}
+
+/* ----------------------------------------------------------------------------------------------- */
+/*! Функция расшифровывает очередной фрагмент данных и, при наличии ключа выработки имитовставки,
+    обновляет ее текущее значение. Требования к длине фрагмента аналогичны требованиям
+    функции ak_mgm_encrypt_update().
+
+    \note Расшифрованные данные следует использовать только после того, как значение
+    имитовставки, выработанное функцией ak_mgm_finalize(), совпадет с ожидаемым.
+
+    @param mgm Контекст режима `mgm`, инициализированный функцией ak_mgm_clean().
+    @param in Указатель на расшифровываемые данные.
+    @param out Указатель на область памяти, куда помещаются расшифрованные данные;
+    может совпадать с указателем `in`.
+    @param size Размер расшифровываемых данных в байтах.
+
+    @return В случае успеха функция возвращает \ref ak_error_ok (ноль). В противном случае
+    возвращается код ошибки.                                                                       */
+/* ----------------------------------------------------------------------------------------------- */
+ int ak_mgm_decrypt_update( ak_mgm mgm, const ak_pointer in, ak_pointer out, const size_t size )
+{
+  int error = ak_error_ok;
+
+  if( mgm == NULL ) return ak_error_message( ak_error_null_pointer, __func__ ,
+                                                                "using null pointer to mgm context");
+  if( mgm->encryptionKey == NULL ) return ak_error_message( ak_error_null_pointer, __func__,
+                                                     "using mgm context without encryption key" );
+  if(( error = ak_bckey_check_mgm_length(( size_t )( mgm->ctx.abitlen >> 3 ),
+                ( size_t )( mgm->ctx.pbitlen >> 3 ) + size, mgm->encryptionKey->bsize )) != ak_error_ok )
+    return ak_error_message( error, __func__, "incorrect length of input data");
+
+  if(( error = ak_mgm_decryption_update( &mgm->ctx, mgm->encryptionKey,
+                                     mgm->authenticationKey, in, out, size )) != ak_error_ok )
+    return ak_error_message( error, __func__, "incorrect decryption of encrypted data" );
+
+ return ak_error_ok;
+}
+
+/* ----------------------------------------------------------------------------------------------- */
+/*! Функция вырабатывает значение имитовставки и очищает внутреннее состояние контекста.
+    Если ключ выработки имитовставки не был задан, то функция только очищает контекст;
+    в этом случае указатель `icode` может принимать значение `NULL`.
+
+    @param mgm Контекст режима `mgm`.
+    @param icode Указатель на область памяти, куда помещается значение имитовставки.
+    @param icode_size Ожидаемый размер имитовставки в байтах; значение не должно превышать
+    размер блока используемого шифра.
+
+    @return В случае успеха функция возвращает \ref ak_error_ok (ноль). В противном случае
+    возвращается код ошибки.                                                                       */
+/* ----------------------------------------------------------------------------------------------- */
+ int ak_mgm_finalize( ak_mgm mgm, ak_pointer icode, const size_t icode_size )
+{
+  int error = ak_error_ok;
+
+  if( mgm == NULL ) return ak_error_message( ak_error_null_pointer, __func__ ,
+                                                                "using null pointer to mgm context");
+  if( mgm->authenticationKey != NULL ) {
+    if(( error = ak_mgm_authentication_finalize( &mgm->ctx,
+                               mgm->authenticationKey, icode, icode_size )) != ak_error_ok )
+      ak_error_message( error, __func__, "incorrect finalize of integrity code" );
+    ak_ptr_wipe( &mgm->ctx, sizeof( struct mgm_ctx ), &mgm->authenticationKey->key.generator );
+  }
+   else {
+     if( mgm->encryptionKey == NULL ) return ak_error_message( ak_error_null_pointer, __func__,
+                                                           "using uninitialized mgm context" );
+     ak_ptr_wipe( &mgm->ctx, sizeof( struct mgm_ctx ), &mgm->encryptionKey->key.generator );
+   }
+ /* до следующего вызова ak_mgm_clean() обработка данных невозможна */
+  mgm->ctx.abitlen = mgm->ctx.pbitlen = 0;
+  mgm->ctx.flags = ak_aead_assosiated_data_bit | ak_aead_encrypted_data_bit;
+
+ return error;
+}
+
+/* ----------------------------------------------------------------------------------------------- */
+/*                      функции для пакетной обработки независимых сообщений                       */
+/* ----------------------------------------------------------------------------------------------- */
+/*! \brief Функция проверяет параметры одного сообщения, обрабатываемого в режиме `mgm`.         */
+/* ----------------------------------------------------------------------------------------------- */
+ static inline int ak_mgm_check_message( ak_aead_message message,
+                                                   ak_bckey authenticationKey, const size_t bsize )
+{
+  if(( message->iv == NULL ) || ( message->iv_size == 0 ))
+    return ak_error_message( ak_error_null_pointer, __func__, "using message with undefined iv" );
+  if(( authenticationKey != NULL ) && (( message->icode == NULL ) || ( message->icode_size == 0 )))
+    return ak_error_message( ak_error_null_pointer, __func__,
+                                                 "using message with undefined integrity code" );
+ return ak_bckey_check_mgm_length( message->adata_size, message->size, bsize );
+}
+
+/* ----------------------------------------------------------------------------------------------- */
+/*! Функция реализует пакетное зашифрование (расшифрование) независимых сообщений.
+
+    Ключи проверяются (наличие значения, контрольная сумма и ресурс, достаточный для обработки
+    всего пакета) один раз. Сообщения обрабатываются группами по \ref ak_mgm_batch_blocks:
+    начальные значения счетчиков всех сообщений группы, а также итоговые значения
+    имитовставок, вырабатываются за один вызов функции ak_bckey_encrypt_blocks().
+
+    @return Функция возвращает \ref ak_error_ok, если все сообщения обработаны успешно;
+    в противном случае возвращается код ошибки первого сообщения, обработанного с ошибкой.
+    Результат обработки каждого сообщения помещается в поле `status`.                              */
+/* ----------------------------------------------------------------------------------------------- */
+ static int ak_mgm_many( ak_bckey encryptionKey, ak_bckey authenticationKey,
+                          ak_aead_message messages, const size_t count, const bool_t encrypt )
+{
+  ak_random generator = NULL;
+  int error = ak_error_ok, result = ak_error_ok;
+  size_t i, j, k, n, bs = 0, len, resource = 0;
+  struct mgm_ctx ctx[ak_mgm_batch_blocks];
+  ak_aead_message active[ak_mgm_batch_blocks];
+  ak_uint8 zbuf[16*ak_mgm_batch_blocks], ybuf[16*ak_mgm_batch_blocks];
+
+  if( messages == NULL ) return ak_error_message( ak_error_null_pointer, __func__,
+                                                         "using null pointer to array of messages" );
+  if( !count ) return ak_error_ok;
+
+ /* проверки ключей */
+  if(( encryptionKey == NULL ) && ( authenticationKey == NULL ))
+    return ak_error_message( ak_error_null_pointer, __func__ ,
+                               "using null pointers both to encryption and authentication keys" );
+  if(( encryptionKey != NULL ) && ( authenticationKey != NULL )) {
+    if( encryptionKey->bsize != authenticationKey->bsize )
+      return ak_error_message( ak_error_not_equal_data, __func__,
+                                                   "different block sizes for given secret keys");
+  }
+  if( encryptionKey != NULL ) {
+    bs = encryptionKey->bsize; generator = &encryptionKey->key.generator;
+  }
+  if( authenticationKey != NULL ) {
+    bs = authenticationKey->bsize; generator = &authenticationKey->key.generator;
+  }
+  if( bs > 16 ) return ak_error_message( ak_error_wrong_length, __func__,
+                                                               "using key with large block size" );
+
+ /* ресурс, необходимый для обработки всего пакета (с запасом на служебные блоки) */
+  for( i = 0; i < count; i++ )
+     resource += ( messages[i].adata_size + bs - 1 )/bs + ( messages[i].size + bs - 1 )/bs + 3;
+
+  for( j = 0; j < 2; j++ ) {
+     ak_bckey bkey = ( j == 0 ) ? encryptionKey : authenticationKey;
+     if( bkey == NULL ) continue;
+     if(( bkey->key.flags&ak_key_flag_set_key ) == 0 )
+       return ak_error_message( ak_error_key_value, __func__,
+                                               "using secret key context with undefined key value");
+     if( bkey->key.resource.value.counter <= ( ssize_t ) resource )
+       return ak_error_message( ak_error_low_key_resource, __func__,
+                                                 "using key with low resource for all messages");
+     if( ak_skey_verify_icode( &bkey->key, resource ) != ak_true )
+       return ak_error_message( ak_error_wrong_key_icode, __func__,
+                                                          "incorrect integrity code of key value" );
+  }
+
+  for( i = 0; i < count; i += n ) {
+     n = ak_min( count - i, ak_mgm_batch_blocks );
+
+    /* проверяем сообщения группы и формируем начальные значения счетчиков */
+     for( j = 0, k = 0; j < n; j++ ) {
+        ak_aead_message msg = messages + i + j;
+        if(( msg->status = ak_mgm_check_message( msg, authenticationKey, bs )) != ak_error_ok )
+          continue;
+        memset( ctx +k, 0, sizeof( struct mgm_ctx ));
+        memset( zbuf +k*bs, 0, bs );
+        memcpy( zbuf +k*bs, msg->iv, ak_min( msg->iv_size, bs ));
+        memcpy( ybuf +k*bs, zbuf +k*bs, bs );
+        zbuf[k*bs+bs-1] = ( zbuf[k*bs+bs-1]&0x7F ) ^ 0x80;
+        ybuf[k*bs+bs-1] = ( ybuf[k*bs+bs-1]&0x7F );
+        active[k++] = msg;
+     }
+     if( k == 0 ) goto labnext;
+
+     if( authenticationKey != NULL ) {
+       ak_bckey_encrypt_blocks( authenticationKey, zbuf, zbuf, k );
+       authenticationKey->key.resource.value.counter -= k;
+       for( j = 0; j < k; j++ ) memcpy( ctx[j].zcount.b, zbuf +j*bs, bs );
+     }
+     if( encryptionKey != NULL ) {
+       ak_bckey_encrypt_blocks( encryptionKey, ybuf, ybuf, k );
+       encryptionKey->key.resource.value.counter -= k;
+       for( j = 0; j < k; j++ ) memcpy( ctx[j].ycount.b, ybuf +j*bs, bs );
+     }
+
+    /* обрабатываем данные сообщений */
+     for( j = 0; j < k; j++ ) {
+        ak_aead_message msg = active[j];
+
+        error = ak_error_ok;
+        if( authenticationKey != NULL )
+          error = ak_mgm_authentication_update( ctx +j, authenticationKey,
+                                                                   msg->adata, msg->adata_size );
+        if(( error == ak_error_ok ) && ( encryptionKey != NULL )) {
+          if( encrypt ) error = ak_mgm_encryption_update( ctx +j, encryptionKey,
+                                                authenticationKey, msg->in, msg->out, msg->size );
+            else error = ak_mgm_decryption_update( ctx +j, encryptionKey,
+                                                authenticationKey, msg->in, msg->out, msg->size );
+        }
+        if(( error == ak_error_ok ) && ( authenticationKey != NULL ))
+          error = ak_mgm_authentication_close( ctx +j, authenticationKey );
+        msg->status = error;
+        if( authenticationKey != NULL ) memcpy( zbuf +j*bs, ctx[j].sum.b, bs );
+     }
+
+    /* вырабатываем имитовставки всех сообщений группы */
+     if( authenticationKey != NULL ) {
+       ak_bckey_encrypt_blocks( authenticationKey, zbuf, zbuf, k );
+       for( j = 0; j < k; j++ ) {
+          ak_aead_message msg = active[j];
+          if( msg->status != ak_error_ok ) continue;
+
+          len = ak_min( msg->icode_size, bs );
+          if( encrypt ) memcpy( msg->icode, zbuf +j*bs +bs -len, len );
+           else
+            if( !ak_ptr_is_equal( msg->icode, zbuf +j*bs +bs -len, len ))
+              msg->status = ak_error_not_equal_data;
+       }
+     }
+
+     labnext:
+     for( j = 0; j < n; j++ )
+        if(( result == ak_error_ok ) && ( messages[i+j].status != ak_error_ok ))
+          result = messages[i+j].status;
+  }
+
+ /* очищаем внутренние данные */
+  ak_ptr_wipe( ctx, sizeof( ctx ), generator );
+  ak_ptr_wipe( zbuf, sizeof( zbuf ), generator );
+  ak_ptr_wipe( ybuf, sizeof( ybuf ), generator );
+
+ return result;
+}
+
+/* ----------------------------------------------------------------------------------------------- */
+/*! Функция зашифровывает массив независимых сообщений в режиме `mgm` и вырабатывает
+    имитовставку для каждого из них. Результат должен совпадать с результатом последовательного
+    вызова функции ak_bckey_encrypt_mgm() для каждого сообщения; требования к ключам аналогичны.
+    Ключи проверяются один раз для всего массива сообщений.
+
+    @param encryptionKey Ключ шифрования; может принимать значение `NULL`.
+    @param authenticationKey Ключ выработки имитовставки; может принимать значение `NULL`.
+    @param messages Массив описаний сообщений.
+    @param count Количество сообщений в массиве.
+
+    @return Функция возвращает \ref ak_error_ok, если все сообщения обработаны успешно;
+    в противном случае возвращается код ошибки. Результат обработки каждого сообщения
+    помещается в поле `status` его описания.                                                       */
+/* ----------------------------------------------------------------------------------------------- */
+ int ak_bckey_encrypt_mgm_many( ak_bckey encryptionKey, ak_bckey authenticationKey,
+                                                 ak_aead_message messages, const size_t count )
+{
+  return ak_mgm_many( encryptionKey, authenticationKey, messages, count, ak_true );
+}
+
+/* ----------------------------------------------------------------------------------------------- */
+/*! Функция расшифровывает массив независимых сообщений в режиме `mgm` и проверяет
+    имитовставку каждого из них. Если имитовставка сообщения не совпадает с вычисленной,
+    то в поле `status` его описания помещается код \ref ak_error_not_equal_data.
+
+    @param encryptionKey Ключ шифрования; может принимать значение `NULL`.
+    @param authenticationKey Ключ выработки имитовставки; может принимать значение `NULL`.
+    @param messages Массив описаний сообщений.
+    @param count Количество сообщений в массиве.
+
+    @return Функция возвращает \ref ak_error_ok, если все сообщения обработаны успешно
+    и все имитовставки совпали; в противном случае возвращается код ошибки.                        */
+/* ----------------------------------------------------------------------------------------------- */
+ int ak_bckey_decrypt_mgm_many( ak_bckey encryptionKey, ak_bckey authenticationKey,
+                                                 ak_aead_message messages, const size_t count )
+{
+  return ak_mgm_many( encryptionKey, authenticationKey, messages, count, ak_false );
+}
+
+/* ----------------------------------------------------------------------------------------------- */
+/*! Функция обрабатывает массив независимых сообщений в режиме `mgm` и выбирает,
+    в зависимости от значения `aead`, функцию ak_bckey_encrypt_mgm_many()
+    или ak_bckey_decrypt_mgm_many(). Пакетная обработка, при которой ключи проверяются
+    и перемаскируются один раз для всего массива, реализована только для режима `mgm`;
+    для остальных функций аутентифицированного шифрования возвращается ошибка
+    \ref ak_error_undefined_function, и сообщения должны обрабатываться по одному.
+
+    @param aead Функция аутентифицированного шифрования: ak_bckey_encrypt_mgm()
+    или ak_bckey_decrypt_mgm().
+    @param encryptionKey Ключ шифрования.
+    @param authenticationKey Ключ выработки имитовставки.
+    @param messages Массив описаний сообщений.
+    @param count Количество сообщений в массиве.
+
+    @return Функция возвращает \ref ak_error_ok, если все сообщения обработаны успешно;
+    в противном случае возвращается код ошибки.                                                    */
+/* ----------------------------------------------------------------------------------------------- */
+ int ak_aead_many( ak_function_aead *aead, ak_pointer encryptionKey,
+                  ak_pointer authenticationKey, ak_aead_message messages, const size_t count )
+{
+  if( aead == NULL ) return ak_error_message( ak_error_null_pointer, __func__,
+                                                 "using null pointer to aead function" );
+  if( aead == ak_bckey_encrypt_mgm )
+    return ak_bckey_encrypt_mgm_many( encryptionKey, authenticationKey, messages, count );
+  if( aead == ak_bckey_decrypt_mgm )
+    return ak_bckey_decrypt_mgm_many( encryptionKey, authenticationKey, messages, count );
+
+ return ak_error_message( ak_error_undefined_function, __func__,
+                                    "batch processing is implemented only for mgm mode" );
+}
+
 /* ----------------------------------------------------------------------------------------------- */
  bool_t ak_libakrypt_test_mgm( void )
 {
@@ -28,7 +28,8 @@
  } *ak_option;
 
 /* ----------------------------------------------------------------------------------------------- */
-/*! Константные значения опций (значения по-умолчанию) */
+/*! Константные значения опций (значения по-умолчанию);
+    порядок следования опций должен совпадать с порядком индексов \ref option_index_t */
  static struct option options[] = {
      { "log_level", ak_log_standard, 0, 2 },
      { "context_manager_size", 32, 32, 65536 },
@@ -52,6 +53,20 @@
      { "openssl_compability", 0, 0, 1 },
   /* флаг использования цвета при выводе сообщений библиотеки */
      { "use_color_output", 1, 0, 1 },
+
+  /* политика смены маски секретного ключа после выполнения криптографических преобразований:
+     0 - при каждом вызове, 1 - после обработки заданного количества блоков,
+     2 - по истечении заданного интервала времени (в миллисекундах)                               */
+     { "key_remask_policy", 0, 0, 2 },
+     { "key_remask_block_count", 4096, 1, 2147483648 },
+     { "key_remask_interval", 100, 1, 3600000 },
+
+  /* политика проверки контрольной суммы секретного ключа перед выполнением преобразований:
+     0 - при каждом вызове, 1 - после обработки заданного количества блоков,
+     2 - по истечении заданного интервала времени (в миллисекундах)                               */
+     { "key_icode_check_policy", 0, 0, 2 },
+     { "key_icode_check_block_count", 4096, 1, 2147483648 },
+     { "key_icode_check_interval", 100, 1, 3600000 },
      { NULL, 0, 0, 0 } /* завершающая константа, должна всегда принимать нулевые значения */
  };
 
@@ -136,6 +151,23 @@
  return result;
 }
 
+/* ----------------------------------------------------------------------------------------------- */
+/*! \note Функция не проверяет и не интерпретирует значение устанавливааемой опции.
+
+    \param index Индекс опции, должен быть от нуля до значения,
+    возвращаемого функцией ak_libakrypt_options_count().
+    \param value Значение опции
+
+    \return В случае удачного установления значения опции возввращается \ref ak_error_ok.
+     Если индекс опции указан неверно, то возвращается ошибка \ref ak_error_wrong_option.         */
+/* ----------------------------------------------------------------------------------------------- */
+ int ak_libakrypt_set_option_by_index( const size_t index, const ak_int64 value )
+{
+  if( index >= ak_libakrypt_options_count() ) return ak_error_wrong_option;
+  options[index].value = value;
+ return ak_error_ok;
+}
+
 /* ----------------------------------------------------------------------------------------------- */
 /*! При выводе используется текущая функция аудита.                                                */
 /* ----------------------------------------------------------------------------------------------- */
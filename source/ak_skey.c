@@ -4,6 +4,7 @@
 /*  Файл ak_skey.c                                                                                 */
 /*  - содержит реализации функций, предназначенных для хранения и обработки ключевой информации.   */
 /* ----------------------------------------------------------------------------------------------- */
+ #include <libakrypt-internal.h>
  #include <libakrypt.h>
 
 /* ----------------------------------------------------------------------------------------------- */
@@ -312,6 +313,10 @@
   skey->oid = NULL;
   /* После создания ключа все его флаги не определены */
   skey->flags = ak_key_flag_undefined;
+  /* Сохраняем значения опций, используемых при каждом обращении к ключу */
+  memset( &skey->options, 0, sizeof( struct skey_options ));
+  skey->options.openssl_compability = ak_libakrypt_get_openssl_compability();
+  ak_skey_load_options( skey );
  /* В заключение определяем указатели на методы.
     по умолчанию используются механизмы для работы с аддитивной по модулю 2 маской.
 
@@ -468,6 +473,159 @@
  return ak_error_ok;
 }
 
+/* ----------------------------------------------------------------------------------------------- */
+/*! \brief Функция возвращает значение монотонного таймера в миллисекундах.                        */
+/* ----------------------------------------------------------------------------------------------- */
+ static ak_uint64 ak_skey_get_milliseconds( void )
+{
+#ifdef CLOCK_MONOTONIC
+  struct timespec ts;
+  if( clock_gettime( CLOCK_MONOTONIC, &ts ) == 0 )
+    return ( ak_uint64 )ts.tv_sec*1000 + ( ak_uint64 )ts.tv_nsec/1000000;
+#endif
+ return ( ak_uint64 )time( NULL )*1000;
+}
+
+/* ----------------------------------------------------------------------------------------------- */
+/*! Функция копирует в контекст секретного ключа значения опций, определяющих политику
+    смены маски и политику проверки контрольной суммы, и сбрасывает их текущее состояние.
+
+    @param skey Контекст секретного ключа.                                                         */
+/* ----------------------------------------------------------------------------------------------- */
+ void ak_skey_load_options( ak_skey skey )
+{
+  skey->options.remask_policy =
+                 ( remask_policy_t ) ak_libakrypt_get_option_by_index( ak_option_key_remask_policy );
+  skey->options.remask_block_count =
+                   ( ak_uint64 ) ak_libakrypt_get_option_by_index( ak_option_key_remask_block_count );
+  skey->options.remask_interval =
+                      ( ak_uint64 ) ak_libakrypt_get_option_by_index( ak_option_key_remask_interval );
+
+  skey->remask_blocks = 0;
+  skey->remask_time = ( skey->options.remask_policy == remask_time_interval_policy ) ?
+                                                                  ak_skey_get_milliseconds() : 0;
+
+  skey->options.icode_check_policy = ( icode_check_policy_t )
+                                  ak_libakrypt_get_option_by_index( ak_option_key_icode_check_policy );
+  skey->options.icode_check_block_count =
+              ( ak_uint64 ) ak_libakrypt_get_option_by_index( ak_option_key_icode_check_block_count );
+  skey->options.icode_check_interval =
+                 ( ak_uint64 ) ak_libakrypt_get_option_by_index( ak_option_key_icode_check_interval );
+
+  skey->icode_blocks = 0;
+  skey->icode_time = 0;
+  skey->flags &= ( 0xFFFFFFFFFFFFFFFFLL ^ ak_key_flag_icode_checked );
+}
+
+/* ----------------------------------------------------------------------------------------------- */
+/*! Функция вызывается после выполнения криптографического преобразования и определяет,
+    требуется ли сменить маску ключа (или маску хранящихся вместе с ключом значений, вычисленных
+    из него) в соответствии с политикой, сохраненной в контексте ключа при его создании:
+
+    - \ref remask_every_call_policy -- маска сменяется при каждом вызове функции,
+    - \ref remask_block_count_policy -- маска сменяется, если с момента последней смены
+      было обработано не менее `key_remask_block_count` блоков,
+    - \ref remask_time_interval_policy -- маска сменяется, если с момента последней смены
+      прошло не менее `key_remask_interval` миллисекунд.
+
+    Отложенная смена маски уменьшает накладные расходы при обработке коротких сообщений,
+    однако позволяет использовать одну и ту же маску для нескольких вызовов.
+    Если маска на ключ не наложена, то функция возвращает истину вне зависимости от политики.
+
+    @param skey Контекст секретного ключа.
+    @param blocks Количество блоков, обработанных с использованием ключа.
+    @return Функция возвращает \ref ak_true, если маску необходимо сменить.
+    В противном случае возвращается \ref ak_false.                                                 */
+/* ----------------------------------------------------------------------------------------------- */
+ bool_t ak_skey_remask_is_required( ak_skey skey, const size_t blocks )
+{
+  if( skey == NULL ) {
+    ak_error_message( ak_error_null_pointer, __func__ ,
+                                                     "using a null pointer to secret key context" );
+    return ak_false;
+  }
+  if(( skey->flags )&ak_key_flag_set_mask ) {
+    switch( skey->options.remask_policy ) {
+      case remask_block_count_policy:
+        if(( skey->remask_blocks += blocks ) < skey->options.remask_block_count )
+          return ak_false;
+        skey->remask_blocks = 0;
+        break;
+
+      case remask_time_interval_policy: {
+        ak_uint64 now = ak_skey_get_milliseconds();
+        if( now - skey->remask_time < skey->options.remask_interval ) return ak_false;
+        skey->remask_time = now;
+      }
+        break;
+
+      default: break;
+    }
+  }
+ return ak_true;
+}
+
+/* ----------------------------------------------------------------------------------------------- */
+/*! Функция вызывается после выполнения криптографического преобразования и сменяет маску ключа
+    в соответствии с политикой, сохраненной в контексте ключа при его создании
+    (см. функцию ak_skey_remask_is_required()).
+
+    @param skey Контекст секретного ключа.
+    @param blocks Количество блоков, обработанных с использованием ключа.
+    @return В случае успеха функция возвращает \ref ak_error_ok. В противном случае,
+    возвращается код ошибки.                                                                       */
+/* ----------------------------------------------------------------------------------------------- */
+ int ak_skey_remask( ak_skey skey, const size_t blocks )
+{
+  if( skey == NULL ) return ak_error_message( ak_error_null_pointer,
+                                         __func__ , "using a null pointer to secret key context" );
+  if( !ak_skey_remask_is_required( skey, blocks )) return ak_error_ok;
+ return skey->set_mask( skey );
+}
+
+/* ----------------------------------------------------------------------------------------------- */
+/*! \brief Константа, задающая точку, в которой вычисляется многочлен контрольной суммы ключа. */
+ static ak_uint64 ak_skey_icode_point = 0x9E3779B97F4A7C15LL;
+
+/* ----------------------------------------------------------------------------------------------- */
+/*! Функция вычисляет контрольную сумму ключа, маскированного путем сложения по модулю два.
+
+    Последовательность 64-х битных слов \f$ w_1, \ldots, w_n \f$ ключа (и, отдельно, его маски)
+    рассматривается как многочлен над полем \f$ \mathbb F_{2^{64}}\f$, значение которого вычисляется
+    в фиксированной точке \f$ h \f$ по схеме Горнера: \f$ s_i = (s_{i-1} \oplus w_i)\cdot h\f$.
+    Преобразование линейно относительно операции сложения по модулю два, поэтому контрольная сумма
+    маскированного ключа, сложенная с контрольной суммой маски, не зависит от значения маски.
+
+    Вычисления для ключа и маски выполняются в одном цикле двумя независимыми цепочками
+    умножений, что позволяет, при наличии инструкции `pclmulqdq`, выполнять их параллельно.
+    По сравнению с функцией ak_ptr_fletcher32_xor() число итераций сокращается в четыре раза.
+
+    @param skey Контекст секретного ключа.
+    @return Функция возвращает 32-х битное значение контрольной суммы.                             */
+/* ----------------------------------------------------------------------------------------------- */
+ static ak_uint32 ak_skey_icode_xor( ak_skey skey )
+{
+  size_t i = 0, len = skey->key_size >> 3, tail = skey->key_size - ( len << 3 );
+  ak_uint64 sk = 0, sm = 0, wk = 0, wm = 0;
+  const ak_uint8 *key = skey->key, *mask = skey->key + skey->key_size;
+
+  for( i = 0; i < len; i++ ) {
+     memcpy( &wk, key + ( i << 3 ), 8 ); wk ^= sk;
+     memcpy( &wm, mask + ( i << 3 ), 8 ); wm ^= sm;
+     ak_gf64_mul( &sk, &wk, &ak_skey_icode_point );
+     ak_gf64_mul( &sm, &wm, &ak_skey_icode_point );
+  }
+  if( tail ) { /* дополняем последнее слово нулями */
+    wk = wm = 0;
+    memcpy( &wk, key + ( len << 3 ), tail ); wk ^= sk;
+    memcpy( &wm, mask + ( len << 3 ), tail ); wm ^= sm;
+    ak_gf64_mul( &sk, &wk, &ak_skey_icode_point );
+    ak_gf64_mul( &sm, &wm, &ak_skey_icode_point );
+  }
+  sk ^= sm;
+ return ( ak_uint32 )( sk ^ ( sk >> 32 ));
+}
+
 /* ----------------------------------------------------------------------------------------------- */
 /*! @param skey Контекст секретного ключа.
     @return В случае успеха функция возвращает \ref ak_error_ok. В противном случае,
@@ -475,8 +633,6 @@
 /* ----------------------------------------------------------------------------------------------- */
  int ak_skey_set_icode_xor( ak_skey skey )
 {
-  ak_uint32 x = 0;
-
  /* "стандартные" проверки указателей и выделения памяти */
   if( skey == NULL ) return ak_error_message( ak_error_null_pointer,
                                          __func__ , "using a null pointer to secret key context" );
@@ -484,14 +640,14 @@
                                                  __func__ , "using a null pointer to key buffer" );
   if( skey->key_size == 0 ) return ak_error_message( ak_error_zero_length, __func__ ,
                                                            "using a key buffer with zero length" );
- /* в силу аддитивности контрольной суммы,
-    мы вычисляем результат последовательно для ключа, а потом для его маски */
-  ak_ptr_fletcher32_xor( skey->key, skey->key_size, &x );
-  ak_ptr_fletcher32_xor( skey->key+skey->key_size, skey->key_size, &skey->icode );
-  skey->icode ^=x;
+ /* в силу линейности контрольной суммы,
+    мы вычисляем результат одновременно для ключа и для его маски */
+  skey->icode = ak_skey_icode_xor( skey );
 
- /* устанавливаем флаг */
+ /* устанавливаем флаг и сбрасываем результат предыдущей проверки,
+    а также признак вычисленных из ключа значений, поскольку значение ключа изменилось */
   skey->flags |= ak_key_flag_set_icode;
+  skey->flags &= ( 0xFFFFFFFFFFFFFFFFLL ^ ( ak_key_flag_icode_checked|ak_key_flag_precomputed ));
 
  return ak_error_ok;
 }
@@ -504,8 +660,6 @@
 /* ----------------------------------------------------------------------------------------------- */
  bool_t ak_skey_check_icode_xor( ak_skey skey )
 {
-  ak_uint32 x = 0, y = 0;
-
  /* "стандартные" проверки указателей и выделения памяти */
   if( skey == NULL ) { ak_error_message( ak_error_null_pointer,
                                          __func__ , "using a null pointer to secret key context" );
@@ -520,15 +674,65 @@
     return ak_false;
   }
 
- /* в силу аддитивности контрольной суммы,
-    мы вычисляем результат последоватлеьно для ключа, а потом для его маски */
-  ak_ptr_fletcher32_xor( skey->key, skey->key_size, &x );
-  ak_ptr_fletcher32_xor( skey->key+skey->key_size, skey->key_size, &y );
-
-  if( skey->icode == ( x^y )) return ak_true;
+  if( skey->icode == ak_skey_icode_xor( skey )) return ak_true;
     else return ak_false;
 }
 
+/* ----------------------------------------------------------------------------------------------- */
+/*! Функция вызывается перед выполнением криптографического преобразования и проверяет
+    контрольную сумму ключа в соответствии с политикой, сохраненной в контексте ключа при его создании:
+
+    - \ref icode_check_every_call_policy -- контрольная сумма проверяется при каждом вызове функции,
+    - \ref icode_check_block_count_policy -- контрольная сумма проверяется, если с момента
+      последней успешной проверки было обработано не менее `key_icode_check_block_count` блоков,
+    - \ref icode_check_time_interval_policy -- контрольная сумма проверяется, если с момента
+      последней успешной проверки прошло не менее `key_icode_check_interval` миллисекунд.
+
+    Отложенная проверка уменьшает накладные расходы при обработке коротких сообщений, однако
+    искажение ключа в памяти может быть обнаружено не при первом вызове после искажения.
+    Отрицательный результат проверки не сохраняется; после присвоения ключу нового значения
+    контрольная сумма всегда проверяется при первом обращении к ключу.
+
+    @param skey Контекст секретного ключа.
+    @param blocks Количество блоков, которые будут обработаны с использованием ключа.
+    @return В случае совпадения контрольной суммы ключа функция возвращает истину (\ref ak_true).
+    В противном случае, возвращается ложь (\ref ak_false).                                         */
+/* ----------------------------------------------------------------------------------------------- */
+ bool_t ak_skey_verify_icode( ak_skey skey, const size_t blocks )
+{
+  if( skey == NULL ) { ak_error_message( ak_error_null_pointer,
+                                         __func__ , "using a null pointer to secret key context" );
+    return ak_false;
+  }
+  if(( skey->flags )&ak_key_flag_icode_checked ) {
+    switch( skey->options.icode_check_policy ) {
+      case icode_check_block_count_policy:
+        if(( skey->icode_blocks += blocks ) < skey->options.icode_check_block_count )
+          return ak_true;
+        break;
+
+      case icode_check_time_interval_policy:
+        if( ak_skey_get_milliseconds() - skey->icode_time < skey->options.icode_check_interval )
+          return ak_true;
+        break;
+
+      default: break;
+    }
+  }
+
+  if( skey->check_icode( skey ) != ak_true ) {
+    skey->flags &= ( 0xFFFFFFFFFFFFFFFFLL ^ ak_key_flag_icode_checked );
+    return ak_false;
+  }
+  if( skey->options.icode_check_policy != icode_check_every_call_policy ) {
+    skey->icode_blocks = 0;
+    if( skey->options.icode_check_policy == icode_check_time_interval_policy )
+      skey->icode_time = ak_skey_get_milliseconds();
+    skey->flags |= ak_key_flag_icode_checked;
+  }
+ return ak_true;
+}
+
 /* ----------------------------------------------------------------------------------------------- */
 /*! Присвоение времени происходит следующим образом. Если `not_before` равно нулю, то
     устанавливается текущее время. Если `not_after` равно нулю или меньше, чем `not_before`,
@@ -11,6 +11,108 @@
 #ifdef AK_HAVE_STDALIGN_H
  #include <stdalign.h>
 #endif
+#ifdef AK_HAVE_BUILTIN_XOR_SI128
+ #include <emmintrin.h>
+#endif
+#ifdef AK_HAVE_PTHREAD_H
+ #include <pthread.h>
+#endif
+
+/* ----------------------------------------------------------------------------------------------- */
+/*! \brief Количество значений tweak, вырабатываемых и обрабатываемых за один раз. */
+ #define ak_xts_batch_tweaks    (8)
+
+/* ----------------------------------------------------------------------------------------------- */
+/*! \brief Рабочие массивы, используемые при обработке данных в режиме xts.
+    \details Массивы размещаются вызывающей функцией и очищаются ею один раз после обработки
+    всех данных, что позволяет не очищать их при обработке каждого сектора. */
+ typedef struct xts_buffer {
+  /*! \brief Значения tweak для группы блоков. */
+   ak_uint64 tweaks[2*ak_xts_batch_tweaks];
+  /*! \brief Входные блоки алгоритма блочного шифрования. */
+   ak_uint64 x[2*ak_xts_batch_tweaks];
+  /*! \brief Выходные блоки алгоритма блочного шифрования. */
+   ak_uint64 y[2*ak_xts_batch_tweaks];
+ } *ak_xts_buffer;
+
+/* ----------------------------------------------------------------------------------------------- */
+/*! Функция вырабатывает `count` последовательных значений tweak, начиная с текущего,
+    и заменяет текущее значение на следующее за последним выработанным.
+    Очередное значение получается из предыдущего умножением на примитивный элемент
+    \f$ \alpha \f$ поля \f$ \mathbb F_{2^{128}}\f$, т.е. сдвигом 128-ми битного вектора на
+    один разряд с приведением по модулю многочлена \f$ x^{128} + x^7 + x^2 + x + 1\f$.
+
+    При наличии инструкций sse2 сдвиг выполняется над регистром целиком: переносы старших битов
+    обеих половин вектора получаются одной знаковой инструкцией сдвига и перестановкой,
+    что исключает условные переходы.
+
+    @param tweak Текущее значение tweak (два 64-х битных слова, младшее слово -- первое).
+    @param tweaks Массив, куда помещаются `count` значений tweak (2*count слов).
+    @param count Количество вырабатываемых значений.                                               */
+/* ----------------------------------------------------------------------------------------------- */
+ static inline void ak_xts_next_tweaks( ak_uint64 *tweak, ak_uint64 *tweaks, size_t count )
+{
+  size_t i = 0;
+#ifdef AK_HAVE_BUILTIN_XOR_SI128
+  const __m128i poly = _mm_set_epi32( 0, 1, 0, 0x87 );
+  __m128i t = _mm_loadu_si128(( __m128i *) tweak ), m;
+
+  for( i = 0; i < count; i++ ) {
+     _mm_storeu_si128(( __m128i *)( tweaks + 2*i ), t );
+     m = _mm_and_si128( _mm_shuffle_epi32( _mm_srai_epi32( t, 31 ), 0x13 ), poly );
+     t = _mm_xor_si128( _mm_add_epi64( t, t ), m );
+  }
+  _mm_storeu_si128(( __m128i *) tweak, t );
+#else
+  ak_uint64 t0 = tweak[0], t1 = tweak[1], c;
+
+  for( i = 0; i < count; i++ ) {
+     tweaks[2*i] = t0; tweaks[2*i+1] = t1;
+     c = t1 >> 63;
+     t1 = ( t1 << 1 )^( t0 >> 63 );
+     t0 = ( t0 << 1 )^( 0x87&( 0 - c ));
+  }
+  tweak[0] = t0; tweak[1] = t1;
+#endif
+}
+
+/* ----------------------------------------------------------------------------------------------- */
+/*! Функция зашифровывает (расшифровывает) данные в режиме xts, начиная с заданного значения tweak.
+
+    Поскольку для шифров с длиной блока 64 бита каждое 128-ми битное значение tweak
+    используется для двух последовательных блоков, в обоих случаях последовательность
+    64-х битных слов, образованная значениями tweak, накладывается на последовательность
+    64-х битных слов данных. Данные обрабатываются группами по \ref ak_xts_batch_tweaks
+    значений tweak (8 блоков шифра Кузнечик или 16 блоков шифра Магма), что позволяет
+    использовать многоблочные реализации алгоритмов блочного шифрования.
+
+    @param encryptionKey Ключ, используемый для шифрования информации.
+    @param tweak Начальное значение tweak; после выполнения функции содержит значение,
+    следующее за последним использованным.
+    @param in Указатель на входные данные.
+    @param out Указатель на выходные данные (может совпадать с `in`).
+    @param size Размер данных (в октетах), кратный длине блока.
+    @param encrypt Флаг зашифрования (ak_true) или расшифрования (ak_false).
+    @param buf Рабочие массивы; очищаются вызывающей функцией.                                     */
+/* ----------------------------------------------------------------------------------------------- */
+ static void ak_bckey_xts_blocks( ak_bckey encryptionKey, ak_uint64 *tweak, ak_pointer in,
+                                   ak_pointer out, size_t size, bool_t encrypt, ak_xts_buffer buf )
+{
+  size_t i, n, words = size >> 3;
+  ak_uint64 *inptr = (ak_uint64 *)in, *outptr = (ak_uint64 *)out;
+
+  while( words > 0 ) {
+    n = ak_min( words, 2*ak_xts_batch_tweaks );
+    ak_xts_next_tweaks( tweak, buf->tweaks, ( n+1 ) >> 1 );
+    for( i = 0; i < n; i++ ) buf->x[i] = inptr[i]^buf->tweaks[i];
+    if( encrypt )
+      ak_bckey_encrypt_blocks( encryptionKey, buf->x, buf->y, ( n << 3 )/encryptionKey->bsize );
+     else
+      ak_bckey_decrypt_blocks( encryptionKey, buf->x, buf->y, ( n << 3 )/encryptionKey->bsize );
+    for( i = 0; i < n; i++ ) outptr[i] = buf->y[i]^buf->tweaks[i];
+    inptr += n; outptr += n; words -= n;
+  }
+}
 
 /* ----------------------------------------------------------------------------------------------- */
 /*! Функция реализует алгоритм двухключевого шифрования, описываемый в стандарте IEEE P 1619.
@@ -37,18 +139,21 @@
                         ak_pointer in, ak_pointer out, size_t size, ak_pointer iv, size_t iv_size )
 {
   int error = ak_error_ok;
-  ak_int64 jcnt = 0, blocks = 0;
-  ak_uint64 *inptr = (ak_uint64 *)in, *outptr = (ak_uint64 *)out;
+  ak_int64 blocks = 0;
 #ifdef AK_HAVE_STDALIGN_H
   alignas(16)
 #endif
-  ak_uint64 tweak[2], t[2], *tptr = t;
+  ak_uint64 tweak[2];
+#ifdef AK_HAVE_STDALIGN_H
+  alignas(16)
+#endif
+  struct xts_buffer buf;
 
  /* проверяем целостность ключа */
-  if( encryptionKey->key.check_icode( &encryptionKey->key ) != ak_true )
+  if( ak_skey_verify_icode( &encryptionKey->key, size/encryptionKey->bsize ) != ak_true )
     return ak_error_message( ak_error_wrong_key_icode, __func__,
                                                "incorrect integrity code of encryption key value" );
-  if( authenticationKey->key.check_icode( &authenticationKey->key ) != ak_true )
+  if( ak_skey_verify_icode( &authenticationKey->key, 1 ) != ak_true )
     return ak_error_message( ak_error_wrong_key_icode, __func__,
                                            "incorrect integrity code of authentication key value" );
 
@@ -82,75 +187,22 @@
    else encryptionKey->key.resource.value.counter -= blocks;
 
  /* запускаем основной цикл обработки блоков информации */
-   switch( encryptionKey->bsize ) {
-     case  8: /* шифр с длиной блока 64 бита */
-       while( blocks > 0 ) {
-          *tptr = *inptr^*(tweak+jcnt); inptr++;
-          encryptionKey->encrypt( &encryptionKey->key, tptr, tptr );
-          *outptr = *tptr ^ *(tweak+jcnt); outptr++;
-          --blocks;
-          tptr++;
-
-          if( !(jcnt = 1 - jcnt)) { /* изменяем значение tweak */
-            tptr = t;
-            t[0] = tweak[0] >> 63; t[1] = tweak[1] >> 63;
-            tweak[0] <<= 1; tweak[1] <<= 1;
-            tweak[1] ^= t[0];
-            if( t[1] ) tweak[0] ^= 0x87;
-          }
-       }
-       break;
-
-     case 16: /* шифр с длиной блока 128 бит */
-       while( blocks > 0 ) {
-         /* шифруем */
-          t[0] = *inptr^*tweak; inptr++;
-          t[1] = *inptr^*(tweak+1); inptr++;
-
-          encryptionKey->encrypt( &encryptionKey->key, t, t );
-          *outptr = t[0]^*tweak; outptr++;
-          *outptr = t[1]^*(tweak+1); outptr++;
-          --blocks;
-
-         /* изменяем значение tweak */
-          t[0] = tweak[0] >> 63;
-          t[1] = tweak[1] >> 63;
-          tweak[0] <<= 1;
-          tweak[1] <<= 1;
-          tweak[1] ^= t[0];
-          if( t[1] ) tweak[0] ^= 0x87;
-       }
-       break;
-   }
+  ak_bckey_xts_blocks( encryptionKey, tweak, in, out, size, ak_true, &buf );
 
  /* очищаем */
   if(( error = ak_ptr_wipe( tweak, sizeof( tweak ), &encryptionKey->key.generator )) != ak_error_ok )
    ak_error_message( error, __func__ , "wrong wiping of tweak value" );
+  ak_ptr_wipe( &buf, sizeof( struct xts_buffer ), &encryptionKey->key.generator );
 
  /* перемаскируем ключ */
-  if(( error = encryptionKey->key.set_mask( &encryptionKey->key )) != ak_error_ok )
+  if(( error = ak_skey_remask( &encryptionKey->key, size/encryptionKey->bsize )) != ak_error_ok )
     ak_error_message( error, __func__ , "wrong remasking of encryption key" );
-  if(( error = authenticationKey->key.set_mask( &authenticationKey->key )) != ak_error_ok )
+  if(( error = ak_skey_remask( &authenticationKey->key, 1 )) != ak_error_ok )
     ak_error_message( error, __func__ , "wrong remasking of authentication key" );
 
   return error;
 }
 
-/* нижеследующий фрагмент выглядит более современно,
-   но дает скорость на 0.5 МБ в секунду медленнее.
-   возможно, я что-то делаю совсем не так....
-
-   #include <immintrin.h>
-
-   _m128i gamma = _mm_set_epi64x( tweak[1], tweak[0] );
-   _m128i data = _mm_set_epi64x( *(inptr+1), *inptr ); inptr += 2;
-
-         data = _mm_xor_si128( data, gamma );
-         encryptionKey->encrypt( &encryptionKey->key, &data, &data );
-         data = _mm_xor_si128( data, gamma );
-         *outptr = _mm_extract_epi64( data, 0 ); outptr++;
-         *outptr = _mm_extract_epi64( data, 1 ); outptr++;
-         --blocks;                                                                                 */
 /* ----------------------------------------------------------------------------------------------- */
 /*! Функция реализует обратное преобразование к алгоритму, реализуемому с помощью
     функции ak_bckey_encrypt_xts().
@@ -172,18 +224,21 @@
                         ak_pointer in, ak_pointer out, size_t size, ak_pointer iv, size_t iv_size )
 {
   int error = ak_error_ok;
-  ak_int64 jcnt = 0, blocks = 0;
-  ak_uint64 *inptr = (ak_uint64 *)in, *outptr = (ak_uint64 *)out;
+  ak_int64 blocks = 0;
+#ifdef AK_HAVE_STDALIGN_H
+  alignas(16)
+#endif
+  ak_uint64 tweak[2];
 #ifdef AK_HAVE_STDALIGN_H
   alignas(16)
 #endif
-  ak_uint64 tweak[2], t[2], *tptr = t;
+  struct xts_buffer buf;
 
  /* проверяем целостность ключа */
-  if( encryptionKey->key.check_icode( &encryptionKey->key ) != ak_true )
+  if( ak_skey_verify_icode( &encryptionKey->key, size/encryptionKey->bsize ) != ak_true )
     return ak_error_message( ak_error_wrong_key_icode, __func__,
                                                "incorrect integrity code of encryption key value" );
-  if( authenticationKey->key.check_icode( &authenticationKey->key ) != ak_true )
+  if( ak_skey_verify_icode( &authenticationKey->key, 1 ) != ak_true )
     return ak_error_message( ak_error_wrong_key_icode, __func__,
                                            "incorrect integrity code of authentication key value" );
 
@@ -217,81 +272,317 @@
    else encryptionKey->key.resource.value.counter -= blocks;
 
  /* запускаем основной цикл обработки блоков информации */
-   switch( encryptionKey->bsize ) {
-     case  8: /* шифр с длиной блока 64 бита */
-       while( blocks > 0 ) {
-          *tptr = *inptr^*(tweak+jcnt); inptr++;
-          encryptionKey->decrypt( &encryptionKey->key, tptr, tptr );
-          *outptr = *tptr ^ *(tweak+jcnt); outptr++;
-          --blocks;
-          tptr++;
-
-          if( !(jcnt = 1 - jcnt)) { /* изменяем значение tweak */
-            tptr = t;
-            t[0] = tweak[0] >> 63; t[1] = tweak[1] >> 63;
-            tweak[0] <<= 1; tweak[1] <<= 1;
-            tweak[1] ^= t[0];
-            if( t[1] ) tweak[0] ^= 0x87;
-          }
-       }
-       break;
-
-     case 16: /* шифр с длиной блока 128 бит */
-       while( blocks > 0 ) {
-         /* шифруем */
-          t[0] = *inptr^*tweak; inptr++;
-          t[1] = *inptr^*(tweak+1); inptr++;
-
-          encryptionKey->decrypt( &encryptionKey->key, t, t );
-          *outptr = t[0]^*tweak; outptr++;
-          *outptr = t[1]^*(tweak+1); outptr++;
-          --blocks;
-
-         /* изменяем значение tweak */
-          t[0] = tweak[0] >> 63;
-          t[1] = tweak[1] >> 63;
-          tweak[0] <<= 1;
-          tweak[1] <<= 1;
-          tweak[1] ^= t[0];
-          if( t[1] ) tweak[0] ^= 0x87;
-       }
-       break;
-   }
+  ak_bckey_xts_blocks( encryptionKey, tweak, in, out, size, ak_false, &buf );
 
  /* очищаем */
   if(( error = ak_ptr_wipe( tweak, sizeof( tweak ), &encryptionKey->key.generator )) != ak_error_ok )
    ak_error_message( error, __func__ , "wrong wiping of tweak value" );
+  ak_ptr_wipe( &buf, sizeof( struct xts_buffer ), &encryptionKey->key.generator );
 
  /* перемаскируем ключ */
-  if(( error = encryptionKey->key.set_mask( &encryptionKey->key )) != ak_error_ok )
+  if(( error = ak_skey_remask( &encryptionKey->key, size/encryptionKey->bsize )) != ak_error_ok )
     ak_error_message( error, __func__ , "wrong remasking of encryption key" );
-  if(( error = authenticationKey->key.set_mask( &authenticationKey->key )) != ak_error_ok )
+  if(( error = ak_skey_remask( &authenticationKey->key, 1 )) != ak_error_ok )
     ak_error_message( error, __func__ , "wrong remasking of authentication key" );
 
   return error;
 }
 
 /* ----------------------------------------------------------------------------------------------- */
-/*                 реализация режима аутентифицирующего шифрования xtsmac                          */
+/*                 шифрование последовательности секторов в режиме xts                             */
+/* ----------------------------------------------------------------------------------------------- */
+/*! Функция зашифровывает (расшифровывает) последовательность секторов одинаковой длины.
+    Для каждого сектора начальное значение tweak вырабатывается из его номера, записанного
+    в формате little endian в 128-ми битный вектор, так же, как это делает функция
+    ak_bckey_encrypt_xts() для синхропосылки. Значения tweak вырабатываются сразу
+    для \ref ak_xts_batch_tweaks секторов с использованием многоблочного зашифрования.
+
+    Проверки ключей и изменение их ресурса функцией не производятся.
+
+    @param encryptionKey Ключ, используемый для шифрования информации.
+    @param authenticationKey Ключ, используемый для выработки значений tweak.
+    @param in Указатель на входные данные.
+    @param out Указатель на выходные данные (может совпадать с `in`).
+    @param sectors Количество секторов.
+    @param sector Номер первого сектора.
+    @param sector_size Длина сектора (в октетах), кратная длине блока.
+    @param encrypt Флаг зашифрования (ak_true) или расшифрования (ak_false).                       */
+/* ----------------------------------------------------------------------------------------------- */
+ static void ak_bckey_xts_sectors_process( ak_bckey encryptionKey, ak_bckey authenticationKey,
+                       ak_uint8 *in, ak_uint8 *out, size_t sectors, ak_uint64 sector,
+                                                             size_t sector_size, bool_t encrypt )
+{
+  size_t i, n;
+  ak_uint64 *x = NULL, *y = NULL;
+#ifdef AK_HAVE_STDALIGN_H
+  alignas(16)
+#endif
+  ak_uint64 tweaks[2*ak_xts_batch_tweaks];
+#ifdef AK_HAVE_STDALIGN_H
+  alignas(16)
+#endif
+  struct xts_buffer buf;
+
+ /* до обработки секторов рабочие массивы используются для выработки значений tweak */
+  x = buf.x; y = buf.y;
+  while( sectors > 0 ) {
+    n = ak_min( sectors, ak_xts_batch_tweaks );
+    memset( x, 0, sizeof( buf.x ));
+    if( authenticationKey->bsize == 8 ) {
+     /* номера секторов помещаются последовательно; старшая половина вектора равна нулю,
+        поэтому второе зашифрование применяется непосредственно к результату первого */
+      for( i = 0; i < n; i++ )
+      #ifdef AK_LITTLE_ENDIAN
+         x[i] = sector + i;
+      #else
+         x[i] = bswap_64( sector + i );
+      #endif
+      ak_bckey_encrypt_blocks( authenticationKey, x, y, n );
+      ak_bckey_encrypt_blocks( authenticationKey, y, x, n );
+      for( i = 0; i < n; i++ ) { tweaks[2*i] = y[i]; tweaks[2*i+1] = x[i]; }
+    } else {
+        for( i = 0; i < n; i++ )
+        #ifdef AK_LITTLE_ENDIAN
+           x[2*i] = sector + i;
+        #else
+           x[2*i] = bswap_64( sector + i );
+        #endif
+        ak_bckey_encrypt_blocks( authenticationKey, x, tweaks, n );
+      }
+
+    for( i = 0; i < n; i++ ) {
+       ak_bckey_xts_blocks( encryptionKey, tweaks + 2*i, in, out, sector_size, encrypt, &buf );
+       in += sector_size; out += sector_size;
+    }
+    sector += n; sectors -= n;
+  }
+ /* очищаем */
+  ak_ptr_wipe( tweaks, sizeof( tweaks ), &encryptionKey->key.generator );
+  ak_ptr_wipe( &buf, sizeof( struct xts_buffer ), &encryptionKey->key.generator );
+}
+
+#ifdef AK_HAVE_PTHREAD_H
 /* ----------------------------------------------------------------------------------------------- */
-/** \addtogroup aead-doc
- @{ */
-/*! \brief Структура, содержащая текущее состояние внутренних переменных режима `xtsmac`
-   аутентифицированного шифрования. */
- typedef struct xtsmac_ctx {
-  /*! \brief Текущее значение имитовставки. */
-   ak_uint64 sum[2];
-  /*! \brief Вектор, используемый для маскирования шифруемой информации. */
-   ak_uint64 gamma[6];
-  /*! \brief Размер обработанных зашифровываемых/расшифровываемых данных в битах. */
-   ssize_t pbitlen;
-  /*! \brief Размер обработанных ассоциированных данных в битах. */
-   ssize_t abitlen;
-  /*! \brief Флаги состояния контекста. */
-   ak_uint32 flags;
-} *ak_xtsmac_ctx;
-/** @} */
+/*! \brief Последовательность секторов, обрабатываемая одним потоком. */
+ typedef struct bckey_xts_piece {
+  /*! \brief Копия ключа шифрования, используемая потоком. */
+   struct bckey encryptionKey;
+  /*! \brief Копия ключа выработки значений tweak, используемая потоком. */
+   struct bckey authenticationKey;
+  /*! \brief Указатель на входные данные. */
+   ak_uint8 *in;
+  /*! \brief Указатель на выходные данные. */
+   ak_uint8 *out;
+  /*! \brief Количество секторов. */
+   size_t sectors;
+  /*! \brief Номер первого сектора. */
+   ak_uint64 sector;
+  /*! \brief Длина сектора (в октетах). */
+   size_t sector_size;
+  /*! \brief Флаг зашифрования. */
+   bool_t encrypt;
+  /*! \brief Дескриптор потока. */
+   pthread_t thread;
+  /*! \brief Флаг того, что поток был успешно создан. */
+   bool_t started;
+ } *ak_bckey_xts_piece;
 
+/* ----------------------------------------------------------------------------------------------- */
+/*! \brief Функция потока, обрабатывающая последовательность секторов. */
+ static void *ak_bckey_xts_sectors_thread( void *ptr )
+{
+  ak_bckey_xts_piece piece = ( ak_bckey_xts_piece ) ptr;
+  ak_bckey_xts_sectors_process( &piece->encryptionKey, &piece->authenticationKey,
+            piece->in, piece->out, piece->sectors, piece->sector, piece->sector_size, piece->encrypt );
+ return NULL;
+}
+#endif
+
+/* ----------------------------------------------------------------------------------------------- */
+/*! \brief Общая часть функций ak_bckey_encrypt_xts_sectors() и ak_bckey_decrypt_xts_sectors(). */
+/* ----------------------------------------------------------------------------------------------- */
+ static int ak_bckey_xts_sectors( ak_bckey encryptionKey, ak_bckey authenticationKey,
+                               ak_pointer in, ak_pointer out, size_t size, ak_uint64 sector,
+                                             size_t sector_size, size_t threads, bool_t encrypt )
+{
+  int error = ak_error_ok;
+  size_t blocks = 0, sectors = 0;
+#ifdef AK_HAVE_PTHREAD_H
+  size_t i, count = 0, first = 0;
+  ak_bckey_xts_piece pieces = NULL;
+#endif
+
+  if(( encryptionKey == NULL ) || ( authenticationKey == NULL ))
+    return ak_error_message( ak_error_null_pointer, __func__,
+                                                        "using null pointer to block cipher key" );
+  if(( sector_size == 0 ) || ( sector_size%encryptionKey->bsize != 0 ))
+    return ak_error_message( ak_error_wrong_block_cipher_length,
+                                __func__ , "the length of sector is not divided by block length" );
+  if( size%sector_size != 0 )
+    return ak_error_message( ak_error_wrong_length,
+                                 __func__ , "the length of input data is not divided by sector length" );
+  sectors = size/sector_size;
+  blocks = size/encryptionKey->bsize;
+
+ /* проверяем целостность ключей один раз для всех секторов */
+  if( ak_skey_verify_icode( &encryptionKey->key, blocks ) != ak_true )
+    return ak_error_message( ak_error_wrong_key_icode, __func__,
+                                               "incorrect integrity code of encryption key value" );
+  if( ak_skey_verify_icode( &authenticationKey->key, sectors ) != ak_true )
+    return ak_error_message( ak_error_wrong_key_icode, __func__,
+                                           "incorrect integrity code of authentication key value" );
+ /* проверяем ресурс ключей */
+  if( authenticationKey->key.resource.value.counter <
+                                      ( ssize_t )( sectors*( authenticationKey->bsize >> 3 )))
+    return ak_error_message( ak_error_low_key_resource,
+                                              __func__ , "low resource of authentication cipher key" );
+  if( encryptionKey->key.resource.value.counter < ( ssize_t ) blocks )
+    return ak_error_message( ak_error_low_key_resource,
+                                              __func__ , "low resource of encryption cipher key" );
+
+#ifdef AK_HAVE_PTHREAD_H
+  threads = ak_min( ak_bckey_get_threads_count( threads ), blocks/ak_bckey_thread_blocks );
+  threads = ak_min( threads, sectors );
+ /* ключи, которые не могут быть скопированы, обрабатываются последовательно */
+  if( !ak_bckey_is_duplicable( encryptionKey ) || !ak_bckey_is_duplicable( authenticationKey ))
+    threads = 1;
+ /* формируем последовательности секторов и копии ключей для каждого потока;
+    копии создаются до изменения ресурса, при ошибке данные обрабатываются последовательно */
+  if(( threads > 1 ) && (( pieces = calloc( threads, sizeof( struct bckey_xts_piece ))) != NULL )) {
+    for( count = 0; count < threads; count++ ) {
+       ak_bckey_xts_piece piece = pieces + count;
+       size_t len = sectors/threads + ( count < sectors%threads );
+
+       if(( error = ak_bckey_create_and_set_bckey( &piece->encryptionKey,
+                                                             encryptionKey )) != ak_error_ok ) break;
+       if(( error = ak_bckey_create_and_set_bckey( &piece->authenticationKey,
+                                                         authenticationKey )) != ak_error_ok ) {
+         ak_bckey_destroy( &piece->encryptionKey );
+         break;
+       }
+       piece->in = ( ak_uint8 *)in + first*sector_size;
+       piece->out = ( ak_uint8 *)out + first*sector_size;
+       piece->sectors = len;
+       piece->sector = sector + first;
+       piece->sector_size = sector_size;
+       piece->encrypt = encrypt;
+       first += len;
+    }
+    if( error != ak_error_ok ) {
+      ak_error_message( error, __func__,
+                                   "incorrect key duplication, sectors are processed serially" );
+      for( i = 0; i < count; i++ ) {
+         ak_bckey_destroy( &pieces[i].encryptionKey );
+         ak_bckey_destroy( &pieces[i].authenticationKey );
+      }
+      free( pieces );
+      pieces = NULL;
+      error = ak_error_ok;
+    }
+  }
+#else
+  (void) threads;
+#endif
+
+ /* изменяем ресурс ключей */
+  authenticationKey->key.resource.value.counter -=
+                                               ( ssize_t )( sectors*( authenticationKey->bsize >> 3 ));
+  encryptionKey->key.resource.value.counter -= ( ssize_t ) blocks;
+
+#ifdef AK_HAVE_PTHREAD_H
+  if( pieces != NULL ) {
+   /* запускаем потоки; первая последовательность секторов, а также последовательности,
+                                  для которых не удалось создать поток, обрабатываются здесь */
+    for( i = 1; i < count; i++ )
+       pieces[i].started = ( pthread_create( &pieces[i].thread, NULL,
+                                               ak_bckey_xts_sectors_thread, pieces + i ) == 0 );
+    ak_bckey_xts_sectors_thread( pieces );
+    for( i = 1; i < count; i++ ) {
+       if( pieces[i].started ) pthread_join( pieces[i].thread, NULL );
+         else ak_bckey_xts_sectors_thread( pieces + i );
+    }
+    for( i = 0; i < count; i++ ) {
+       ak_bckey_destroy( &pieces[i].encryptionKey );
+       ak_bckey_destroy( &pieces[i].authenticationKey );
+    }
+    free( pieces );
+  } else
+#endif
+   ak_bckey_xts_sectors_process( encryptionKey, authenticationKey,
+                                                  in, out, sectors, sector, sector_size, encrypt );
+
+ /* перемаскируем ключи */
+  if( error == ak_error_ok ) {
+    if(( error = ak_skey_remask( &encryptionKey->key, blocks )) != ak_error_ok )
+      ak_error_message( error, __func__ , "wrong remasking of encryption key" );
+    if(( error = ak_skey_remask( &authenticationKey->key, sectors )) != ak_error_ok )
+      ak_error_message( error, __func__ , "wrong remasking of authentication key" );
+  }
+ return error;
+}
+
+/* ----------------------------------------------------------------------------------------------- */
+/*! Функция зашифровывает последовательность секторов одинаковой длины в режиме xts,
+    описываемом в стандарте IEEE P 1619, и предназначена для шифрования блочных устройств.
+    Результат совпадает с последовательным вызовом функции ak_bckey_encrypt_xts() для каждого
+    сектора, в котором синхропосылкой является номер сектора, записанный в 16 октетов
+    в формате little endian.
+
+    В отличие от последовательных вызовов, проверка целостности ключей, изменение их ресурса
+    и перемаскирование выполняются один раз для всех секторов. При достаточном объеме данных
+    последовательность секторов разбивается на непрерывные фрагменты, которые обрабатываются
+    в отдельных потоках с использованием копий ключей.
+
+    @param encryptionKey Ключ, используемый для шифрования информации
+    @param authenticationKey Ключ, используемый для выработки значений tweak
+    @param in Указатель на область памяти, где хранятся входные (открытые) данные
+    @param out Указатель на область памяти, куда будут помещены зашифровываемые данные
+    (этот указатель может совпадать с `in`)
+    @param size Размер входных данных (в октетах), должен быть кратен длине сектора
+    @param sector Номер первого сектора
+    @param sector_size Длина сектора (в октетах), должна быть кратна длине блока
+    @param threads Количество используемых потоков; нулевое значение означает, что
+    количество потоков совпадает с количеством доступных процессорных ядер.
+
+    @return В случае успеха функция возвращает \ref ak_error_ok (ноль). В случае возникновения
+    ошибки возвращается ее код.                                                                    */
+/* ----------------------------------------------------------------------------------------------- */
+ int ak_bckey_encrypt_xts_sectors( ak_bckey encryptionKey, ak_bckey authenticationKey,
+                               ak_pointer in, ak_pointer out, size_t size, ak_uint64 sector,
+                                                               size_t sector_size, size_t threads )
+{
+ return ak_bckey_xts_sectors( encryptionKey, authenticationKey,
+                                            in, out, size, sector, sector_size, threads, ak_true );
+}
+
+/* ----------------------------------------------------------------------------------------------- */
+/*! Функция реализует обратное преобразование к алгоритму, реализуемому с помощью
+    функции ak_bckey_encrypt_xts_sectors().
+
+    @param encryptionKey Ключ, используемый для шифрования информации
+    @param authenticationKey Ключ, используемый для выработки значений tweak
+    @param in Указатель на область памяти, где хранятся входные (зашифрованные) данные
+    @param out Указатель на область памяти, куда будут помещены расшифрованные данные
+    (этот указатель может совпадать с `in`)
+    @param size Размер входных данных (в октетах), должен быть кратен длине сектора
+    @param sector Номер первого сектора
+    @param sector_size Длина сектора (в октетах), должна быть кратна длине блока
+    @param threads Количество используемых потоков; нулевое значение означает, что
+    количество потоков совпадает с количеством доступных процессорных ядер.
+
+    @return В случае успеха функция возвращает \ref ak_error_ok (ноль). В случае возникновения
+    ошибки возвращается ее код.                                                                    */
+/* ----------------------------------------------------------------------------------------------- */
+ int ak_bckey_decrypt_xts_sectors( ak_bckey encryptionKey, ak_bckey authenticationKey,
+                               ak_pointer in, ak_pointer out, size_t size, ak_uint64 sector,
+                                                               size_t sector_size, size_t threads )
+{
+ return ak_bckey_xts_sectors( encryptionKey, authenticationKey,
+                                           in, out, size, sector, sector_size, threads, ak_false );
+}
+
+/* ----------------------------------------------------------------------------------------------- */
+/*                 реализация режима аутентифицирующего шифрования xtsmac                          */
 /* ----------------------------------------------------------------------------------------------- */
  static int ak_xtsmac_authentication_clean( ak_xtsmac_ctx ctx,
                             ak_bckey authenticationKey, const ak_pointer iv, const size_t iv_size )
@@ -446,6 +737,75 @@
             ak_xtsmac_next_gamma; \
          }
 
+/* ----------------------------------------------------------------------------------------------- */
+/*! Функция добавляет к текущему значению имитовставки слагаемые, вычисленные для `count`
+    последовательных 16-ти байтных блоков, полученных в результате зашифрования.
+    Вычисление слагаемых не зависит от порядка их следования, что позволяет обрабатывать
+    блоки сразу после многоблочного зашифрования.                                                  */
+/* ----------------------------------------------------------------------------------------------- */
+ static inline void ak_xtsmac_sum_blocks( ak_xtsmac_ctx ctx, const ak_uint64 *y, size_t count )
+{
+  size_t i;
+  register ak_uint64 v = 0;
+#ifdef AK_HAVE_STDALIGN_H
+  alignas(32)
+#endif
+  ak_uint64 t[2];
+  ak_uint8 *tb = (ak_uint8 *)t;
+
+  for( i = 0; i < count; i++ ) {
+     t[0] = y[2*i]; t[1] = y[2*i+1];
+     ak_xtsmac_update_sum;
+  }
+}
+
+/* ----------------------------------------------------------------------------------------------- */
+/*! Функция обрабатывает `blocks` полных 16-ти байтных блоков данных в режиме `xtsmac`.
+    Последовательные значения гаммы вырабатываются группами по \ref ak_xts_batch_tweaks
+    (гамма изменяется так же, как значение tweak в режиме xts), после чего вся группа
+    блоков зашифровывается (расшифровывается) одним вызовом многоблочной функции
+    и только затем обрабатывается для вычисления имитовставки.
+
+    @param ctx Контекст режима `xtsmac`.
+    @param bkey Ключ аутентификации (при `mode` равном нулю) или ключ шифрования.
+    @param in Указатель на входные данные.
+    @param out Указатель на выходные данные (не используется при `mode` равном нулю).
+    @param blocks Количество обрабатываемых 16-ти байтных блоков.
+    @param mode Вид преобразования: 0 - обработка ассоциированных данных,
+    1 - зашифрование, 2 - расшифрование.
+    @param buf Рабочие массивы; очищаются вызывающей функцией.                                     */
+/* ----------------------------------------------------------------------------------------------- */
+ static void ak_xtsmac_blocks( ak_xtsmac_ctx ctx, ak_bckey bkey, const ak_uint64 *in,
+                               ak_uint64 *out, size_t blocks, const int mode, ak_xts_buffer buf )
+{
+  size_t i, n;
+
+  while( blocks > 0 ) {
+    n = ak_min( blocks, ak_xts_batch_tweaks );
+    ak_xts_next_tweaks( ctx->gamma, buf->tweaks, n );
+    for( i = 0; i < 2*n; i++ ) buf->x[i] = in[i]^buf->tweaks[i];
+    switch( mode ) {
+      case 0: /* ассоциированные данные */
+        ak_bckey_encrypt_blocks( bkey, buf->x, buf->y, ( n << 4 )/bkey->bsize );
+        ak_xtsmac_sum_blocks( ctx, buf->y, n );
+        break;
+      case 1: /* зашифрование */
+        ak_bckey_encrypt_blocks( bkey, buf->x, buf->y, ( n << 4 )/bkey->bsize );
+        for( i = 0; i < 2*n; i++ ) out[i] = buf->y[i]^buf->tweaks[i];
+        ak_xtsmac_sum_blocks( ctx, buf->y, n );
+        break;
+      default: /* расшифрование */
+        ak_xtsmac_sum_blocks( ctx, buf->x, n );
+        ak_bckey_decrypt_blocks( bkey, buf->x, buf->y, ( n << 4 )/bkey->bsize );
+        for( i = 0; i < 2*n; i++ ) out[i] = buf->y[i]^buf->tweaks[i];
+        break;
+    }
+    in += 2*n;
+    if( out != NULL ) out += 2*n;
+    blocks -= n;
+  }
+}
+
 /* ----------------------------------------------------------------------------------------------- */
  static int ak_xtsmac_authentication_update( ak_xtsmac_ctx ctx,
                       ak_bckey authenticationKey, const ak_pointer adata, const size_t adata_size )
@@ -457,6 +817,7 @@
 #endif
   ak_uint64 t[2], temp[2] = { 0, 0 };
   ak_uint8 *tb = (ak_uint8 *)&t;
+  struct xts_buffer buf;
   ssize_t tail = ( ssize_t )( adata_size&0xf ),
           blocks = ( ssize_t )( adata_size >> 4 ),
           resource = (( blocks + (tail > 0)) << 1)/( authenticationKey->bsize >> 3 );
@@ -475,13 +836,13 @@
   else authenticationKey->key.resource.value.counter -= resource;
 
  /* теперь основной цикл */
+  ak_xtsmac_blocks( ctx, authenticationKey, inptr, NULL, blocks, 0, &buf );
+  ak_ptr_wipe( &buf, sizeof( buf ), &authenticationKey->key.generator );
+  ctx->abitlen += ( blocks << 7 );
+  inptr += ( blocks << 1 );
+
   switch( authenticationKey->bsize ) {
      case  8: /* шифр с длиной блока 64 бита */
-       while( blocks > 0 ) {
-          ak_xtsmac_authenticate_step64( inptr );
-          ctx->abitlen += 128;
-          --blocks;
-       }
        if( tail ) {
           ak_uint64 *tptr = temp;
           memcpy( temp, inptr, tail ); /* копируем входные данные (здесь меньше одного 16-ти байтного блока) */
@@ -492,11 +853,6 @@
        break;
 
      case 16: /* шифр с длиной блока 128 бит */
-       while( blocks > 0 ) {
-          ak_xtsmac_authenticate_step128( inptr );
-          ctx->abitlen += 128;
-          --blocks;
-       }
        if( tail ) {
           ak_uint64 *tptr = temp;
           memcpy( temp, inptr, tail ); /* копируем входные данные */
@@ -617,6 +973,7 @@
 #endif
   ak_uint64 t[2], temp[2] = { 0, 0 };
   ak_uint8 *tb = (ak_uint8 *)t;
+  struct xts_buffer buf;
   ssize_t i = 0,
           tail = ( ssize_t )( size&0xf ),
           blocks = ( ssize_t )( size >> 4 ),
@@ -639,23 +996,10 @@
   else encryptionKey->key.resource.value.counter -= resource;
 
  /* теперь основной цикл */
-  switch( encryptionKey->bsize ) {
-     case  8: /* шифр с длиной блока 64 бита */
-       while( blocks > 0 ) {
-          ak_xtsmac_encrypt_step64( inptr, outptr );
-          ctx->pbitlen += 128;
-          --blocks;
-       }
-       break;
-
-     case 16: /* шифр с длиной блока 128 бит */
-       while( blocks > 0 ) {
-          ak_xtsmac_encrypt_step128( inptr, outptr );
-          ctx->pbitlen += 128;
-          --blocks;
-       }
-       break;
-  }
+  ak_xtsmac_blocks( ctx, encryptionKey, inptr, outptr, blocks, 1, &buf );
+  ak_ptr_wipe( &buf, sizeof( buf ), &encryptionKey->key.generator );
+  ctx->pbitlen += ( blocks << 7 );
+  inptr += ( blocks << 1 ); outptr += ( blocks << 1 );
 
   if( tail ) { /* реализуем "скрадывание" шифртекста таким образом, чтобы длина шифртекста
                                                                    совпадала с длиной открытого  */
@@ -690,6 +1034,7 @@
 #endif
   ak_uint64 t[2], temp[2] = { 0, 0 };
   ak_uint8 *tb = (ak_uint8 *)t;
+  struct xts_buffer buf;
   ssize_t i = 0,
           tail = ( ssize_t )( size&0xf ),
           blocks = ( ssize_t )( size >> 4 ),
@@ -713,23 +1058,11 @@
   else encryptionKey->key.resource.value.counter -= resource;
 
  /* теперь основной цикл */
-  switch( encryptionKey->bsize ) {
-     case  8: /* шифр с длиной блока 64 бита */
-       while( blocks > ( tail > 0 )) {
-          ak_xtsmac_decrypt_step64( inptr, outptr );
-          ctx->pbitlen += 128;
-          --blocks;
-       }
-       break;
-
-     case 16: /* шифр с длиной блока 128 бит */
-       while( blocks > ( tail > 0 )) {
-          ak_xtsmac_decrypt_step128( inptr, outptr );
-          ctx->pbitlen += 128;
-          --blocks;
-       }
-       break;
-  }
+  blocks -= ( tail > 0 ); /* последний полный блок обрабатывается вместе с неполным */
+  ak_xtsmac_blocks( ctx, encryptionKey, inptr, outptr, blocks, 2, &buf );
+  ak_ptr_wipe( &buf, sizeof( buf ), &encryptionKey->key.generator );
+  ctx->pbitlen += ( blocks << 7 );
+  inptr += ( blocks << 1 ); outptr += ( blocks << 1 );
 
   if( tail ) { /* восстановливаем "скраденый" шифртекст */
     size_t adlen = 16 - tail;
@@ -926,6 +1259,171 @@
  return ak_error_not_equal_data;
 }
 
+/* ----------------------------------------------------------------------------------------------- */
+/*                  функции для обработки данных последовательными фрагментами                     */
+/* ----------------------------------------------------------------------------------------------- */
+/*! Функция проверяет переданные ключи, присваивает контексту синхропосылку и подготавливает его
+    к обработке ассоциированных и шифруемых данных. Требования к ключам аналогичны требованиям
+    функции ak_bckey_encrypt_xtsmac().
+
+    После вызова функции ak_xtsmac_finalize() контекст может быть повторно использован для
+    обработки новых данных - для этого необходимо снова вызвать функцию ak_xtsmac_clean().
+
+    @param xmac Контекст режима `xtsmac`.
+    @param encryptionKey Ключ шифрования.
+    @param authenticationKey Ключ выработки имитовставки.
+    @param iv Указатель на синхропосылку.
+    @param iv_size Длина синхропосылки в байтах.
+
+    @return В случае успеха функция возвращает \ref ak_error_ok (ноль). В противном случае
+    возвращается код ошибки.                                                                       */
+/* ----------------------------------------------------------------------------------------------- */
+ int ak_xtsmac_clean( ak_xtsmac xmac, ak_bckey encryptionKey, ak_bckey authenticationKey,
+                                                      const ak_pointer iv, const size_t iv_size )
+{
+  int error = ak_error_ok;
+
+  if( xmac == NULL ) return ak_error_message( ak_error_null_pointer, __func__ ,
+                                                             "using null pointer to xtsmac context");
+  if(( encryptionKey == NULL ) || ( authenticationKey == NULL ))
+    return ak_error_message( ak_error_null_pointer, __func__ ,"using null pointer to secret key" );
+  if( encryptionKey->bsize != authenticationKey->bsize )
+    return ak_error_message( ak_error_not_equal_data, __func__,
+                                                    "different block sizes for given secret keys");
+
+  xmac->encryptionKey = encryptionKey;
+  xmac->authenticationKey = authenticationKey;
+  if(( error = ak_xtsmac_authentication_clean( &xmac->ctx,
+                                            authenticationKey, iv, iv_size )) != ak_error_ok ) {
+    ak_ptr_wipe( &xmac->ctx, sizeof( struct xtsmac_ctx ), &authenticationKey->key.generator );
+    xmac->ctx.flags = ak_aead_assosiated_data_bit | ak_aead_encrypted_data_bit;
+    return ak_error_message( error, __func__,
+                                           "incorrect initialization of internal xtsmac context" );
+  }
+
+ return ak_error_ok;
+}
+
+/* ----------------------------------------------------------------------------------------------- */
+/*! Функция обрабатывает очередной фрагмент ассоциированных данных. Длина фрагмента должна быть
+    кратна 16 октетам; фрагмент, длина которого не кратна 16 октетам, воспринимается как
+    последний. Все ассоциированные данные должны быть обработаны до начала зашифрования
+    (расшифрования) данных.
+
+    @param xmac Контекст режима `xtsmac`, инициализированный функцией ak_xtsmac_clean().
+    @param adata Указатель на ассоциированные данные.
+    @param adata_size Длина ассоциированных данных в байтах.
+
+    @return В случае успеха функция возвращает \ref ak_error_ok (ноль). В противном случае
+    возвращается код ошибки.                                                                       */
+/* ----------------------------------------------------------------------------------------------- */
+ int ak_xtsmac_adata_update( ak_xtsmac xmac, const ak_pointer adata, const size_t adata_size )
+{
+  int error = ak_error_ok;
+
+  if( xmac == NULL ) return ak_error_message( ak_error_null_pointer, __func__ ,
+                                                             "using null pointer to xtsmac context");
+  if(( error = ak_xtsmac_authentication_update( &xmac->ctx,
+                                xmac->authenticationKey, adata, adata_size )) != ak_error_ok )
+    return ak_error_message( error, __func__, "incorrect hashing of associated data" );
+
+ return ak_error_ok;
+}
+
+/* ----------------------------------------------------------------------------------------------- */
+/*! Функция зашифровывает очередной фрагмент данных и обновляет текущее значение имитовставки.
+    Длина фрагмента должна быть кратна 16 октетам; фрагмент, длина которого не кратна 16 октетам,
+    воспринимается как последний и должен иметь длину не менее 16 октетов.
+    После первого вызова функции обработка ассоциированных данных невозможна.
+
+    @param xmac Контекст режима `xtsmac`, инициализированный функцией ak_xtsmac_clean().
+    @param in Указатель на зашифровываемые данные.
+    @param out Указатель на область памяти, куда помещаются зашифрованные данные;
+    может совпадать с указателем `in`.
+    @param size Размер зашифровываемых данных в байтах.
+
+    @return В случае успеха функция возвращает \ref ak_error_ok (ноль). В противном случае
+    возвращается код ошибки.                                                                       */
+/* ----------------------------------------------------------------------------------------------- */
+ int ak_xtsmac_encrypt_update( ak_xtsmac xmac, const ak_pointer in,
+                                                             ak_pointer out, const size_t size )
+{
+  int error = ak_error_ok;
+
+  if( xmac == NULL ) return ak_error_message( ak_error_null_pointer, __func__ ,
+                                                             "using null pointer to xtsmac context");
+ /* закрываем добавление ассоциированных данных */
+  ak_aead_set_bit( xmac->ctx.flags, ak_aead_assosiated_data_bit );
+  if(( error = ak_xtsmac_encryption_update( &xmac->ctx,
+                                        xmac->encryptionKey, in, out, size )) != ak_error_ok )
+    return ak_error_message( error, __func__, "incorrect encryption of plain data" );
+
+ return ak_error_ok;
+}
+
+/* ----------------------------------------------------------------------------------------------- */
+/*! Функция расшифровывает очередной фрагмент данных и обновляет текущее значение имитовставки.
+    Требования к длине фрагмента аналогичны требованиям функции ak_xtsmac_encrypt_update().
+
+    \note Расшифрованные данные следует использовать только после того, как значение
+    имитовставки, выработанное функцией ak_xtsmac_finalize(), совпадет с ожидаемым.
+
+    @param xmac Контекст режима `xtsmac`, инициализированный функцией ak_xtsmac_clean().
+    @param in Указатель на расшифровываемые данные.
+    @param out Указатель на область памяти, куда помещаются расшифрованные данные;
+    может совпадать с указателем `in`.
+    @param size Размер расшифровываемых данных в байтах.
+
+    @return В случае успеха функция возвращает \ref ak_error_ok (ноль). В противном случае
+    возвращается код ошибки.                                                                       */
+/* ----------------------------------------------------------------------------------------------- */
+ int ak_xtsmac_decrypt_update( ak_xtsmac xmac, const ak_pointer in,
+                                                             ak_pointer out, const size_t size )
+{
+  int error = ak_error_ok;
+
+  if( xmac == NULL ) return ak_error_message( ak_error_null_pointer, __func__ ,
+                                                             "using null pointer to xtsmac context");
+ /* закрываем добавление ассоциированных данных */
+  ak_aead_set_bit( xmac->ctx.flags, ak_aead_assosiated_data_bit );
+  if(( error = ak_xtsmac_decryption_update( &xmac->ctx,
+                                        xmac->encryptionKey, in, out, size )) != ak_error_ok )
+    return ak_error_message( error, __func__, "incorrect decryption of encrypted data" );
+
+ return ak_error_ok;
+}
+
+/* ----------------------------------------------------------------------------------------------- */
+/*! Функция вырабатывает значение имитовставки и очищает внутреннее состояние контекста.
+
+    @param xmac Контекст режима `xtsmac`.
+    @param icode Указатель на область памяти, куда помещается значение имитовставки.
+    @param icode_size Ожидаемый размер имитовставки в байтах; значение не должно превышать
+    16 октетов.
+
+    @return В случае успеха функция возвращает \ref ak_error_ok (ноль). В противном случае
+    возвращается код ошибки.                                                                       */
+/* ----------------------------------------------------------------------------------------------- */
+ int ak_xtsmac_finalize( ak_xtsmac xmac, ak_pointer icode, const size_t icode_size )
+{
+  int error = ak_error_ok;
+
+  if( xmac == NULL ) return ak_error_message( ak_error_null_pointer, __func__ ,
+                                                             "using null pointer to xtsmac context");
+  if( xmac->authenticationKey == NULL ) return ak_error_message( ak_error_null_pointer, __func__,
+                                                           "using uninitialized xtsmac context" );
+  if(( error = ak_xtsmac_authentication_finalize( &xmac->ctx,
+                              xmac->authenticationKey, icode, icode_size )) != ak_error_ok )
+    ak_error_message( error, __func__, "incorrect finalize of integrity code" );
+
+  ak_ptr_wipe( &xmac->ctx, sizeof( struct xtsmac_ctx ), &xmac->authenticationKey->key.generator );
+ /* до следующего вызова ak_xtsmac_clean() обработка данных невозможна */
+  xmac->ctx.abitlen = xmac->ctx.pbitlen = 0;
+  xmac->ctx.flags = ak_aead_assosiated_data_bit | ak_aead_encrypted_data_bit;
+
+ return error;
+}
+
 /* ----------------------------------------------------------------------------------------------- */
 /*                                                                                       ak_xts.c  */
 /* ----------------------------------------------------------------------------------------------- */
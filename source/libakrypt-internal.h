@@ -31,6 +31,24 @@
 /*! \brief Процедура вычисления производного ключа в соответствии с алгоритмом ACPKM
     из рекомендаций Р 1323565.1.012-2018. */
  int ak_bckey_next_acpkm_key( ak_bckey );
+/*! \brief Максимальное количество блоков, обрабатываемых режимами шифрования
+    за один вызов многоблочной функции. */
+ #define ak_bckey_batch_blocks   (16)
+/*! \brief Зашифрование последовательности блоков информации. */
+ void ak_bckey_encrypt_blocks( ak_bckey , ak_pointer , ak_pointer , size_t );
+/*! \brief Расшифрование последовательности блоков информации. */
+ void ak_bckey_decrypt_blocks( ak_bckey , ak_pointer , ak_pointer , size_t );
+/*! \brief Сложение данных с гаммой по модулю два. */
+ void ak_bckey_xor_gamma( ak_pointer , ak_pointer , ak_pointer , size_t );
+/*! \brief Максимальное количество потоков, используемых многопоточными режимами шифрования. */
+ #define ak_bckey_max_threads    (64)
+/*! \brief Минимальное количество блоков, обрабатываемых одним потоком;
+    данные меньшего объема обрабатываются последовательно. */
+ #define ak_bckey_thread_blocks  (4096)
+/*! \brief Определение количества потоков, используемых для обработки данных. */
+ size_t ak_bckey_get_threads_count( size_t );
+/*! \brief Проверка возможности создания копии ключа для многопоточной обработки данных. */
+ bool_t ak_bckey_is_duplicable( ak_bckey );
 
 /* ----------------------------------------------------------------------------------------------- */
 /*! \brief Функция вырабатывает пару ключей алгоритма блочного шифрования из заданного
@@ -51,6 +69,14 @@
                                                                 const sbox , ak_kuznechik_params );
 /*! \brief Инициализация внутренних переменных значениями, регламентируемыми ГОСТ Р 34.12-2015. */
  int ak_bckey_kuznechik_init_gost_tables( void );
+/*! \brief Инициализация развернутых таблиц замен алгоритма блочного шифрования Магма. */
+ int ak_bckey_magma_init_tables( void );
+/*! \brief Инициализация развернутых таблиц алгоритма блочного шифрования AES-128. */
+ int ak_bckey_aes128_init_tables( void );
+/*! \brief Вычисление итерационных ключей первого вызова функции сжатия Стрибог. */
+ int ak_hash_streebog_init_tables( void );
+/*! \brief Копирование в контекст секретного ключа значений опций библиотеки. */
+ void ak_skey_load_options( ak_skey );
 /** @} */
 
 /* ----------------------------------------------------------------------------------------------- */
@@ -72,6 +98,9 @@
  int ak_mac_ptr( ak_mac , ak_pointer , const size_t , ak_pointer , const size_t );
 /*! \brief Применение сжимающего отображения к заданному файлу. */
  int ak_mac_file( ak_mac , const char* , ak_pointer , const size_t );
+/*! \brief Применение сжимающего отображения к заданному файлу с заданной длиной фрагмента. */
+ int ak_mac_file_with_block_size( ak_mac , const char* , const size_t ,
+                                                                   ak_pointer , const size_t );
 /** @} */
 
 /** \addtogroup aead-doc
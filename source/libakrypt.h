@@ -112,6 +112,32 @@ extern "C" {
 /*! \brief Функция завершает работу с библиотекой. */
  dll_export int ak_libakrypt_destroy( void );
 
+/* ----------------------------------------------------------------------------------------------- */
+/*! \brief Индексы опций библиотеки.
+    \details Порядок следования индексов совпадает с порядком опций во внутренней таблице
+    библиотеки; индексы позволяют получать значения опций без поиска по имени. */
+ typedef enum {
+   ak_option_log_level,
+   ak_option_context_manager_size,
+   ak_option_context_manager_max_size,
+   ak_option_pbkdf2_iteration_count,
+   ak_option_hmac_key_count_resource,
+   ak_option_digital_signature_count_resource,
+   ak_option_magma_cipher_resource,
+   ak_option_kuznechik_cipher_resource,
+   ak_option_acpkm_message_count,
+   ak_option_acpkm_section_magma_block_count,
+   ak_option_acpkm_section_kuznechik_block_count,
+   ak_option_openssl_compability,
+   ak_option_use_color_output,
+   ak_option_key_remask_policy,
+   ak_option_key_remask_block_count,
+   ak_option_key_remask_interval,
+   ak_option_key_icode_check_policy,
+   ak_option_key_icode_check_block_count,
+   ak_option_key_icode_check_interval
+ } option_index_t;
+
 /* ----------------------------------------------------------------------------------------------- */
 /*! \brief Функция возвращает номер версии бибилиотеки libakrypt. */
  dll_export const char *ak_libakrypt_version( void );
@@ -125,6 +151,8 @@ extern "C" {
  dll_export ak_int64 ak_libakrypt_get_option_by_index( const size_t );
 /*! \brief Функция устанавливает значение заданной опции. */
  dll_export int ak_libakrypt_set_option( const char * , const ak_int64 );
+/*! \brief Функция устанавливает значение опции по ее индексу. */
+ dll_export int ak_libakrypt_set_option_by_index( const size_t , const ak_int64 );
 /*! \brief Функция считывает значения опций библиотеки из файла. */
  dll_export bool_t ak_libakrypt_load_options( void );
 /*! \brief Функция выводит текущие значения всех опций библиотеки. */
@@ -133,6 +161,8 @@ extern "C" {
 /* ----------------------------------------------------------------------------------------------- */
 /*! \brief Функция устанавливает режим совместимости криптографических преобразований с библиотекой openssl. */
  dll_export int ak_libakrypt_set_openssl_compability( bool_t );
+/*! \brief Функция возвращает текущее значение режима совместимости с библиотекой openssl. */
+ dll_export bool_t ak_libakrypt_get_openssl_compability( void );
 /*! \brief Функция получает домашний каталог библиотеки. */
  dll_export int ak_libakrypt_get_home_path( char * , const size_t );
 /*! \brief Функция создает полное имя файла в домашем каталоге библиотеки. */
@@ -488,6 +518,62 @@ extern "C" {
 
 /*! \brief Флаг, который определяет, можно ли использовать значение внутреннего буффера в режиме omac. */
  #define ak_key_flag_omac_buffer_used   (0x0000000000000200ULL)
+/*! \brief Флаг, который определяет, что контрольная сумма ключа была успешно проверена
+    и результат проверки может быть использован повторно. */
+ #define ak_key_flag_icode_checked      (0x0000000000000400ULL)
+/*! \brief Флаг, который определяет, что вычисленные из ключа и хранящиеся вместе с ним значения
+    (например, внутренние состояния алгоритма HMAC) соответствуют текущему значению ключа. */
+ #define ak_key_flag_precomputed        (0x0000000000000800ULL)
+
+/* ----------------------------------------------------------------------------------------------- */
+/*! \brief Политика смены маски секретного ключа после выполнения криптографических преобразований. */
+ typedef enum {
+  /*! \brief Маска сменяется при каждом вызове функции, использующей ключ */
+   remask_every_call_policy,
+  /*! \brief Маска сменяется после обработки заданного количества блоков */
+   remask_block_count_policy,
+  /*! \brief Маска сменяется по истечении заданного интервала времени */
+   remask_time_interval_policy
+ } remask_policy_t;
+
+/* ----------------------------------------------------------------------------------------------- */
+/*! \brief Политика проверки контрольной суммы секретного ключа перед выполнением
+    криптографических преобразований. */
+ typedef enum {
+  /*! \brief Контрольная сумма проверяется при каждом вызове функции, использующей ключ */
+   icode_check_every_call_policy,
+  /*! \brief Контрольная сумма проверяется после обработки заданного количества блоков */
+   icode_check_block_count_policy,
+  /*! \brief Контрольная сумма проверяется по истечении заданного интервала времени */
+   icode_check_time_interval_policy
+ } icode_check_policy_t;
+
+/* ----------------------------------------------------------------------------------------------- */
+/*! \brief Значения опций библиотеки, используемые ключом при выполнении преобразований.
+    \details Значения копируются из опций библиотеки при создании ключа, что позволяет
+    не обращаться к таблице опций при каждом вызове функций шифрования и имитозащиты.
+    Для обновления значений используется функция ak_bckey_refresh_options(). */
+ typedef struct skey_options {
+  /*! \brief режим совместимости с библиотекой openssl */
+   bool_t openssl_compability;
+  /*! \brief максимальная длина секции режима ACPKM (в блоках) */
+   ak_int64 acpkm_section_block_count;
+  /*! \brief ресурс ключа блочного шифрования (в блоках) */
+   ak_int64 cipher_resource;
+  /*! \brief политика смены маски ключа */
+   remask_policy_t remask_policy;
+  /*! \brief количество блоков, после обработки которых сменяется маска */
+   ak_uint64 remask_block_count;
+  /*! \brief интервал времени (в миллисекундах), по истечении которого сменяется маска */
+   ak_uint64 remask_interval;
+  /*! \brief политика проверки контрольной суммы ключа */
+   icode_check_policy_t icode_check_policy;
+  /*! \brief количество блоков, после обработки которых повторно проверяется контрольная сумма */
+   ak_uint64 icode_check_block_count;
+  /*! \brief интервал времени (в миллисекундах), по истечении которого
+      повторно проверяется контрольная сумма */
+   ak_uint64 icode_check_interval;
+ } *ak_skey_options;
 
 /* ----------------------------------------------------------------------------------------------- */
 /*! \brief Способ выделения памяти для хранения секретной информации. */
@@ -585,6 +671,16 @@ extern "C" {
    key_flags_t flags;
   /*! \brief Способ выделения памяти. */
    memory_allocation_policy_t policy;
+  /*! \brief значения опций библиотеки, сохраненные при создании ключа */
+   struct skey_options options;
+  /*! \brief количество блоков, обработанных с момента последней смены маски */
+   ak_uint64 remask_blocks;
+  /*! \brief время последней смены маски (в миллисекундах) */
+   ak_uint64 remask_time;
+  /*! \brief количество блоков, обработанных с момента последней проверки контрольной суммы */
+   ak_uint64 icode_blocks;
+  /*! \brief время последней проверки контрольной суммы (в миллисекундах) */
+   ak_uint64 icode_time;
   /*! \brief указатель на функцию маскирования ключа */
    ak_function_skey *set_mask;
   /*! \brief указатель на функцию демаскирования ключа */
@@ -624,10 +720,16 @@ extern "C" {
  dll_export int ak_skey_set_mask_xor( ak_skey );
 /*! \brief Снятие маски с ключа. */
  dll_export int ak_skey_unmask_xor( ak_skey );
+/*! \brief Проверка необходимости смены маски ключа в соответствии с политикой перемаскирования. */
+ dll_export bool_t ak_skey_remask_is_required( ak_skey , const size_t );
+/*! \brief Смена маски ключа в соответствии с политикой перемаскирования. */
+ dll_export int ak_skey_remask( ak_skey , const size_t );
 /*! \brief Вычисление значения контрольной суммы ключа. */
  dll_export int ak_skey_set_icode_xor( ak_skey );
 /*! \brief Проверка значения контрольной суммы ключа. */
  dll_export bool_t ak_skey_check_icode_xor( ak_skey );
+/*! \brief Проверка значения контрольной суммы ключа в соответствии с политикой проверки. */
+ dll_export bool_t ak_skey_verify_icode( ak_skey , const size_t );
 /*! \brief Функция устанавливает ресурс ключа. */
  dll_export int ak_skey_set_resource( ak_skey , ak_resource );
 /*! \brief Функция устанавливает временной интервал действия ключа. */
@@ -650,6 +752,12 @@ extern "C" {
  typedef int ( ak_function_bckey_create ) ( ak_bckey );
 /*! \brief Функция зашифрования/расширования одного блока информации. */
  typedef void ( ak_function_bckey )( ak_skey, ak_pointer, ak_pointer );
+/*! \brief Функция зашифрования/расширования последовательности из заданного количества блоков. */
+ typedef void ( ak_function_bckey_blocks )( ak_skey, ak_pointer, ak_pointer, size_t );
+/*! \brief Функция одновременного шифрования и вычисления имитовставки в режиме `mgm`
+    для последовательности из заданного количества блоков. */
+ typedef void ( ak_function_bckey_mgm_blocks )( ak_skey, ak_skey, ak_pointer, ak_pointer,
+                                              ak_pointer, ak_pointer, ak_pointer, size_t, bool_t );
 /*! \brief Функция, предназначенная для зашифрования/расшифрования области памяти заданного размера */
  typedef int ( ak_function_bckey_encrypt )( ak_bckey, ak_pointer, ak_pointer, size_t,
                                                                                 ak_pointer, size_t );
@@ -670,6 +778,18 @@ extern "C" {
    ak_function_bckey *encrypt;
   /*! \brief Функция расширования одного блока информации. */
    ak_function_bckey *decrypt;
+  /*! \brief Функция зашифрования нескольких последовательно расположенных блоков информации.
+      \details Указатель может быть не определен (иметь значение NULL); в этом случае
+      блоки обрабатываются функцией encrypt. */
+   ak_function_bckey_blocks *encrypt_blocks;
+  /*! \brief Функция расшифрования нескольких последовательно расположенных блоков информации.
+      \details Указатель может быть не определен (иметь значение NULL). */
+   ak_function_bckey_blocks *decrypt_blocks;
+  /*! \brief Функция обработки блоков данных в режиме `mgm`, совмещающая зашифрование
+      счетчиков обоими ключами и умножение в поле \f$ \mathbb F_{2^{128}}\f$.
+      \details Указатель может быть не определен (иметь значение NULL); в этом случае
+      шифрование и вычисление имитовставки выполняются раздельно. */
+   ak_function_bckey_mgm_blocks *mgm_blocks;
   /*! \brief Функция развертки ключа. */
    ak_function_skey *schedule_keys;
   /*! \brief Функция уничтожения развернутых ключей. */
@@ -689,6 +809,8 @@ extern "C" {
  dll_export int ak_bckey_destroy( ak_bckey );
 /*! \brief Присвоение ключу алгоритма блочного шифрования константного значения. */
  dll_export int ak_bckey_set_key( ak_bckey, const ak_pointer , const size_t );
+/*! \brief Обновление значений опций библиотеки, сохраненных в контексте ключа. */
+ dll_export int ak_bckey_refresh_options( ak_bckey );
 /*! \brief Присвоение ключу алгоритма блочного шифрования случайного значения. */
  dll_export int ak_bckey_set_key_random( ak_bckey , ak_random );
 /*! \brief Присвоение ключу алгоритма блочного шифрования значения, выработанного из пароля. */
@@ -740,9 +862,16 @@ extern "C" {
     (cipher block chaining, cbc). */
  dll_export int ak_bckey_decrypt_cbc( ak_bckey , ak_pointer , ak_pointer , size_t ,
                                                                              ak_pointer , size_t );
+/*! \brief Многопоточное расшифрование данных в режиме простой замены с зацеплением
+   из ГОСТ Р 34.13-2015. */
+ dll_export int ak_bckey_decrypt_cbc_threads( ak_bckey , ak_pointer , ak_pointer , size_t ,
+                                                                     ak_pointer , size_t , size_t );
 /*! \brief Шифрование данных в режиме гаммирования из ГОСТ Р 34.13-2015
    (counter mode, ctr). */
  dll_export int ak_bckey_ctr( ak_bckey , ak_pointer , ak_pointer , size_t , ak_pointer , size_t );
+/*! \brief Многопоточное шифрование данных в режиме гаммирования из ГОСТ Р 34.13-2015. */
+ dll_export int ak_bckey_ctr_threads( ak_bckey , ak_pointer , ak_pointer , size_t ,
+                                                                     ak_pointer , size_t , size_t );
 /*! \brief Шифрование данных в режиме гаммирования с обратной связью по выходу
    (output feedback, ofb). */
  dll_export int ak_bckey_ofb( ak_bckey , ak_pointer , ak_pointer , size_t , ak_pointer , size_t );
@@ -754,15 +883,28 @@ extern "C" {
    из ГОСТ Р 34.13-2015 (cipher feedback, cfb). */
  dll_export int ak_bckey_decrypt_cfb( ak_bckey , ak_pointer , ak_pointer , size_t ,
                                                                              ak_pointer , size_t );
+/*! \brief Многопоточное расшифрование данных в режиме гаммирования с обратной связью
+   по шифртексту из ГОСТ Р 34.13-2015. */
+ dll_export int ak_bckey_decrypt_cfb_threads( ak_bckey , ak_pointer , ak_pointer , size_t ,
+                                                                     ak_pointer , size_t , size_t );
 /*! \brief Шифрование данных в режиме `CTR-ACPKM` из Р 1323565.1.017—2018. */
  dll_export int ak_bckey_ctr_acpkm( ak_bckey , ak_pointer , ak_pointer , size_t , size_t ,
                                                                              ak_pointer , size_t );
+/*! \brief Многопоточное шифрование данных в режиме `CTR-ACPKM` из Р 1323565.1.017—2018. */
+ dll_export int ak_bckey_ctr_acpkm_threads( ak_bckey , ak_pointer , ak_pointer , size_t , size_t ,
+                                                                    ak_pointer , size_t , size_t );
 /*! \brief Зашифрование данных в режиме `XTS`. */
  dll_export int ak_bckey_encrypt_xts( ak_bckey ,  ak_bckey , ak_pointer , ak_pointer , size_t ,
                                                                              ak_pointer , size_t );
 /*! \brief Расшифрование данных в режиме `XTS`. */
  dll_export int ak_bckey_decrypt_xts( ak_bckey ,  ak_bckey , ak_pointer , ak_pointer , size_t ,
                                                                              ak_pointer , size_t );
+/*! \brief Зашифрование последовательности секторов в режиме `XTS`. */
+ dll_export int ak_bckey_encrypt_xts_sectors( ak_bckey , ak_bckey , ak_pointer , ak_pointer ,
+                                                        size_t , ak_uint64 , size_t , size_t );
+/*! \brief Расшифрование последовательности секторов в режиме `XTS`. */
+ dll_export int ak_bckey_decrypt_xts_sectors( ak_bckey , ak_bckey , ak_pointer , ak_pointer ,
+                                                        size_t , ak_uint64 , size_t , size_t );
 /** @} */
 
 /* ----------------------------------------------------------------------------------------------- */
@@ -829,13 +971,39 @@ extern "C" {
   size_t hsize;
 } *ak_streebog;
 
+/* ----------------------------------------------------------------------------------------------- */
+/*! \brief Длина листа (в октетах) древовидного режима хеширования Стрибог. */
+ #define ak_streebog_tree_leaf_size        (1048576)
+
+/* ----------------------------------------------------------------------------------------------- */
+/*! \brief Структура для хранения внутренних данных древовидного режима хеширования Стрибог. */
+/* ----------------------------------------------------------------------------------------------- */
+ typedef struct streebog_tree {
+ /*! \brief Контекст хеширования текущего листа. */
+  struct streebog leaf;
+ /*! \brief Контекст хеширования последовательности хеш-кодов листьев. */
+  struct streebog root;
+ /*! \brief Количество октетов, обработанных в текущем листе. */
+  size_t filled;
+ /*! \brief Общее количество обработанных октетов сообщения. */
+  ak_uint64 total;
+ /*! \brief Хеш-коды листьев, еще не переданные в контекст root. */
+  ak_uint8 buffer[64];
+ /*! \brief Количество октетов в буффере хеш-кодов. */
+  size_t length;
+ /*! \brief Количество потоков, используемых для хеширования листьев; значение может быть
+     изменено пользователем, единица означает последовательное вычисление. */
+  size_t threads;
+} *ak_streebog_tree;
+
 /* ----------------------------------------------------------------------------------------------- */
 /*! \brief Контекст бесключевой функции хеширования. */
 /*! \details Класс предоставляет интерфейс для реализации бесключевых функций хеширования, построенных
     с использованием итеративных сжимающих отображений. В настоящее время
     с использованием класса \ref hash реализованы следующие отечественные алгоритмы хеширования
      - Стрибог256,
-     - Стрибог512.
+     - Стрибог512,
+     - древовидный режим хеширования Стрибог256 и Стрибог512 (см. ak_hash_create_streebog256_tree()).
 
   Перед началом работы контекст функции хэширования должен быть инициализирован
   вызовом одной из функций инициализации, например, функции ak_hash_create_streebog256()
@@ -852,6 +1020,10 @@ extern "C" {
    union {
    /*! \brief Структура алгоритмов семейства Стрибог. */
     struct streebog sctx;
+   /*! \brief Указатель на структуру древовидного режима хеширования Стрибог; память
+       под структуру выделяется при создании контекста, поэтому размер структуры \ref hash
+       не зависит от размера структуры \ref streebog_tree. */
+    ak_streebog_tree tctx;
    } data;
  } *ak_hash;
 
@@ -860,6 +1032,10 @@ extern "C" {
  dll_export int ak_hash_create_streebog256( ak_hash );
 /*! \brief Инициализация контекста функции бесключевого хеширования ГОСТ Р 34.11-2012 (Стрибог512). */
  dll_export int ak_hash_create_streebog512( ak_hash );
+/*! \brief Инициализация контекста древовидного режима хеширования Стрибог256. */
+ dll_export int ak_hash_create_streebog256_tree( ak_hash );
+/*! \brief Инициализация контекста древовидного режима хеширования Стрибог512. */
+ dll_export int ak_hash_create_streebog512_tree( ak_hash );
 /*! \brief Инициализация контекста функции бесключевого хеширования по заданному OID алгоритма. */
  dll_export int ak_hash_create_oid( ak_hash, ak_oid );
 /*! \brief Уничтожение контекста функции хеширования. */
@@ -878,6 +1054,9 @@ extern "C" {
  dll_export int ak_hash_finalize( ak_hash , const ak_pointer , const size_t , ak_pointer , const size_t );
 /*! \brief Хеширование заданной области памяти. */
  dll_export int ak_hash_ptr( ak_hash , const ak_pointer , const size_t , ak_pointer , const size_t );
+/*! \brief Хеширование массива независимых сообщений. */
+ dll_export int ak_hash_ptr_many( ak_hash , const ak_pointer * , const size_t * , ak_pointer * ,
+                                                                   const size_t , const size_t );
 /*! \brief Хеширование заданного файла. */
  dll_export int ak_hash_file( ak_hash , const char*, ak_pointer , const size_t );
 /** @} */
@@ -907,6 +1086,13 @@ extern "C" {
    struct mac mctx;
   /*! \brief Контекст функции хеширования */
    struct hash ctx;
+  /*! \brief Маскированные значения векторов h и \f$ \Sigma \f$ функции хеширования после обработки
+      блока ipad (индекс 0) и блока opad (индекс 1). */
+   ak_uint64 states[2][16];
+  /*! \brief Маски, наложенные на значения векторов из массива states. */
+   ak_uint64 masks[2][16];
+  /*! \brief Значение счетчика n функции хеширования после обработки одного блока. */
+   ak_uint64 counter[8];
 } *ak_hmac;
 
 /*! \brief Создание секретного ключа алгоритма выработки имитовставки HMAC на основе функции Стрибог256. */
@@ -970,6 +1156,83 @@ extern "C" {
  dll_export int ak_bckey_decrypt_mgm( ak_pointer , ak_pointer , const ak_pointer ,
     const size_t , const ak_pointer , ak_pointer , const size_t , const ak_pointer , const size_t ,
                                                                           ak_pointer, const size_t );
+
+/* ----------------------------------------------------------------------------------------------- */
+/*! \brief Структура, содержащая текущее состояние внутренних переменных режима `mgm`
+   аутентифицированного шифрования. */
+ typedef struct mgm_ctx {
+  /*! \brief Текущее значение имитовставки. */
+   ak_uint128 sum;
+  /*! \brief Счетчик, значения которого используются при шифровании информации. */
+   ak_uint128 ycount;
+  /*! \brief Счетчик, значения которого используются при выработке имитовставки. */
+   ak_uint128 zcount;
+  /*! \brief Размер обработанных зашифровываемых/расшифровываемых данных в битах. */
+   ssize_t pbitlen;
+  /*! \brief Размер обработанных дополнительных данных в битах. */
+   ssize_t abitlen;
+  /*! \brief Флаги состояния контекста. */
+   ak_uint32 flags;
+} *ak_mgm_ctx;
+
+/* ----------------------------------------------------------------------------------------------- */
+/*! \brief Контекст режима `mgm`, позволяющий зашифровывать (расшифровывать) данные
+    последовательными фрагментами. */
+ typedef struct mgm {
+  /*! \brief Текущее состояние внутренних переменных режима. */
+   struct mgm_ctx ctx;
+  /*! \brief Ключ шифрования (может принимать значение NULL). */
+   ak_bckey encryptionKey;
+  /*! \brief Ключ выработки имитовставки (может принимать значение NULL). */
+   ak_bckey authenticationKey;
+} *ak_mgm;
+
+/*! \brief Инициализация контекста режима `mgm` ключами и синхропосылкой. */
+ dll_export int ak_mgm_clean( ak_mgm , ak_bckey , ak_bckey , const ak_pointer , const size_t );
+/*! \brief Обработка очередного фрагмента ассоциированных данных в режиме `mgm`. */
+ dll_export int ak_mgm_adata_update( ak_mgm , const ak_pointer , const size_t );
+/*! \brief Зашифрование очередного фрагмента данных в режиме `mgm`. */
+ dll_export int ak_mgm_encrypt_update( ak_mgm , const ak_pointer , ak_pointer , const size_t );
+/*! \brief Расшифрование очередного фрагмента данных в режиме `mgm`. */
+ dll_export int ak_mgm_decrypt_update( ak_mgm , const ak_pointer , ak_pointer , const size_t );
+/*! \brief Выработка имитовставки и очистка контекста режима `mgm`. */
+ dll_export int ak_mgm_finalize( ak_mgm , ak_pointer , const size_t );
+
+/* ----------------------------------------------------------------------------------------------- */
+/*! \brief Описание одного сообщения, обрабатываемого функциями пакетного
+    аутентифицированного шифрования. */
+ typedef struct aead_message {
+  /*! \brief Указатель на синхропосылку. */
+   ak_pointer iv;
+  /*! \brief Длина синхропосылки (в октетах). */
+   size_t iv_size;
+  /*! \brief Указатель на ассоциированные данные. */
+   ak_pointer adata;
+  /*! \brief Длина ассоциированных данных (в октетах). */
+   size_t adata_size;
+  /*! \brief Указатель на входные данные. */
+   ak_pointer in;
+  /*! \brief Указатель на область памяти для выходных данных (может совпадать с `in`). */
+   ak_pointer out;
+  /*! \brief Длина входных данных (в октетах). */
+   size_t size;
+  /*! \brief Указатель на имитовставку (вырабатываемую или проверяемую). */
+   ak_pointer icode;
+  /*! \brief Длина имитовставки (в октетах). */
+   size_t icode_size;
+  /*! \brief Результат обработки сообщения (код ошибки). */
+   int status;
+} *ak_aead_message;
+
+/*! \brief Зашифрование массива независимых сообщений в режиме `mgm`. */
+ dll_export int ak_bckey_encrypt_mgm_many( ak_bckey , ak_bckey , ak_aead_message , const size_t );
+/*! \brief Расшифрование массива независимых сообщений в режиме `mgm`. */
+ dll_export int ak_bckey_decrypt_mgm_many( ak_bckey , ak_bckey , ak_aead_message , const size_t );
+/*! \brief Обработка массива независимых сообщений в режиме `mgm` по заданной функции
+    аутентифицированного шифрования. */
+ dll_export int ak_aead_many( ak_function_aead * , ak_pointer , ak_pointer ,
+                                                                ak_aead_message , const size_t );
+
 /*! \brief Зашифрование данных в режиме `xtsmac` с одновременной выработкой имитовставки. */
  dll_export int ak_bckey_encrypt_xtsmac( ak_pointer , ak_pointer , const ak_pointer ,
     const size_t , const ak_pointer , ak_pointer , const size_t , const ak_pointer , const size_t ,
@@ -979,6 +1242,45 @@ extern "C" {
     const size_t , const ak_pointer , ak_pointer , const size_t , const ak_pointer , const size_t ,
                                                                           ak_pointer, const size_t );
 
+/* ----------------------------------------------------------------------------------------------- */
+/*! \brief Структура, содержащая текущее состояние внутренних переменных режима `xtsmac`
+   аутентифицированного шифрования. */
+ typedef struct xtsmac_ctx {
+  /*! \brief Текущее значение имитовставки. */
+   ak_uint64 sum[2];
+  /*! \brief Вектор, используемый для маскирования шифруемой информации. */
+   ak_uint64 gamma[6];
+  /*! \brief Размер обработанных зашифровываемых/расшифровываемых данных в битах. */
+   ssize_t pbitlen;
+  /*! \brief Размер обработанных ассоциированных данных в битах. */
+   ssize_t abitlen;
+  /*! \brief Флаги состояния контекста. */
+   ak_uint32 flags;
+} *ak_xtsmac_ctx;
+
+/* ----------------------------------------------------------------------------------------------- */
+/*! \brief Контекст режима `xtsmac`, позволяющий зашифровывать (расшифровывать) данные
+    последовательными фрагментами. */
+ typedef struct xtsmac {
+  /*! \brief Текущее состояние внутренних переменных режима. */
+   struct xtsmac_ctx ctx;
+  /*! \brief Ключ шифрования. */
+   ak_bckey encryptionKey;
+  /*! \brief Ключ выработки имитовставки. */
+   ak_bckey authenticationKey;
+} *ak_xtsmac;
+
+/*! \brief Инициализация контекста режима `xtsmac` ключами и синхропосылкой. */
+ dll_export int ak_xtsmac_clean( ak_xtsmac , ak_bckey , ak_bckey , const ak_pointer , const size_t );
+/*! \brief Обработка очередного фрагмента ассоциированных данных в режиме `xtsmac`. */
+ dll_export int ak_xtsmac_adata_update( ak_xtsmac , const ak_pointer , const size_t );
+/*! \brief Зашифрование очередного фрагмента данных в режиме `xtsmac`. */
+ dll_export int ak_xtsmac_encrypt_update( ak_xtsmac , const ak_pointer , ak_pointer , const size_t );
+/*! \brief Расшифрование очередного фрагмента данных в режиме `xtsmac`. */
+ dll_export int ak_xtsmac_decrypt_update( ak_xtsmac , const ak_pointer , ak_pointer , const size_t );
+/*! \brief Выработка имитовставки и очистка контекста режима `xtsmac`. */
+ dll_export int ak_xtsmac_finalize( ak_xtsmac , ak_pointer , const size_t );
+
 /*! \brief Зашифрование данных с одновременной выработкой имитовставки согласно ГОСТ Р 34.13-2015. */
  dll_export int ak_bckey_encrypt_ctr_cmac( ak_pointer , ak_pointer , const ak_pointer ,
     const size_t , const ak_pointer , ak_pointer , const size_t , const ak_pointer , const size_t ,
@@ -1237,8 +1539,14 @@ extern "C" {
 /* ----------------------------------------------------------------------------------------------- */
 /*! \brief Умножение двух элементов поля \f$ \mathbb F_{2^{64}}\f$. */
  dll_export void ak_gf64_mul_uint64( ak_pointer z, ak_pointer x, ak_pointer y );
+/*! \brief Табличное умножение двух элементов поля \f$ \mathbb F_{2^{64}}\f$. */
+ dll_export void ak_gf64_mul_table( ak_pointer z, ak_pointer x, ak_pointer y );
+/*! \brief Сумма попарных произведений элементов поля \f$ \mathbb F_{2^{64}}\f$. */
+ dll_export void ak_gf64_mul_sum_table( ak_pointer , ak_pointer , ak_pointer , const size_t );
 /*! \brief Умножение двух элементов поля \f$ \mathbb F_{2^{128}}\f$. */
  dll_export void ak_gf128_mul_uint64( ak_pointer z, ak_pointer x, ak_pointer y );
+/*! \brief Сумма попарных произведений элементов поля \f$ \mathbb F_{2^{128}}\f$. */
+ dll_export void ak_gf128_mul_sum_uint64( ak_pointer , ak_pointer , ak_pointer , const size_t );
 /*! \brief Умножение двух элементов поля \f$ \mathbb F_{2^{256}}\f$. */
  dll_export void ak_gf256_mul_uint64( ak_pointer z, ak_pointer x, ak_pointer y );
 /*! \brief Умножение двух элементов поля \f$ \mathbb F_{2^{512}}\f$. */
@@ -1247,21 +1555,29 @@ extern "C" {
 #ifdef AK_HAVE_BUILTIN_CLMULEPI64
 /*! \brief Умножение двух элементов поля \f$ \mathbb F_{2^{64}}\f$. */
  dll_export void ak_gf64_mul_pcmulqdq( ak_pointer z, ak_pointer x, ak_pointer y );
+/*! \brief Сумма попарных произведений элементов поля \f$ \mathbb F_{2^{64}}\f$. */
+ dll_export void ak_gf64_mul_sum_pcmulqdq( ak_pointer , ak_pointer , ak_pointer , const size_t );
 /*! \brief Умножение двух элементов поля \f$ \mathbb F_{2^{128}}\f$. */
  dll_export void ak_gf128_mul_pcmulqdq( ak_pointer z, ak_pointer a, ak_pointer b );
+/*! \brief Сумма попарных произведений элементов поля \f$ \mathbb F_{2^{128}}\f$. */
+ dll_export void ak_gf128_mul_sum_pcmulqdq( ak_pointer , ak_pointer , ak_pointer , const size_t );
 /*! \brief Умножение двух элементов поля \f$ \mathbb F_{2^{256}}\f$. */
  dll_export void ak_gf256_mul_pcmulqdq( ak_pointer z, ak_pointer a, ak_pointer b );
 /*! \brief Умножение двух элементов поля \f$ \mathbb F_{2^{512}}\f$. */
  dll_export void ak_gf512_mul_pcmulqdq( ak_pointer z, ak_pointer a, ak_pointer b );
 
  #define ak_gf64_mul ak_gf64_mul_pcmulqdq
+ #define ak_gf64_mul_sum ak_gf64_mul_sum_pcmulqdq
  #define ak_gf128_mul ak_gf128_mul_pcmulqdq
+ #define ak_gf128_mul_sum ak_gf128_mul_sum_pcmulqdq
  #define ak_gf256_mul ak_gf256_mul_pcmulqdq
  #define ak_gf512_mul ak_gf512_mul_pcmulqdq
 #else
 
- #define ak_gf64_mul ak_gf64_mul_uint64
+ #define ak_gf64_mul ak_gf64_mul_table
+ #define ak_gf64_mul_sum ak_gf64_mul_sum_table
  #define ak_gf128_mul ak_gf128_mul_uint64
+ #define ak_gf128_mul_sum ak_gf128_mul_sum_uint64
  #define ak_gf256_mul ak_gf256_mul_uint64
  #define ak_gf512_mul ak_gf512_mul_uint64
 #endif